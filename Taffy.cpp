@@ -14,6 +14,12 @@
 #include <string>
 #include <cstring>
 #include <memory>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <filesystem>
 
 
  // 🔥 SPIR-V Cross headers for runtime transpilation
@@ -31,6 +37,13 @@
 #include "include/overlay.h"
 #include "include/asset.h"
 #include "include/tools.h"
+#include "include/taffy_crc32.h"
+#include "include/taffy_file.h"
+#include "include/taffy_codec.h"
+#include "include/taffy_layout.h"
+#include "include/taffy_meshlet.h"
+#include "include/taffy_simplify.h"
+#include "include/taffy_streaming.h"
 #include "include/taffy_font_tools.h"
 #include "include/taffy_audio_tools.h"
 
@@ -74,6 +87,7 @@ const char* chunkTypeName(ChunkType type) {
 	case ChunkType::PART: return "PART";
 	case ChunkType::SVGU: return "SVGU";
 	case ChunkType::DEPS: return "DEPS";
+	case ChunkType::INDX: return "INDX";
 	}
 	return "UNKN";
 }
@@ -127,7 +141,7 @@ std::vector<uint8_t> bytesOf(const T& value) {
 	return data;
 }
 
-std::vector<DependencyChunk::Entry> parseDependencyEntries(const std::vector<uint8_t>& data) {
+std::vector<DependencyChunk::Entry> parseDependencyEntries(std::span<const uint8_t> data) {
 	if (data.size() < sizeof(DependencyChunk)) {
 		return {};
 	}
@@ -165,10 +179,11 @@ std::vector<uint8_t> buildDependencyChunkData(const std::vector<DependencyChunk:
 }
 
 bool upsertDependencyChunk(Asset& asset, const std::vector<DependencyChunk::Entry>& entries) {
-	if (asset.has_chunk(ChunkType::DEPS)) {
-		asset.remove_chunk(ChunkType::DEPS);
+	if (auto deps = asset.mutable_chunk(ChunkType::DEPS)) {
+		*deps = buildDependencyChunkData(entries);
+	} else {
+		asset.add_chunk(ChunkType::DEPS, buildDependencyChunkData(entries), "dependencies");
 	}
-	asset.add_chunk(ChunkType::DEPS, buildDependencyChunkData(entries), "dependencies");
 	asset.set_dependency_count(static_cast<uint32_t>(entries.size()));
 	return true;
 }
@@ -221,7 +236,7 @@ bool addExternalReference(const std::string& inputPath,
 	}
 
 	std::vector<DependencyChunk::Entry> entries;
-	if (auto depsData = asset.get_chunk_data(ChunkType::DEPS)) {
+	if (auto depsData = asset.view_chunk(ChunkType::DEPS)) {
 		entries = parseDependencyEntries(*depsData);
 	}
 
@@ -306,7 +321,9 @@ bool addScriptChunk(const std::string& inputPath,
 
 bool inspectPackage(const std::string& inputPath) {
 	Asset asset;
-	if (!asset.load_from_file_safe(inputPath)) {
+	std::vector<ChunkLoadResult> loadResults;
+	const bool verified = asset.load_from_file_parallel(inputPath, &loadResults);
+	if (!verified && loadResults.empty()) {
 		return false;
 	}
 
@@ -322,7 +339,7 @@ bool inspectPackage(const std::string& inputPath) {
 	std::cout << "AI models declared: " << header.ai_model_count << "\n";
 	std::cout << "Feature flags: 0x" << std::hex << static_cast<uint64_t>(header.feature_flags) << std::dec << "\n";
 
-	if (auto manifestData = asset.get_chunk_data(ChunkType::MANF);
+	if (auto manifestData = asset.view_chunk(ChunkType::MANF);
 		manifestData && manifestData->size() >= sizeof(ManifestChunk)) {
 		ManifestChunk manifest{};
 		std::memcpy(&manifest, manifestData->data(), sizeof(ManifestChunk));
@@ -340,7 +357,7 @@ bool inspectPackage(const std::string& inputPath) {
 		std::cout << "\nManifest: missing\n";
 	}
 
-	if (auto bootData = asset.get_chunk_data(ChunkType::BOOT);
+	if (auto bootData = asset.view_chunk(ChunkType::BOOT);
 		bootData && bootData->size() >= sizeof(BootstrapChunk)) {
 		BootstrapChunk boot{};
 		std::memcpy(&boot, bootData->data(), sizeof(BootstrapChunk));
@@ -354,7 +371,7 @@ bool inspectPackage(const std::string& inputPath) {
 		std::cout << "Bootstrap: missing\n";
 	}
 
-	if (auto depsData = asset.get_chunk_data(ChunkType::DEPS)) {
+	if (auto depsData = asset.view_chunk(ChunkType::DEPS)) {
 		auto entries = parseDependencyEntries(*depsData);
 		std::cout << "\nDependencies\n";
 		std::cout << "------------\n";
@@ -381,16 +398,445 @@ bool inspectPackage(const std::string& inputPath) {
 
 	std::cout << "\nChunk Directory\n";
 	std::cout << "---------------\n";
+	size_t index = 0;
 	for (const auto& entry : asset.get_chunk_directory()) {
 		std::cout << chunkTypeName(entry.type)
 				  << "  name=" << entry.name
 				  << "  size=" << entry.size
 				  << "  offset=" << entry.offset
 				  << "  flags=0x" << std::hex << entry.flags << std::dec
-				  << "\n";
+				  << "  class=" << residency_class_name(chunk_residency(entry));
+		if (entry.group != 0) {
+			std::cout << "  group=" << entry.group;
+		}
+		if (entry.codec != ChunkCodec::None) {
+			std::cout << "  codec=" << chunk_codec_name(entry.codec);
+		}
+		if (entry.alignment_log2 != 0) {
+			std::cout << "  align=" << chunk_alignment(entry);
+		}
+		if (index < loadResults.size() && loadResults[index].status != ChunkLoadResult::Status::Ok) {
+			std::cout << "  INVALID";
+		}
+		std::cout << "\n";
+		++index;
 	}
 
-	return true;
+	return verified;
+}
+
+std::optional<ChunkCodec> parseChunkCodec(const std::string& value) {
+	if (value == "none") return ChunkCodec::None;
+	if (value == "lz4") return ChunkCodec::LZ4;
+	if (value == "lz4hc") return ChunkCodec::LZ4HC;
+	return std::nullopt;
+}
+
+bool recompressPackage(const std::string& inputPath, const std::string& outputPath, ChunkCodec codec) {
+	Asset asset;
+	if (!asset.load_from_file_safe(inputPath)) {
+		return false;
+	}
+
+	// MANF, BOOT and DEPS are read at mount time and stay uncompressed
+	size_t updated = 0;
+	for (const auto& entry : asset.get_chunk_directory()) {
+		if (entry.type == ChunkType::MANF || entry.type == ChunkType::BOOT || entry.type == ChunkType::DEPS) {
+			continue;
+		}
+		if (entry.codec != codec) {
+			updated += asset.set_chunk_codec(entry.type, codec);
+		}
+	}
+
+	std::cout << "🗜️ " << updated << " chunk(s) set to " << chunk_codec_name(codec) << std::endl;
+	return asset.save_to_file(outputPath);
+}
+
+bool realignPackage(const std::string& inputPath, const std::string& outputPath, uint32_t alignment) {
+	Asset asset;
+	if (!asset.load_from_file_safe(inputPath) || !asset.set_payload_alignment(alignment)) {
+		return false;
+	}
+	return asset.save_to_file(outputPath);
+}
+
+// uvOffset: byte offset of Float2 texture coordinates in unpacked vertices,
+// -1 for none, or AUTO_UV_OFFSET for default_lod_vertex_layout()
+constexpr int32_t AUTO_UV_OFFSET = -2;
+
+bool generateGeometryLods(const std::string& inputPath, const std::string& outputPath, uint32_t levels,
+						  int32_t uvOffset) {
+	Asset asset;
+	if (!asset.load_from_file_safe(inputPath)) {
+		return false;
+	}
+
+	// Copy the entries first: add_chunk invalidates the directory
+	std::vector<ChunkDirectoryEntry> geometry;
+	for (const auto& entry : asset.get_chunk_directory()) {
+		if (entry.type == ChunkType::GEOM) {
+			geometry.push_back(entry);
+		}
+	}
+
+	LodChainOptions options;
+	options.max_levels = levels;
+	size_t added = 0;
+	for (const auto& entry : geometry) {
+		if (entry.name[0] == '\0') {
+			std::cerr << "⚠️ Skipping unnamed GEOM chunk" << std::endl;
+			continue;
+		}
+		const std::string name = entry.name;
+		auto view = asset.view_chunk(name);
+		GeometryChunk header;
+		if (!view || view->size() < sizeof(header)) {
+			continue;
+		}
+		std::memcpy(&header, view->data(), sizeof(header));
+		if (header.lod_level != 0 || (header.ms_flags & GeometryChunk::LodErrorData)) {
+			continue;   // Already part of an LOD chain
+		}
+
+		LodVertexLayout layout = default_lod_vertex_layout(header);
+		if (uvOffset != AUTO_UV_OFFSET && (header.vertex_format & VertexFormat::Packed) == VertexFormat(0)) {
+			layout.uv_offset = uvOffset;
+		}
+		std::vector<std::vector<uint8_t>> lods;
+		if (!build_geometry_lods(*view, layout, options, lods)) {
+			std::cerr << "⚠️ Cannot simplify GEOM chunk: " << name << std::endl;
+			continue;
+		}
+		if (lods.size() == 1) {
+			std::cout << "   " << name << ": nothing to simplify" << std::endl;
+			continue;
+		}
+
+		if (auto edit = asset.mutable_chunk(name)) {
+			*edit = std::move(lods[0]);
+		}
+		for (size_t level = 1; level < lods.size(); ++level) {
+			GeometryChunk lodHeader;
+			GeometryLodInfo info;
+			std::memcpy(&lodHeader, lods[level].data(), sizeof(lodHeader));
+			read_geometry_lod(lodHeader, lods[level], info);
+			std::cout << "   " << name << " LOD " << level << ": " << lodHeader.index_count / 3 << " triangles, error "
+					  << info.geometric_error << "m, from " << lodHeader.lod_distance << "m" << std::endl;
+			asset.add_chunk(ChunkType::GEOM, lods[level], name + "_lod" + std::to_string(level), entry.codec);
+			added++;
+		}
+	}
+
+	if (added > 0) {
+		asset.set_feature_flags(asset.get_feature_flags() | FeatureFlags::MultiLOD);
+	}
+	std::cout << "🔻 Added " << added << " LOD chunk(s)" << std::endl;
+	return asset.save_to_file(outputPath);
+}
+
+bool runCrcBenchmark(size_t megabytes) {
+	std::vector<uint8_t> buffer(megabytes * 1024 * 1024);
+	uint32_t seed = 0x12345678u;
+	for (auto& byte : buffer) {
+		seed = seed * 1664525u + 1013904223u;
+		byte = static_cast<uint8_t>(seed >> 24);
+	}
+
+	struct Variant {
+		const char* name;
+		uint32_t (*fn)(const void*, size_t, uint32_t);
+	};
+	const Variant variants[] = {
+		{ "bitwise (previous)", crc32_reference },
+		{ "slice-by-16", crc32_slice16 },
+		{ crc32_implementation(), crc32 },
+	};
+
+	std::cout << "CRC32 benchmark: " << megabytes << " MiB buffer, dispatch = "
+			  << crc32_implementation() << "\n";
+
+	bool identical = true;
+	uint32_t expected = 0;
+	for (size_t i = 0; i < std::size(variants); ++i) {
+		const auto& variant = variants[i];
+		// Repeat fast variants so every timing covers a similar wall time
+		const int passes = (i == 0) ? 1 : 8;
+		uint32_t result = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < passes; ++pass) {
+			result = variant.fn(buffer.data(), buffer.size(), 0);
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		const double gbps = (static_cast<double>(buffer.size()) * passes) / elapsed.count() / 1e9;
+
+		if (i == 0) {
+			expected = result;
+		} else if (result != expected) {
+			identical = false;
+		}
+		std::cout << "  " << variant.name << ": " << gbps << " GB/s  crc=0x"
+				  << std::hex << result << std::dec << "\n";
+	}
+
+	std::cout << (identical ? "✅ All implementations match" : "❌ CRC mismatch between implementations") << std::endl;
+	return identical;
+}
+
+bool runStreamBenchmark(std::string path, size_t passes) {
+	// Without an input, generate 256 MiB of 256 KiB chunks
+	bool generated = false;
+	if (path.empty()) {
+		path = (std::filesystem::temp_directory_path() / "taffy_bench_stream.taf").string();
+		ChunkedTaffyWriter writer;
+		writer.begin(path, 1024);
+		std::vector<uint8_t> payload(256 * 1024);
+		for (uint32_t i = 0; i < 1024; ++i) {
+			std::fill(payload.begin(), payload.end(), static_cast<uint8_t>(i));
+			writer.addChunk(ChunkType::TXTR, payload, "bench_" + std::to_string(i));
+		}
+		if (!writer.finalize()) {
+			return false;
+		}
+		generated = true;
+	}
+
+	StreamingTaffyLoader loader;
+	if (!loader.open(path) || loader.getChunkCount() == 0) {
+		return false;
+	}
+	const uint32_t chunkCount = loader.getChunkCount();
+
+	// Every load should reach the file, so caching is disabled
+	loader.setCacheBudget(0);
+
+	struct Run {
+		const char* label;
+		unsigned threads;
+		bool serialized;  // Emulates the previous single-mutex seek+read path
+	};
+	const Run runs[] = {
+		{ "positional", 1, false },
+		{ "positional", 4, false },
+		{ "positional", 16, false },
+		{ "serialized (previous)", 16, true },
+	};
+
+	// A warm page cache turns the benchmark into a memcpy test, so each pass
+	// starts cold and reads every chunk once, in a random order over the
+	// whole file
+	const bool cold = drop_file_cache(path);
+	std::cout << "Streaming read benchmark: " << path << "\n";
+	std::cout << "  " << chunkCount << " chunks, " << passes << " pass(es) in random order, "
+			  << (cold ? "cold page cache" : "page cache could not be dropped") << "\n";
+	if (!cold) {
+		std::cout << "  ⚠️ Reads may be served from memory; thread scaling will be understated" << std::endl;
+	}
+
+	double baseline = 0.0;
+	bool ok = true;
+	std::mutex serialMutex;
+	std::mt19937 rng(1234);
+	std::vector<uint32_t> order(chunkCount);
+	for (const auto& run : runs) {
+		uint64_t bytes = 0;
+		double seconds = 0.0;
+		std::atomic<bool> failed{ false };
+
+		for (size_t pass = 0; pass < passes && !failed; ++pass) {
+			loader.clearCache();
+			drop_file_cache(path);
+			for (uint32_t i = 0; i < chunkCount; ++i) {
+				order[i] = i;
+			}
+			std::shuffle(order.begin(), order.end(), rng);
+
+			std::atomic<uint32_t> next{ 0 };
+			std::atomic<uint64_t> passBytes{ 0 };
+			const auto start = std::chrono::steady_clock::now();
+			std::vector<std::thread> workers;
+			for (unsigned t = 0; t < run.threads; ++t) {
+				workers.emplace_back([&]() {
+					for (uint32_t i = next++; i < chunkCount; i = next++) {
+						ChunkBufferPtr chunk;
+						if (run.serialized) {
+							std::lock_guard<std::mutex> lock(serialMutex);
+							chunk = loader.loadChunk(order[i]);
+						} else {
+							chunk = loader.loadChunk(order[i]);
+						}
+						if (!chunk) {
+							failed = true;
+							return;
+						}
+						passBytes += chunk->size();
+					}
+				});
+			}
+			for (auto& worker : workers) {
+				worker.join();
+			}
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			seconds += elapsed.count();
+			bytes += passBytes;
+		}
+
+		const double mbps = static_cast<double>(bytes) / seconds / (1024.0 * 1024.0);
+		if (baseline == 0.0) {
+			baseline = mbps;
+		}
+		std::cout << "  " << run.label << " x" << run.threads << ": " << mbps << " MiB/s  ("
+				  << (mbps / baseline) << "x speedup vs 1 thread)\n";
+		ok = ok && !failed;
+	}
+
+	loader.close();
+	if (generated) {
+		std::filesystem::remove(path);
+	}
+	std::cout << (ok ? "✅ Benchmark complete" : "❌ Chunk reads failed") << std::endl;
+	return ok;
+}
+
+bool runPrefetchBenchmark(std::string path) {
+	// Without an input, generate 8192 small chunks (like audio_chunk_N)
+	bool generated = false;
+	if (path.empty()) {
+		path = (std::filesystem::temp_directory_path() / "taffy_bench_prefetch.taf").string();
+		ChunkedTaffyWriter writer;
+		writer.begin(path, 8192);
+		std::vector<uint8_t> payload(4096);
+		for (uint32_t i = 0; i < 8192; ++i) {
+			std::fill(payload.begin(), payload.end(), static_cast<uint8_t>(i));
+			writer.addChunk(ChunkType::AUDI, payload, "audio_chunk_" + std::to_string(i));
+		}
+		if (!writer.finalize()) {
+			return false;
+		}
+		generated = true;
+	}
+
+	std::vector<ReadBackendKind> backends = { ReadBackendKind::Pread };
+	if (io_uring_available()) {
+		backends.push_back(ReadBackendKind::IoUring);
+	} else {
+		std::cout << "io_uring unavailable, measuring pread only\n";
+	}
+
+	bool ok = true;
+	for (ReadBackendKind backend : backends) {
+		StreamingTaffyLoader loader;
+		if (!loader.open(path) || loader.getChunkCount() == 0) {
+			return false;
+		}
+		loader.setCacheBudget(UINT64_MAX);
+		loader.setReadBackend(backend);
+
+		std::vector<uint32_t> ids(loader.getChunkCount());
+		for (uint32_t i = 0; i < ids.size(); ++i) {
+			ids[i] = i;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		size_t loaded = 0;
+		for (auto& future : loader.prefetch(ids, PrefetchPriority::Speculative)) {
+			if (future.get()) {
+				loaded++;
+			}
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout << "  " << read_backend_name(loader.getActiveReadBackend()) << ": " << loaded << "/" << ids.size()
+				  << " chunks in " << (elapsed.count() * 1000.0) << " ms ("
+				  << (static_cast<double>(loaded) / elapsed.count()) << " chunks/s)\n";
+		ok = ok && loaded == ids.size();
+	}
+
+	if (generated) {
+		std::filesystem::remove(path);
+	}
+	std::cout << (ok ? "✅ Benchmark complete" : "❌ Chunk reads failed") << std::endl;
+	return ok;
+}
+
+bool runMeshletBenchmark(uint32_t stacks, uint32_t slices) {
+	// UV sphere with the topology createDataDrivenSphere emits
+	std::vector<float> positions;
+	std::vector<uint32_t> indices;
+	for (uint32_t stack = 0; stack <= stacks; ++stack) {
+		const float phi = 3.14159265f * stack / stacks;
+		for (uint32_t slice = 0; slice <= slices; ++slice) {
+			const float theta = 2.0f * 3.14159265f * slice / slices;
+			positions.insert(positions.end(), { std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta) });
+		}
+	}
+	for (uint32_t stack = 0; stack < stacks; ++stack) {
+		for (uint32_t slice = 0; slice < slices; ++slice) {
+			const uint32_t tl = stack * (slices + 1) + slice;
+			const uint32_t tr = tl + 1;
+			const uint32_t bl = (stack + 1) * (slices + 1) + slice;
+			const uint32_t br = bl + 1;
+			if (stack == 0) {
+				indices.insert(indices.end(), { tl, br, bl });
+			} else if (stack == stacks - 1) {
+				indices.insert(indices.end(), { tl, tr, br });
+			} else {
+				indices.insert(indices.end(), { tl, tr, bl, tr, br, bl });
+			}
+		}
+	}
+
+	// Same triangles in random order, like meshes from tools that do not sort them
+	std::vector<uint32_t> shuffled = indices;
+	std::mt19937 rng(1234);
+	for (size_t i = shuffled.size() / 3; i > 1; --i) {
+		const size_t j = rng() % i;
+		std::swap_ranges(shuffled.begin() + (i - 1) * 3, shuffled.begin() + i * 3, shuffled.begin() + j * 3);
+	}
+
+	struct Input {
+		const char* label;
+		const std::vector<uint32_t>* indices;
+	};
+	const Input inputs[] = { { "grid order", &indices }, { "shuffled", &shuffled } };
+	struct Strategy {
+		const char* label;
+		MeshletBuilder::Strategy strategy;
+	};
+	const Strategy strategies[] = {
+		{ "sequential (previous)", MeshletBuilder::Strategy::Sequential },
+		{ "locality", MeshletBuilder::Strategy::Locality },
+	};
+
+	std::cout << "Meshlet benchmark: " << stacks << "x" << slices << " sphere, " << indices.size() / 3
+			  << " triangles, limits " << MESHLET_MAX_VERTICES << "/" << MESHLET_MAX_PRIMITIVES << "\n";
+
+	bool ok = true;
+	for (const auto& input : inputs) {
+		std::cout << "  " << input.label << ":\n";
+		for (const auto& strategy : strategies) {
+			MeshletBuilder::Options options;
+			options.strategy = strategy.strategy;
+			MeshletBuilder builder(options);
+
+			const auto start = std::chrono::steady_clock::now();
+			const MeshletSet meshlets = builder.build(*input.indices, positions);
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			const MeshletStats stats = builder.measure(meshlets);
+
+			std::cout << "    " << strategy.label << ": " << stats.meshlets << " meshlets, fill "
+					  << (stats.vertex_fill * 100.0) << "% vertices / " << (stats.primitive_fill * 100.0)
+					  << "% primitives, " << stats.vertex_overhead() << "x vertex transforms, "
+					  << (stats.cullable * 100.0) << "% cone-cullable, "
+					  << meshlet_primitive_bytes(meshlets.primitive_indices.size(), meshlets.geometry_flags())
+					  << " primitive index bytes (" << meshlets.primitive_indices.size() * sizeof(uint32_t) << " as uint32), "
+					  << (elapsed.count() * 1000.0) << " ms\n";
+			ok = ok && stats.triangles == indices.size() / 3;
+		}
+	}
+
+	std::cout << (ok ? "✅ Benchmark complete" : "❌ Meshlets lost triangles") << std::endl;
+	return ok;
 }
 
 } // namespace
@@ -405,8 +851,8 @@ void printUsage(const char* program_name) {
 	std::cout << "    Create Taffy asset from OBJ file" << std::endl;
 	std::cout << "  " << program_name << " cube <output.taf> [mesh]" << std::endl;
 	std::cout << "    Create the built-in cube asset" << std::endl;
-	std::cout << "  " << program_name << " sphere <output.taf> [mesh]" << std::endl;
-	std::cout << "    Create the built-in sphere asset" << std::endl;
+	std::cout << "  " << program_name << " sphere <output.taf> [mesh] [compact] [lod]" << std::endl;
+	std::cout << "    Create the built-in sphere asset (compact: 24-byte packed vertices, lod: simplified LOD 1-3 GEOM chunks)" << std::endl;
 	std::cout << "  " << program_name << " init-package <output.taf> <asset|scene|game> <name>" << std::endl;
 	std::cout << "    Create a skeletal runtime container with MANF and BOOT chunks" << std::endl;
 	std::cout << "  " << program_name << " inspect <input.taf>" << std::endl;
@@ -415,6 +861,20 @@ void printUsage(const char* program_name) {
 	std::cout << "    Add or replace a SCPT chunk from a loose script file" << std::endl;
 	std::cout << "  " << program_name << " add-external-ref <input.taf> <output.taf> <logical_name> <path> [usage] [file|taf|dir] [relative] [optional]" << std::endl;
 	std::cout << "    Add or update a loose-file dependency reference in the DEPS chunk" << std::endl;
+	std::cout << "  " << program_name << " compress <input.taf> <output.taf> <none|lz4|lz4hc>" << std::endl;
+	std::cout << "    Re-encode chunk payloads (MANF, BOOT and DEPS are always stored raw)" << std::endl;
+	std::cout << "  " << program_name << " align <input.taf> <output.taf> <bytes>" << std::endl;
+	std::cout << "    Pad every chunk payload to a power-of-two alignment (e.g. 16, 64, 4096)" << std::endl;
+	std::cout << "  " << program_name << " lod <input.taf> <output.taf> [levels] [uv_offset|none]" << std::endl;
+	std::cout << "    Add simplified LOD GEOM chunks to every LOD 0 GEOM chunk (uv_offset: Float2 UVs in unpacked vertices)" << std::endl;
+	std::cout << "  " << program_name << " bench-crc [megabytes]" << std::endl;
+	std::cout << "    Measure chunk checksum throughput" << std::endl;
+	std::cout << "  " << program_name << " bench-stream [input.taf] [passes]" << std::endl;
+	std::cout << "    Measure random chunk reads from 1/4/16 threads" << std::endl;
+	std::cout << "  " << program_name << " bench-prefetch [input.taf]" << std::endl;
+	std::cout << "    Prefetch every chunk through the pread and io_uring backends" << std::endl;
+	std::cout << "  " << program_name << " bench-meshlets [stacks] [slices]" << std::endl;
+	std::cout << "    Compare meshlet count and fill of the sequential and locality builders" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
@@ -440,16 +900,23 @@ int main(int argc, char* argv[]) {
 
 	if (command == "sphere") {
 		if (argc < 3) {
-			std::cout << "Usage: " << argv[0] << " sphere <output.taf> [mesh]" << std::endl;
+			std::cout << "Usage: " << argv[0] << " sphere <output.taf> [mesh] [compact] [lod]" << std::endl;
 			return 1;
 		}
 
 		std::string outMaster = argv[2];
-		bool mesh = (argc >= 4 && std::string(argv[3]) == "mesh");
+		bool mesh = false;
+		bool compact = false;
+		uint32_t lod_levels = 1;
+		for (int i = 3; i < argc; ++i) {
+			mesh = mesh || std::string(argv[i]) == "mesh";
+			compact = compact || std::string(argv[i]) == "compact";
+			lod_levels = std::string(argv[i]) == "lod" ? 4u : lod_levels;
+		}
 		
 		DataDrivenAssetCompiler compiler{};
 
-		return compiler.createDataDrivenSphere(outMaster, 12, 24, 64000, mesh) ? 0 : 1;
+		return compiler.createDataDrivenSphere(outMaster, 12, 24, 64000, mesh, compact, lod_levels) ? 0 : 1;
 	}
 
 	if (command == "cube") {
@@ -525,6 +992,63 @@ int main(int argc, char* argv[]) {
 		return addExternalReference(argv[2], argv[3], argv[4], argv[5], *usage, *refType, packageRelative, optional) ? 0 : 1;
 	}
 
+	if (command == "compress") {
+		if (argc < 5) {
+			std::cout << "Usage: " << argv[0] << " compress <input.taf> <output.taf> <none|lz4|lz4hc>" << std::endl;
+			return 1;
+		}
+
+		auto codec = parseChunkCodec(argv[4]);
+		if (!codec) {
+			std::cerr << "❌ Invalid codec: " << argv[4] << std::endl;
+			return 1;
+		}
+
+		return recompressPackage(argv[2], argv[3], *codec) ? 0 : 1;
+	}
+
+	if (command == "align") {
+		if (argc < 5) {
+			std::cout << "Usage: " << argv[0] << " align <input.taf> <output.taf> <bytes>" << std::endl;
+			return 1;
+		}
+		return realignPackage(argv[2], argv[3], static_cast<uint32_t>(std::stoul(argv[4]))) ? 0 : 1;
+	}
+
+	if (command == "lod") {
+		if (argc < 4) {
+			std::cout << "Usage: " << argv[0] << " lod <input.taf> <output.taf> [levels] [uv_offset|none]" << std::endl;
+			return 1;
+		}
+		const uint32_t levels = (argc >= 5) ? static_cast<uint32_t>(std::stoul(argv[4])) : 4u;
+		int32_t uvOffset = AUTO_UV_OFFSET;
+		if (argc >= 6) {
+			uvOffset = std::string(argv[5]) == "none" ? -1 : static_cast<int32_t>(std::stol(argv[5]));
+		}
+		return generateGeometryLods(argv[2], argv[3], levels, uvOffset) ? 0 : 1;
+	}
+
+	if (command == "bench-stream") {
+		const std::string path = (argc >= 3) ? argv[2] : "";
+		const size_t passes = (argc >= 4) ? std::max<size_t>(std::stoul(argv[3]), 1) : 1;
+		return runStreamBenchmark(path, passes) ? 0 : 1;
+	}
+
+	if (command == "bench-prefetch") {
+		return runPrefetchBenchmark((argc >= 3) ? argv[2] : "") ? 0 : 1;
+	}
+
+	if (command == "bench-meshlets") {
+		const uint32_t stacks = (argc >= 3) ? static_cast<uint32_t>(std::stoul(argv[2])) : 64;
+		const uint32_t slices = (argc >= 4) ? static_cast<uint32_t>(std::stoul(argv[3])) : 128;
+		return runMeshletBenchmark(stacks, slices) ? 0 : 1;
+	}
+
+	if (command == "bench-crc") {
+		const size_t megabytes = (argc >= 3) ? std::stoul(argv[2]) : 64;
+		return runCrcBenchmark(megabytes) ? 0 : 1;
+	}
+
 	if (command == "demo") {
 		if (argc < 5) {
 			std::cout << "Usage: " << argv[0] << " demo <master_output> <overlay_output> <font_output> [audio_output_dir]" << std::endl;
@@ -1,5 +1,9 @@
 ﻿#pragma once
 #include "taffy.h"
+#include "taffy_crc32.h"
+#include "taffy_codec.h"
+#include "taffy_layout.h"
+#include "taffy_directory.h"
 
 namespace Taffy {
 
@@ -70,7 +74,7 @@ namespace Taffy {
     // CHUNK MANAGEMENT
     // =============================================================================
 
-    void Asset::add_chunk(ChunkType type, const std::vector<uint8_t>& data, const std::string& name) {
+    void Asset::add_chunk(ChunkType type, const std::vector<uint8_t>& data, const std::string& name, ChunkCodec codec) {
         // Store chunk data at the same index as directory entry
         chunk_data_.push_back(data);
 
@@ -83,66 +87,130 @@ namespace Taffy {
         entry.checksum = calculate_crc32(data.data(), data.size());
         std::strncpy(entry.name, name.c_str(), sizeof(entry.name) - 1);
         entry.name[sizeof(entry.name) - 1] = '\0';
+        entry.codec = codec;
 
         // Add to directory
         chunk_directory_.push_back(entry);
+        chunk_index_.append(chunk_directory_);
         header_.chunk_count = static_cast<uint32_t>(chunk_directory_.size());
 
         std::cout << "  📦 Added chunk: " << name << " (" << data.size() << " bytes)" << std::endl;
     }
 
-    bool Asset::has_chunk(ChunkType type) const {
-        for (const auto& entry : chunk_directory_) {
+    size_t Asset::set_chunk_codec(ChunkType type, ChunkCodec codec) {
+        size_t updated = 0;
+        for (auto& entry : chunk_directory_) {
             if (entry.type == type) {
-                return true;
+                entry.codec = codec;
+                ++updated;
             }
         }
-        return false;
+        return updated;
     }
 
-    bool Asset::has_chunk_named(const std::string& name) const {
-        for (const auto& entry : chunk_directory_) {
-            if (entry.name == name) {
-                return true;
+    size_t Asset::set_chunk_residency(ChunkType type, ResidencyClass residency) {
+        size_t updated = 0;
+        for (auto& entry : chunk_directory_) {
+            if (entry.type == type) {
+                entry.residency = residency;
+                ++updated;
             }
         }
-        return false;
+        return updated;
+    }
+
+    bool Asset::set_chunk_group(const std::string& name, uint32_t group) {
+        const int index = chunk_index_.find(chunk_directory_, name);
+        if (index < 0) {
+            return false;
+        }
+        chunk_directory_[index].group = group;
+        return true;
+    }
+
+    bool Asset::has_chunk(ChunkType type) const {
+        return chunk_index_.find(chunk_directory_, type) >= 0;
+    }
+
+    bool Asset::has_chunk_named(const std::string& name) const {
+        return chunk_index_.find(chunk_directory_, name) >= 0;
     }
 
     std::optional<std::vector<uint8_t>> Asset::get_chunk_data(ChunkType type) const {
-        for (size_t i = 0; i < chunk_directory_.size(); ++i) {
-            if (chunk_directory_[i].type == type) {
-                return chunk_data_[i];
-            }
+        const int index = chunk_index_.find(chunk_directory_, type);
+        if (index < 0) {
+            return std::nullopt;
         }
-        return std::nullopt;
+        return chunk_data_[index];
     }
 
     std::optional<std::vector<uint8_t>> Asset::get_chunk_data(const std::string& name) const {
-        for (size_t i = 0; i < chunk_directory_.size(); ++i) {
-            if (chunk_directory_[i].name == name) {
-                return chunk_data_[i];
-            }
+        const int index = chunk_index_.find(chunk_directory_, name);
+        if (index < 0) {
+            return std::nullopt;
         }
-        return std::nullopt;
+        return chunk_data_[index];
     }
 
     std::optional<ChunkDirectoryEntry> Asset::get_chunk_entry(ChunkType type) const {
-        for (const auto& entry : chunk_directory_) {
-            if (entry.type == type) {
-                return entry;
-            }
+        const int index = chunk_index_.find(chunk_directory_, type);
+        if (index < 0) {
+            return std::nullopt;
         }
-        return std::nullopt;
+        return chunk_directory_[index];
     }
 
     std::optional<ChunkDirectoryEntry> Asset::get_chunk_entry(const std::string& name) const {
-        for (const auto& entry : chunk_directory_) {
-            if (entry.name == name) {
-                return entry;
-            }
+        const int index = chunk_index_.find(chunk_directory_, name);
+        if (index < 0) {
+            return std::nullopt;
+        }
+        return chunk_directory_[index];
+    }
+
+    std::optional<std::span<const uint8_t>> Asset::view_chunk(ChunkType type) const {
+        const int index = chunk_index_.find(chunk_directory_, type);
+        if (index < 0) {
+            return std::nullopt;
+        }
+        return std::span<const uint8_t>(chunk_data_[index]);
+    }
+
+    std::optional<std::span<const uint8_t>> Asset::view_chunk(const std::string& name) const {
+        const int index = chunk_index_.find(chunk_directory_, name);
+        if (index < 0) {
+            return std::nullopt;
+        }
+        return std::span<const uint8_t>(chunk_data_[index]);
+    }
+
+    Asset::ChunkEdit Asset::mutable_chunk(ChunkType type) {
+        const int index = chunk_index_.find(chunk_directory_, type);
+        if (index < 0) {
+            return {};
         }
-        return std::nullopt;
+        return ChunkEdit(this, static_cast<size_t>(index));
+    }
+
+    Asset::ChunkEdit Asset::mutable_chunk(const std::string& name) {
+        const int index = chunk_index_.find(chunk_directory_, name);
+        if (index < 0) {
+            return {};
+        }
+        return ChunkEdit(this, static_cast<size_t>(index));
+    }
+
+    Asset::ChunkEdit::~ChunkEdit() {
+        if (asset_) {
+            asset_->refresh_chunk_entry(index_);
+        }
+    }
+
+    void Asset::refresh_chunk_entry(size_t index) {
+        auto& entry = chunk_directory_[index];
+        const auto& data = chunk_data_[index];
+        entry.size = data.size();
+        entry.checksum = calculate_crc32(data.data(), data.size());
     }
 
     size_t Asset::get_chunk_count() const {
@@ -165,6 +233,28 @@ namespace Taffy {
     // FILE I/O
     // =============================================================================
 
+    bool Asset::set_payload_alignment(uint32_t bytes) {
+        if (!chunk_alignment_log2(bytes, payload_alignment_log2_)) {
+            std::cerr << "❌ Invalid payload alignment: " << bytes
+                      << " (must be a power of two up to " << MAX_CHUNK_ALIGNMENT << ")" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Zero-pads `file` from `offset` to the next multiple of 1 << alignment_log2
+    inline uint64_t pad_to_alignment(std::ofstream& file, uint64_t offset, uint8_t alignment_log2) {
+        const uint64_t alignment = uint64_t(1) << alignment_log2;
+        const uint64_t aligned_offset = (offset + alignment - 1) & ~(alignment - 1);
+        static const char padding[4096] = {};
+        for (uint64_t remaining = aligned_offset - offset; remaining > 0;) {
+            const uint64_t count = std::min<uint64_t>(remaining, sizeof(padding));
+            file.write(padding, static_cast<std::streamsize>(count));
+            remaining -= count;
+        }
+        return aligned_offset;
+    }
+
     bool Asset::save_to_file(const std::filesystem::path& path) {
         std::cout << "💾 Saving asset to: " << path << std::endl;
 
@@ -174,36 +264,123 @@ namespace Taffy {
             return false;
         }
 
-        // Calculate total size and chunk offsets
-        header_.total_size = sizeof(AssetHeader) +
-            chunk_directory_.size() * sizeof(ChunkDirectoryEntry);
-
-        uint64_t current_offset = header_.total_size;
-        for (auto& entry : chunk_directory_) {
-            entry.offset = current_offset;
-            current_offset += entry.size;
+        // An index read from an earlier file is stale, so it is left out of the
+        // stored chunks; a fresh one is appended below. stored_chunks maps each
+        // stored directory slot back to its chunk in this asset
+        std::vector<size_t> stored_chunks;
+        std::vector<ChunkDirectoryEntry> stored_directory;
+        stored_chunks.reserve(chunk_directory_.size());
+        stored_directory.reserve(chunk_directory_.size() + 1);
+        for (size_t i = 0; i < chunk_directory_.size(); ++i) {
+            if (chunk_directory_[i].type != ChunkType::INDX) {
+                stored_chunks.push_back(i);
+                stored_directory.push_back(chunk_directory_[i]);
+            }
         }
-        header_.total_size = current_offset;
 
-        // Write header
+        // Stored sizes are only known once chunks are compressed, so the header and
+        // directory are reserved first and rewritten after the payloads
+        std::vector<uint8_t> index_table;
+        if (write_chunk_index_) {
+            index_table = build_chunk_index_table(stored_directory);
+            ChunkDirectoryEntry index_entry{};
+            index_entry.type = ChunkType::INDX;
+            index_entry.residency = default_residency(ChunkType::INDX);
+            std::strncpy(index_entry.name, CHUNK_INDEX_NAME, sizeof(index_entry.name) - 1);
+            stored_directory.push_back(index_entry);
+        }
+        header_.chunk_count = static_cast<uint32_t>(stored_directory.size());
+        header_.index_chunk = write_chunk_index_ ? header_.chunk_count : 0;
         file.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+        file.write(reinterpret_cast<const char*>(stored_directory.data()),
+                   stored_directory.size() * sizeof(ChunkDirectoryEntry));
+
+        uint64_t current_offset = sizeof(AssetHeader) +
+            stored_directory.size() * sizeof(ChunkDirectoryEntry);
+        uint64_t decoded_bytes = 0;
+        uint64_t stored_bytes = 0;
+        bool any_compressed = false;
+        std::vector<uint8_t> compressed;
+
+        // Write chunk data in residency order; the directory keeps its order
+        for (const size_t slot : plan_chunk_layout(std::span<const ChunkDirectoryEntry>(
+                 stored_directory.data(), stored_chunks.size()))) {
+            const size_t i = stored_chunks[slot];
+            const auto& data = chunk_data_[i];
+            auto& entry = stored_directory[slot];
+            std::span<const uint8_t> stored(data);
+
+            const ResidencyClass residency = chunk_residency(entry);
+            entry.residency = residency;
+            chunk_directory_[i].residency = residency;
+
+            entry.codec = ChunkCodec::None;
+            entry.uncompressed_size = 0;
+            const ChunkCodec codec = chunk_directory_[i].codec;
+            if (codec != ChunkCodec::None && compress_chunk(codec, data, compressed) &&
+                compressed.size() < data.size()) {
+                stored = compressed;
+                entry.codec = codec;
+                entry.uncompressed_size = data.size();
+                entry.checksum = calculate_crc32(compressed.data(), compressed.size());
+                any_compressed = true;
+            }
 
-        // Write chunk directory
-        for (const auto& entry : chunk_directory_) {
-            file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            // Pad to the chunk's alignment
+            const uint8_t alignment_log2 = std::max(entry.alignment_log2, payload_alignment_log2_);
+            current_offset = pad_to_alignment(file, current_offset, alignment_log2);
+
+            entry.alignment_log2 = alignment_log2;
+            entry.offset = current_offset;
+            entry.size = stored.size();
+            chunk_directory_[i].alignment_log2 = alignment_log2;
+            chunk_directory_[i].offset = current_offset;
+            file.write(reinterpret_cast<const char*>(stored.data()), stored.size());
+
+            current_offset += stored.size();
+            decoded_bytes += data.size();
+            stored_bytes += stored.size();
         }
 
-        // Write chunk data
-        for (size_t i = 0; i < chunk_directory_.size(); ++i) {
-            const auto& data = chunk_data_[i];
-            file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        // The index goes last: it is only read on demand, a page at a time
+        if (write_chunk_index_) {
+            auto& entry = stored_directory.back();
+            current_offset = pad_to_alignment(file, current_offset, payload_alignment_log2_);
+            entry.alignment_log2 = payload_alignment_log2_;
+            entry.offset = current_offset;
+            entry.size = index_table.size();
+            entry.checksum = calculate_crc32(index_table.data(), index_table.size());
+            file.write(reinterpret_cast<const char*>(index_table.data()), index_table.size());
+            current_offset += index_table.size();
         }
+        header_.total_size = current_offset;
+        header_.feature_flags = any_compressed
+            ? (header_.feature_flags | FeatureFlags::CompressedChunks)
+            : static_cast<FeatureFlags>(static_cast<uint64_t>(header_.feature_flags) &
+                                        ~static_cast<uint64_t>(FeatureFlags::CompressedChunks));
+
+        // Patch header and chunk directory
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+        file.write(reinterpret_cast<const char*>(stored_directory.data()),
+                   stored_directory.size() * sizeof(ChunkDirectoryEntry));
 
         file.close();
+        header_.chunk_count = static_cast<uint32_t>(chunk_directory_.size());
+        if (!file) {
+            std::cerr << "❌ Failed to write asset: " << path << std::endl;
+            return false;
+        }
 
         std::cout << "✅ Asset saved successfully!" << std::endl;
         std::cout << "   📊 Size: " << header_.total_size << " bytes" << std::endl;
         std::cout << "   📦 Chunks: " << header_.chunk_count << std::endl;
+        if (write_chunk_index_) {
+            std::cout << "   🗂️ Chunk index: " << index_table.size() << " bytes" << std::endl;
+        }
+        if (any_compressed) {
+            std::cout << "   🗜️ Compressed payload: " << decoded_bytes << " -> " << stored_bytes << " bytes" << std::endl;
+        }
 
         return true;
     }
@@ -263,6 +440,8 @@ namespace Taffy {
                       << ", name='" << entry.name << "'" << std::endl;
         }
 
+        chunk_index_.build(chunk_directory_);
+
         // Get file size for validation
         file.seekg(0, std::ios::end);
         size_t file_size = file.tellg();
@@ -333,16 +512,189 @@ namespace Taffy {
                 return false;
             }
 
+            if (entry.codec != ChunkCodec::None) {
+                std::vector<uint8_t> decoded;
+                if (!decode_chunk_payload(entry, data, decoded)) {
+                    std::cerr << "❌ Failed to decompress chunk: " << entry.name
+                              << " (" << chunk_codec_name(entry.codec) << ")" << std::endl;
+                    return false;
+                }
+                data = std::move(decoded);
+            }
+
             chunk_data_.push_back(std::move(data));
             std::cout << "  📦 Loaded chunk: " << entry.name << " (" << entry.size << " bytes)" << std::endl;
         }
 
         file.close();
 
+        // In memory the directory describes decoded payloads
+        for (size_t i = 0; i < chunk_directory_.size(); ++i) {
+            if (chunk_directory_[i].codec != ChunkCodec::None) {
+                refresh_chunk_entry(i);
+                chunk_directory_[i].uncompressed_size = 0;
+            }
+        }
+
         std::cout << "✅ Asset loaded successfully!" << std::endl;
         return true;
     }
 
+    bool Asset::load_from_file_parallel(const std::string& path,
+                                        std::vector<ChunkLoadResult>* results,
+                                        unsigned thread_count) {
+        if (results) {
+            results->clear();
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "❌ Failed to open file for reading: " << path << std::endl;
+            return false;
+        }
+
+        AssetHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file.good()) {
+            std::cerr << "❌ Failed to read asset header" << std::endl;
+            return false;
+        }
+
+        if (std::strncmp(header.magic, "TAF!", 4) != 0 &&
+            std::strncmp(header.magic, "TAFO", 4) != 0) {
+            std::cerr << "❌ Invalid asset magic: " << std::string(header.magic, 4) << std::endl;
+            return false;
+        }
+
+        std::vector<ChunkDirectoryEntry> directory(header.chunk_count);
+        file.read(reinterpret_cast<char*>(directory.data()),
+                  static_cast<std::streamsize>(directory.size() * sizeof(ChunkDirectoryEntry)));
+        if (!file.good()) {
+            std::cerr << "❌ Failed to read chunk directory" << std::endl;
+            return false;
+        }
+
+        file.seekg(0, std::ios::end);
+        const uint64_t file_size = static_cast<uint64_t>(file.tellg());
+        file.close();
+
+        const size_t chunk_count = directory.size();
+        std::vector<std::vector<uint8_t>> chunk_data(chunk_count);
+        std::vector<ChunkLoadResult> chunk_results(chunk_count);
+
+        if (thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        thread_count = static_cast<unsigned>(std::min<size_t>(thread_count, std::max<size_t>(chunk_count, 1)));
+
+        // Each worker claims chunks by index and reads them through its own stream
+        std::atomic<size_t> next_chunk{ 0 };
+        auto worker = [&]() {
+            std::ifstream stream(path, std::ios::binary);
+            for (size_t i = next_chunk++; i < chunk_count; i = next_chunk++) {
+                const auto& entry = directory[i];
+                auto& result = chunk_results[i];
+                result.expected_checksum = entry.checksum;
+
+                if (entry.offset > file_size || entry.size > file_size - entry.offset) {
+                    result.status = ChunkLoadResult::Status::OutOfBounds;
+                    continue;
+                }
+
+                auto& data = chunk_data[i];
+                data.resize(static_cast<size_t>(entry.size));
+                stream.clear();
+                stream.seekg(static_cast<std::streamoff>(entry.offset));
+                stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(entry.size));
+                if (!stream.is_open() || static_cast<uint64_t>(stream.gcount()) != entry.size) {
+                    result.status = ChunkLoadResult::Status::ReadError;
+                    data.clear();
+                    continue;
+                }
+
+                result.calculated_checksum = calculate_crc32(data.data(), data.size());
+                if (result.calculated_checksum != entry.checksum) {
+                    result.status = ChunkLoadResult::Status::ChecksumMismatch;
+                }
+
+                // Decode compressed chunks; the in-memory entry describes decoded data
+                if (entry.codec != ChunkCodec::None) {
+                    std::vector<uint8_t> decoded;
+                    if (decode_chunk_payload(entry, data, decoded)) {
+                        data = std::move(decoded);
+                    } else {
+                        if (result.status == ChunkLoadResult::Status::Ok) {
+                            result.status = ChunkLoadResult::Status::DecodeError;
+                        }
+                        data.clear();
+                    }
+                    auto& decoded_entry = directory[i];
+                    decoded_entry.size = data.size();
+                    decoded_entry.checksum = calculate_crc32(data.data(), data.size());
+                    decoded_entry.uncompressed_size = 0;
+                }
+            }
+        };
+
+        if (thread_count <= 1) {
+            worker();
+        } else {
+            std::vector<std::thread> workers;
+            workers.reserve(thread_count);
+            for (unsigned t = 0; t < thread_count; ++t) {
+                workers.emplace_back(worker);
+            }
+            for (auto& thread : workers) {
+                thread.join();
+            }
+        }
+
+        size_t failures = 0;
+        for (size_t i = 0; i < chunk_count; ++i) {
+            const auto& result = chunk_results[i];
+            if (result.status == ChunkLoadResult::Status::Ok) {
+                continue;
+            }
+            ++failures;
+            std::cerr << "❌ Chunk " << i << " (" << directory[i].name << "): ";
+            switch (result.status) {
+            case ChunkLoadResult::Status::OutOfBounds:
+                std::cerr << "extends beyond file (offset " << directory[i].offset
+                          << ", size " << directory[i].size << ")";
+                break;
+            case ChunkLoadResult::Status::ReadError:
+                std::cerr << "read failed";
+                break;
+            case ChunkLoadResult::Status::ChecksumMismatch:
+                std::cerr << "checksum mismatch (expected 0x" << std::hex << result.expected_checksum
+                          << ", calculated 0x" << result.calculated_checksum << std::dec << ")";
+                break;
+            case ChunkLoadResult::Status::DecodeError:
+                std::cerr << "failed to decompress";
+                break;
+            default:
+                break;
+            }
+            std::cerr << std::endl;
+        }
+
+        header_ = header;
+        chunk_directory_ = std::move(directory);
+        chunk_data_ = std::move(chunk_data);
+        chunk_index_.build(chunk_directory_);
+        if (results) {
+            *results = std::move(chunk_results);
+        }
+
+        std::cout << "📖 Loaded " << chunk_count << " chunks from " << path
+                  << " on " << thread_count << " thread(s)";
+        if (failures > 0) {
+            std::cout << " (" << failures << " failed verification)";
+        }
+        std::cout << std::endl;
+        return failures == 0;
+    }
+
     // =============================================================================
     // UTILITY FUNCTIONS
     // =============================================================================
@@ -370,32 +722,26 @@ namespace Taffy {
         }
     }
 
-    uint32_t Asset::calculate_crc32(const uint8_t* data, size_t length) const {
-        uint32_t crc = 0xFFFFFFFF;
-        for (size_t i = 0; i < length; ++i) {
-            crc ^= data[i];
-            for (int j = 0; j < 8; ++j) {
-                crc = (crc >> 1) ^ (0xEDB88320 * (crc & 1));
-            }
-        }
-        return ~crc;
+    uint32_t Asset::calculate_crc32(const uint8_t* data, size_t length) {
+        return crc32(data, length);
     }
 
     bool Asset::remove_chunk(ChunkType type) {
         // Find the first chunk of the given type
-        for (size_t i = 0; i < chunk_directory_.size(); ++i) {
-            if (chunk_directory_[i].type == type) {
-                std::cout << "  🗑️ Removed chunk: " << chunk_directory_[i].name << std::endl;
+        const int index = chunk_index_.find(chunk_directory_, type);
+        if (index < 0) {
+            return false; // Chunk doesn't exist
+        }
 
-                // Remove from both vectors at the same index
-                chunk_directory_.erase(chunk_directory_.begin() + i);
-                chunk_data_.erase(chunk_data_.begin() + i);
+        std::cout << "  🗑️ Removed chunk: " << chunk_directory_[index].name << std::endl;
 
-                header_.chunk_count = static_cast<uint32_t>(chunk_directory_.size());
-                return true;
-            }
-        }
-        return false; // Chunk doesn't exist
+        // Remove from both vectors at the same index; later positions shift
+        chunk_directory_.erase(chunk_directory_.begin() + index);
+        chunk_data_.erase(chunk_data_.begin() + index);
+        chunk_index_.build(chunk_directory_);
+
+        header_.chunk_count = static_cast<uint32_t>(chunk_directory_.size());
+        return true;
     }
 
     uint64_t Asset::get_file_size() const {
@@ -323,23 +323,19 @@ namespace Taffy {
             std::cout << "    Target hash: 0x" << std::hex << op.target_hash << std::dec << std::endl;
             std::cout << "    Replacement hash: 0x" << std::hex << op.replacement_hash << std::dec << std::endl;*/
 
-            // Get the shader chunk
-            auto shader_data = asset.get_chunk_data(ChunkType::SHDR);
+            // Edit the shader chunk in place
+            auto shader_data = asset.mutable_chunk(ChunkType::SHDR);
             if (!shader_data) {
                 std::cerr << "    ❌ No shader chunk found!" << std::endl;
                 return false;
             }
 
             // Parse shader chunk header
-            const uint8_t* chunk_ptr = shader_data->data();
+            uint8_t* mod_ptr = shader_data->data();
             ShaderChunk shader_header;
-            std::memcpy(&shader_header, chunk_ptr, sizeof(shader_header));
+            std::memcpy(&shader_header, mod_ptr, sizeof(shader_header));
             
             std::cout << "    📊 Shader chunk contains " << shader_header.shader_count << " shaders" << std::endl;
-
-            // Create a mutable copy of shader data
-            std::vector<uint8_t> modified_shader_data = *shader_data;
-            uint8_t* mod_ptr = modified_shader_data.data();
             
             // Skip header
             size_t offset = sizeof(ShaderChunk);
@@ -387,20 +383,20 @@ namespace Taffy {
                         
                         // Copy header
                         new_shader_data.insert(new_shader_data.end(), 
-                            modified_shader_data.begin(), 
-                            modified_shader_data.begin() + sizeof(ShaderChunk));
+                            shader_data->begin(), 
+                            shader_data->begin() + sizeof(ShaderChunk));
                         
                         // Copy shader infos (with our modification)
                         new_shader_data.insert(new_shader_data.end(),
-                            modified_shader_data.begin() + sizeof(ShaderChunk),
-                            modified_shader_data.begin() + sizeof(ShaderChunk) + shader_header.shader_count * sizeof(ShaderChunk::Shader));
+                            shader_data->begin() + sizeof(ShaderChunk),
+                            shader_data->begin() + sizeof(ShaderChunk) + shader_header.shader_count * sizeof(ShaderChunk::Shader));
                         
                         // Now copy SPIR-V data, replacing the target shader
                         size_t current_spirv_offset = sizeof(ShaderChunk) + shader_header.shader_count * sizeof(ShaderChunk::Shader);
                         
                         for (uint32_t j = 0; j < shader_header.shader_count; ++j) {
                             ShaderChunk::Shader* shader = reinterpret_cast<ShaderChunk::Shader*>(
-                                modified_shader_data.data() + sizeof(ShaderChunk) + j * sizeof(ShaderChunk::Shader));
+                                shader_data->data() + sizeof(ShaderChunk) + j * sizeof(ShaderChunk::Shader));
                             
                             if (j == i) {
                                 // This is our target shader - use replacement data
@@ -410,13 +406,13 @@ namespace Taffy {
                             } else {
                                 // Copy original shader data
                                 new_shader_data.insert(new_shader_data.end(),
-                                    modified_shader_data.begin() + current_spirv_offset,
-                                    modified_shader_data.begin() + current_spirv_offset + shader->spirv_size);
+                                    shader_data->begin() + current_spirv_offset,
+                                    shader_data->begin() + current_spirv_offset + shader->spirv_size);
                             }
                             current_spirv_offset += shader->spirv_size;
                         }
                         
-                        modified_shader_data = std::move(new_shader_data);
+                        *shader_data = std::move(new_shader_data);
                     } else {
                         // Same size - we can replace in-place
                         /*std::cout << "    📝 Replacing SPIR-V data in-place at offset " << spirv_offset << std::endl;
@@ -443,10 +439,6 @@ namespace Taffy {
                 return false;
             }
             
-            // Update the asset with modified shader chunk
-            asset.remove_chunk(ChunkType::SHDR);
-            asset.add_chunk(ChunkType::SHDR, modified_shader_data, "overlay_modified_shaders");
-            
             std::cout << "    ✅ Shader replaced successfully!" << std::endl;
             return true;
         }
@@ -456,7 +448,7 @@ namespace Taffy {
             std::cout << "    Vertex index: " << op.target_hash << std::endl;
 
             // Get geometry chunk
-            auto geom_data = asset.get_chunk_data(ChunkType::GEOM);
+            auto geom_data = asset.view_chunk(ChunkType::GEOM);
             if (!geom_data) {
                 std::cerr << "    ❌ No geometry chunk found!" << std::endl;
                 return false;
@@ -544,15 +536,9 @@ namespace Taffy {
                 return false;
             }
 
-            // Create mutable copy of geometry data
-            std::vector<uint8_t> modified_geom_data = *geom_data;
-
-            // Modify the vertex color
-            std::memcpy(modified_geom_data.data() + absolute_color_offset, new_color, 4 * sizeof(float));
-
-            // Update the asset with modified geometry
-            asset.remove_chunk(ChunkType::GEOM);
-            asset.add_chunk(ChunkType::GEOM, modified_geom_data, "modified_triangle_geometry");
+            // Modify the vertex color in place
+            auto modified_geom_data = asset.mutable_chunk(ChunkType::GEOM);
+            std::memcpy(modified_geom_data->data() + absolute_color_offset, new_color, 4 * sizeof(float));
 
             std::cout << "    ✅ Vertex color changed successfully!" << std::endl;
             return true;
@@ -909,7 +895,7 @@ namespace Taffy {
             std::cout << "    Vertex index: " << op.target_hash << std::endl;
 
             // Get geometry chunk
-            auto geom_data = asset.get_chunk_data(ChunkType::GEOM);
+            auto geom_data = asset.view_chunk(ChunkType::GEOM);
             if (!geom_data) {
                 std::cerr << "    ❌ No geometry chunk found!" << std::endl;
                 return false;
@@ -997,15 +983,9 @@ namespace Taffy {
                 return false;
             }
 
-            // Create mutable copy of geometry data
-            std::vector<uint8_t> modified_geom_data = *geom_data;
-
-            // Modify the vertex color
-            std::memcpy(modified_geom_data.data() + absolute_color_offset, new_color, 4 * sizeof(float));
-
-            // Update the asset with modified geometry
-            asset.remove_chunk(ChunkType::GEOM);
-            asset.add_chunk(ChunkType::GEOM, modified_geom_data, "modified_triangle_geometry");
+            // Modify the vertex color in place
+            auto modified_geom_data = asset.mutable_chunk(ChunkType::GEOM);
+            std::memcpy(modified_geom_data->data() + absolute_color_offset, new_color, 4 * sizeof(float));
 
             std::cout << "    ✅ Vertex color changed successfully!" << std::endl;
             return true;
@@ -1021,7 +1001,7 @@ namespace Taffy {
             AttributeModification attr_mod;
             std::memcpy(&attr_mod, operation_data_.data() + op.data_offset, sizeof(attr_mod));
 
-            auto geom_data = asset.get_chunk_data(ChunkType::GEOM);
+            auto geom_data = asset.view_chunk(ChunkType::GEOM);
             if (!geom_data) {
                 return false;
             }
@@ -1029,20 +1009,16 @@ namespace Taffy {
             GeometryChunk geom_header;
             std::memcpy(&geom_header, geom_data->data(), sizeof(geom_header));
 
-            std::vector<uint8_t> modified_geom_data = *geom_data;
-
             // Calculate position offset
             size_t vertex_data_offset = sizeof(GeometryChunk);
             size_t target_vertex_offset = vertex_data_offset + (attr_mod.vertex_index * geom_header.vertex_stride);
             size_t absolute_position_offset = target_vertex_offset + attr_mod.attribute_offset;
 
-            if (absolute_position_offset + attr_mod.attribute_size <= modified_geom_data.size()) {
-                std::memcpy(modified_geom_data.data() + absolute_position_offset,
+            if (absolute_position_offset + attr_mod.attribute_size <= geom_data->size()) {
+                auto modified_geom_data = asset.mutable_chunk(ChunkType::GEOM);
+                std::memcpy(modified_geom_data->data() + absolute_position_offset,
                     attr_mod.values, attr_mod.attribute_size);
 
-                asset.remove_chunk(ChunkType::GEOM);
-                asset.add_chunk(ChunkType::GEOM, modified_geom_data, "position_modified_geometry");
-
                 std::cout << "    ✅ Vertex position changed successfully!" << std::endl;
                 return true;
             }
@@ -1062,18 +1038,16 @@ namespace Taffy {
             std::memcpy(&transform, operation_data_.data() + op.data_offset, sizeof(transform));
 
             // Apply transformation to all vertices in the geometry
-            auto geom_data = asset.get_chunk_data(ChunkType::GEOM);
-            if (!geom_data) {
+            auto modified_geom_data = asset.mutable_chunk(ChunkType::GEOM);
+            if (!modified_geom_data) {
                 return false;
             }
 
             GeometryChunk geom_header;
-            std::memcpy(&geom_header, geom_data->data(), sizeof(geom_header));
-
-            std::vector<uint8_t> modified_geom_data = *geom_data;
+            std::memcpy(&geom_header, modified_geom_data->data(), sizeof(geom_header));
 
-            // Apply transformation matrix to vertices
-            uint8_t* vertex_data_ptr = modified_geom_data.data() + sizeof(GeometryChunk);
+            // Apply transformation matrix to vertices in place
+            uint8_t* vertex_data_ptr = modified_geom_data->data() + sizeof(GeometryChunk);
 
             uint32_t start_vertex = (transform.vertex_count == UINT32_MAX) ? 0 : transform.vertex_start;
             uint32_t end_vertex = (transform.vertex_count == UINT32_MAX) ? geom_header.vertex_count :
@@ -1096,9 +1070,6 @@ namespace Taffy {
                 }
             }
 
-            asset.remove_chunk(ChunkType::GEOM);
-            asset.add_chunk(ChunkType::GEOM, modified_geom_data, transform_type + "_transformed_geometry");
-
             std::cout << "    ✅ Geometry " << transform_type << " applied successfully!" << std::endl;
             return true;
         }
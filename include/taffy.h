@@ -16,6 +16,8 @@
 #include <unordered_map>
 #include <memory>
 #include <optional>
+#include <span>
+#include <utility>
 #include <fstream>
 #include <cstring>
 #include <algorithm>
@@ -23,6 +25,8 @@
 #include <filesystem>
 #include <iostream>        // ← ADD THIS
 #include <limits>          // ← ADD THIS
+#include <thread>
+#include <atomic>
 
  // Assume Tremor's quantized coordinate system exists
 #include "quan.h"  // Vec3Q, etc.
@@ -46,6 +50,17 @@ namespace Taffy {
             return hash;
         }
 
+        // Bounded variant for fixed-size name fields (e.g. ChunkDirectoryEntry::name);
+        // yields the same hash as above for the NUL-terminated prefix
+        constexpr uint64_t fnv1a_hash(const char* str, size_t max_length) {
+            uint64_t hash = FNV_OFFSET_BASIS;
+            for (size_t i = 0; i < max_length && str[i]; ++i) {
+                hash ^= static_cast<uint64_t>(str[i]);
+                hash *= FNV_PRIME;
+            }
+            return hash;
+        }
+
         // Compile-time hash macro
 #define TAFFY_HASH(str) (Taffy::fnv1a_hash(str))
 
@@ -84,6 +99,7 @@ namespace Taffy {
             Color = 1 << 6,
             BoneIndices = 1 << 7,
             BoneWeights = 1 << 8,
+            Packed = 1 << 9,            // Uses packed VertexAttribute types
             Custom0 = 1 << 16,
             Custom1 = 1 << 17,
             Custom2 = 1 << 18,
@@ -135,6 +151,7 @@ namespace Taffy {
             PART = 0x54524150,  // 'PART'
             SVGU = 0x55475653,  // 'SVGU'
             DEPS = 0x53504544,  // 'DEPS'
+            INDX = 0x58444E49,  // 'INDX' - sorted chunk index (ChunkIndexTable)
         };
 
         enum class FeatureFlags : uint64_t {
@@ -157,6 +174,7 @@ namespace Taffy {
             SVGUI = 1ULL << 15,
             OverlaySupport = 1ULL << 16,
             SDFFont = 1ULL << 17,         // Signed Distance Field fonts
+            CompressedChunks = 1ULL << 18, // One or more chunks use a ChunkCodec
             AIBehavior = 1ULL << 32,
             NPUProcessing = 1ULL << 33,
             LocalLLM = 1ULL << 34,
@@ -244,8 +262,8 @@ namespace Taffy {
             VertexFormat vertex_format;
             Vec3Q bounds_min;
             Vec3Q bounds_max;
-            float lod_distance;
-            uint32_t lod_level;
+            float lod_distance;            // Meters from which this LOD may be drawn (taffy_simplify.h)
+            uint32_t lod_level;            // 0 = full detail
 
             // Mesh shader configuration
             enum RenderMode : uint32_t {
@@ -263,10 +281,46 @@ namespace Taffy {
                 Points = 2
             } ms_primitive_type;
 
-            uint32_t ms_flags;             // Bit 0: meshlet data appended after indices
+            enum MeshletFlags : uint32_t {
+                MeshletData = 1u << 0,              // MeshletDesc, vertex and primitive indices after the indices
+                MeshletBoundsData = 1u << 1,        // MeshletBounds per meshlet after the primitive indices
+                MeshletPackedPrimitives = 1u << 2,  // Primitive indices are uint8_t (else uint32_t), padded to 4 bytes
+                LodErrorData = 1u << 3              // GeometryLodInfo as the last bytes of the chunk
+            };
+
+            uint32_t ms_flags;             // MeshletFlags
             uint32_t reserved[2];          // reserved[0] = meshlet count, reserved[1] = meshlet vertex index count
         };
 
+        // Meshlet block entries (GeometryChunk::MeshletData)
+        struct MeshletDesc {
+            uint32_t vertex_offset;        // First entry in the meshlet vertex indices
+            uint32_t vertex_count;
+            uint32_t primitive_offset;     // First entry in the primitive indices (3 per primitive)
+            uint32_t primitive_count;
+        };
+
+        // Culling data of one meshlet, in the units the shader decodes positions to.
+        // Back-facing when dot(normalize(cone_apex - camera), cone_axis) >= cone_cutoff.
+        struct MeshletBounds {
+            float center[3];               // Bounding sphere
+            float radius;
+            float cone_axis[3];            // Average facing of the triangles
+            float cone_cutoff;             // sin of the cone half-angle, 1 = never cull
+            float cone_apex[3];
+            uint32_t reserved;
+        };
+        static_assert(sizeof(MeshletDesc) == 16 && sizeof(MeshletBounds) == 48,
+                      "Meshlet blocks are part of the file format");
+
+        // Simplification error of a GEOM chunk (GeometryChunk::LodErrorData)
+        struct GeometryLodInfo {
+            float geometric_error;         // Meters the surface may deviate from LOD 0
+            uint32_t source_triangles;     // Triangles in LOD 0
+            uint32_t reserved[2];
+        };
+        static_assert(sizeof(GeometryLodInfo) == 16, "GeometryLodInfo is part of the file format");
+
         // Vertex attribute descriptor for data-driven shaders
         struct VertexAttribute {
             enum Type : uint32_t {
@@ -282,7 +336,16 @@ namespace Taffy {
                 UInt2 = 9,
                 UInt3 = 10,
                 UInt4 = 11,
-                Vec3Q = 12
+                Vec3Q = 12,
+
+                // Packed types (taffy_vertex_format.h), 4-byte aligned.
+                // Positions are relative to GeometryChunk::bounds_min.
+                Position16 = 13,    // 3 x uint16 steps of (bounds_max - bounds_min) / 65535, 2 bytes padding
+                Position32 = 14,    // 3 x uint32 Vec3Q units
+                OctNormal = 15,     // Octahedral unit vector, 2 x snorm16
+                OctTangent = 16,    // Octahedral snorm16 + snorm15, handedness in the top bit
+                Unorm8x4 = 17,      // RGBA8
+                Half2 = 18          // 2 x float16
             };
 
             Type type;
@@ -486,18 +549,95 @@ namespace Taffy {
             uint64_t created_timestamp;
             char creator[64];           // Creator/tool name
             char description[128];      // Asset description
-            uint32_t reserved[16];      // Future expansion
+            uint32_t index_chunk;       // Directory index + 1 of the INDX chunk (0 = none)
+            uint32_t reserved[15];      // Future expansion
+        };
+
+        // Compression applied to a chunk's stored bytes (see taffy_codec.h)
+        enum class ChunkCodec : uint8_t {
+            None = 0,
+            LZ4 = 1,                    // LZ4 block format, fast encoder
+            LZ4HC = 2,                  // LZ4 block format, high-ratio encoder
         };
 
+        // Residency class of a chunk; the packager orders payloads by class so
+        // each class occupies one contiguous byte range of the file
+        enum class ResidencyClass : uint8_t {
+            Unspecified = 0,            // Derived from the chunk type (older files)
+            Boot = 1,                   // Read at mount (MANF, BOOT, DEPS)
+            Resident = 2,               // Loaded with the asset and kept
+            Streamed = 3,               // Loaded on demand
+            Debug = 4,                  // Tools and diagnostics only
+        };
+
+        // In a file, size and checksum describe the stored (possibly compressed)
+        // bytes. Asset keeps chunks decoded in memory, so its directory describes
+        // the decoded payload and codec is the codec used on the next save.
         struct ChunkDirectoryEntry {
             ChunkType type;             // Chunk type identifier
             uint32_t flags;             // Chunk-specific flags
             uint64_t offset;            // Offset from start of file
-            uint64_t size;              // Size of chunk data
-            uint32_t checksum;          // CRC32 checksum
+            uint64_t size;              // Size of chunk data as stored
+            uint32_t checksum;          // CRC32 checksum of the stored bytes
             char name[32];              // Chunk name (for debugging)
-            uint32_t reserved[4];       // Future expansion
+            ChunkCodec codec;           // Compression codec (0 = stored uncompressed)
+            uint8_t alignment_log2;     // Offset is a multiple of (1 << alignment_log2)
+            ResidencyClass residency;   // When the chunk is needed (see taffy_layout.h)
+            uint8_t reserved_bytes[1];  // Future expansion
+            uint64_t uncompressed_size; // Decoded size when codec != None
+            uint32_t group;             // Co-access group, laid out contiguously (0 = none)
+        };
+        static_assert(sizeof(ChunkDirectoryEntry) == 76, "ChunkDirectoryEntry is part of the file format");
+
+        // Payload alignment (16 for SIMD, 64 for cache lines, 4096 for mapped GPU
+        // uploads). Padding between payloads is zero and not covered by checksums.
+        constexpr uint8_t MAX_CHUNK_ALIGNMENT_LOG2 = 16;
+        constexpr uint32_t MAX_CHUNK_ALIGNMENT = uint32_t(1) << MAX_CHUNK_ALIGNMENT_LOG2;
+
+        // INDX side-chunk: lets a loader open a package without reading the
+        // whole directory. Layout: header, `type_count` TypeEntry sorted by
+        // type, `boot_count` directory indices of the Boot class, then
+        // `entry_count` NameEntry sorted by (name_hash, index). Always stored
+        // uncompressed so it can be binary searched in place.
+        struct ChunkIndexTable {
+            char magic[4];                  // "CIDX"
+            uint32_t version;
+            uint32_t entry_count;           // Equals AssetHeader::chunk_count
+            uint32_t type_count;
+            uint32_t boot_count;
+            uint32_t reserved[3];
+
+            static constexpr uint32_t VERSION = 1;
+
+            struct TypeEntry {
+                ChunkType type;
+                uint32_t first_index;       // First directory entry of this type
+                uint32_t count;
+            };
+
+            struct NameEntry {
+                uint64_t name_hash;         // fnv1a_hash of the chunk name
+                uint32_t index;             // Directory index
+            };
         };
+        static_assert(sizeof(ChunkIndexTable) == 32 && sizeof(ChunkIndexTable::NameEntry) == 12,
+                      "ChunkIndexTable is part of the file format");
+
+        inline uint64_t chunk_alignment(const ChunkDirectoryEntry& entry) {
+            return uint64_t(1) << entry.alignment_log2;
+        }
+
+        // Converts a power-of-two byte alignment to its log2; false if invalid
+        inline bool chunk_alignment_log2(uint32_t bytes, uint8_t& log2) {
+            if (bytes == 0 || bytes > MAX_CHUNK_ALIGNMENT || (bytes & (bytes - 1)) != 0) {
+                return false;
+            }
+            log2 = 0;
+            while ((uint32_t(1) << log2) < bytes) {
+                ++log2;
+            }
+            return true;
+        }
         // =============================================================================
         // SDF FONT CHUNK - Signed Distance Field font rendering
         // =============================================================================
@@ -559,11 +699,162 @@ namespace Taffy {
         // MAIN ASSET CLASS
         // =============================================================================
 
+        // =============================================================================
+        // CHUNK DIRECTORY INDEX
+        // =============================================================================
+
+        // Open-addressing lookup table over a chunk directory, keyed by ChunkType and
+        // by the FNV-1a hash of the chunk name. Lookups are O(1) and never allocate.
+        // When a type or name repeats, the first directory entry wins, matching a
+        // front-to-back scan. The index stores positions only, so the directory is
+        // passed back in on lookup and may live in any container.
+        class ChunkIndex {
+        public:
+            void build(std::span<const ChunkDirectoryEntry> directory) {
+                size_t capacity = 16;
+                while (capacity < directory.size() * 2) {
+                    capacity <<= 1;
+                }
+                type_slots_.assign(capacity, TypeSlot{});
+                name_slots_.assign(capacity, NameSlot{});
+                for (size_t i = 0; i < directory.size(); ++i) {
+                    insert_slots(directory, static_cast<uint32_t>(i));
+                }
+            }
+
+            // Index an entry appended at the end of the directory
+            void append(std::span<const ChunkDirectoryEntry> directory) {
+                if (directory.empty()) {
+                    return;
+                }
+                if (directory.size() * 2 > name_slots_.size()) {
+                    build(directory);
+                    return;
+                }
+                insert_slots(directory, static_cast<uint32_t>(directory.size() - 1));
+            }
+
+            void clear() {
+                type_slots_.clear();
+                name_slots_.clear();
+            }
+
+            int find(std::span<const ChunkDirectoryEntry>, ChunkType type) const {
+                if (type_slots_.empty()) {
+                    return -1;
+                }
+                const size_t mask = type_slots_.size() - 1;
+                for (size_t slot = mix(static_cast<uint32_t>(type)) & mask;; slot = (slot + 1) & mask) {
+                    const auto& entry = type_slots_[slot];
+                    if (entry.index_plus_one == 0) {
+                        return -1;
+                    }
+                    if (entry.type == type) {
+                        return static_cast<int>(entry.index_plus_one - 1);
+                    }
+                }
+            }
+
+            int find(std::span<const ChunkDirectoryEntry> directory, const char* name, size_t length) const {
+                if (name_slots_.empty() || length >= sizeof(ChunkDirectoryEntry::name)) {
+                    return -1;
+                }
+                const uint64_t hash = fnv1a_hash(name, length);
+                const size_t mask = name_slots_.size() - 1;
+                for (size_t slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask) {
+                    const auto& entry = name_slots_[slot];
+                    if (entry.index_plus_one == 0) {
+                        return -1;
+                    }
+                    if (entry.hash == hash) {
+                        const auto& candidate = directory[entry.index_plus_one - 1];
+                        if (::strnlen(candidate.name, sizeof(candidate.name)) == length &&
+                            std::memcmp(candidate.name, name, length) == 0) {
+                            return static_cast<int>(entry.index_plus_one - 1);
+                        }
+                    }
+                }
+            }
+
+            int find(std::span<const ChunkDirectoryEntry> directory, const std::string& name) const {
+                return find(directory, name.data(), name.size());
+            }
+
+        private:
+            struct TypeSlot {
+                ChunkType type{};
+                uint32_t index_plus_one = 0;   // 0 marks an empty slot
+            };
+            struct NameSlot {
+                uint64_t hash = 0;
+                uint32_t index_plus_one = 0;
+            };
+
+            static size_t mix(uint32_t value) {
+                return static_cast<size_t>((static_cast<uint64_t>(value) * 0x9E3779B97F4A7C15ULL) >> 32);
+            }
+
+            void insert_slots(std::span<const ChunkDirectoryEntry> directory, uint32_t index) {
+                const auto& entry = directory[index];
+
+                const size_t type_mask = type_slots_.size() - 1;
+                for (size_t slot = mix(static_cast<uint32_t>(entry.type)) & type_mask;; slot = (slot + 1) & type_mask) {
+                    auto& target = type_slots_[slot];
+                    if (target.index_plus_one == 0) {
+                        target = { entry.type, index + 1 };
+                        break;
+                    }
+                    if (target.type == entry.type) {
+                        break;  // Keep the earlier entry
+                    }
+                }
+
+                const uint64_t hash = fnv1a_hash(entry.name, sizeof(entry.name));
+                const size_t name_mask = name_slots_.size() - 1;
+                for (size_t slot = static_cast<size_t>(hash) & name_mask;; slot = (slot + 1) & name_mask) {
+                    auto& target = name_slots_[slot];
+                    if (target.index_plus_one == 0) {
+                        target = { hash, index + 1 };
+                        break;
+                    }
+                    if (target.hash == hash &&
+                        std::strncmp(directory[target.index_plus_one - 1].name, entry.name, sizeof(entry.name)) == 0) {
+                        break;  // Keep the earlier entry
+                    }
+                }
+            }
+
+            std::vector<TypeSlot> type_slots_;
+            std::vector<NameSlot> name_slots_;
+        };
+
+        class MappedAsset;
+
+        // Per-chunk outcome of Asset::load_from_file_parallel
+        struct ChunkLoadResult {
+            enum class Status : uint8_t {
+                Ok,
+                OutOfBounds,        // Directory entry points past the end of the file
+                ReadError,          // Short read or I/O failure
+                ChecksumMismatch,   // Data was loaded but its CRC32 does not match
+                DecodeError         // Stored bytes could not be decompressed
+            };
+
+            Status status = Status::Ok;
+            uint32_t expected_checksum = 0;
+            uint32_t calculated_checksum = 0;
+        };
+
         class Asset {
+            friend class MappedAsset;
+
         private:
             AssetHeader header_;
             std::vector<ChunkDirectoryEntry> chunk_directory_;
             std::vector<std::vector<uint8_t>> chunk_data_;
+            ChunkIndex chunk_index_;
+            uint8_t payload_alignment_log2_ = 0;
+            bool write_chunk_index_ = false;
 
         public:
             inline Asset();
@@ -571,7 +862,10 @@ namespace Taffy {
             Asset(const Asset& other)
                 : header_(other.header_)
                 , chunk_directory_(other.chunk_directory_)
-                , chunk_data_(other.chunk_data_) {
+                , chunk_data_(other.chunk_data_)
+                , chunk_index_(other.chunk_index_)
+                , payload_alignment_log2_(other.payload_alignment_log2_)
+                , write_chunk_index_(other.write_chunk_index_) {
                 std::cout << "📋 Asset copied" << std::endl;
             }
             Asset& operator=(const Asset& other) {
@@ -579,6 +873,9 @@ namespace Taffy {
                     header_ = other.header_;
                     chunk_directory_ = other.chunk_directory_;
                     chunk_data_ = other.chunk_data_;
+                    chunk_index_ = other.chunk_index_;
+                    payload_alignment_log2_ = other.payload_alignment_log2_;
+                    write_chunk_index_ = other.write_chunk_index_;
                     std::cout << "📋 Asset copy-assigned" << std::endl;
                 }
                 return *this;
@@ -586,7 +883,10 @@ namespace Taffy {
             Asset(Asset&& other) noexcept
                 : header_(std::move(other.header_))
                 , chunk_directory_(std::move(other.chunk_directory_))
-                , chunk_data_(std::move(other.chunk_data_)) {
+                , chunk_data_(std::move(other.chunk_data_))
+                , chunk_index_(std::move(other.chunk_index_))
+                , payload_alignment_log2_(other.payload_alignment_log2_)
+                , write_chunk_index_(other.write_chunk_index_) {
                 std::cout << "🚀 Asset moved" << std::endl;
             }
             Asset& operator=(Asset&& other) noexcept {
@@ -594,6 +894,9 @@ namespace Taffy {
                     header_ = std::move(other.header_);
                     chunk_directory_ = std::move(other.chunk_directory_);
                     chunk_data_ = std::move(other.chunk_data_);
+                    chunk_index_ = std::move(other.chunk_index_);
+                    payload_alignment_log2_ = other.payload_alignment_log2_;
+                    write_chunk_index_ = other.write_chunk_index_;
                     std::cout << "🚀 Asset move-assigned" << std::endl;
                 }
                 return *this;
@@ -618,8 +921,34 @@ namespace Taffy {
             // Feature checking
             inline bool has_feature(FeatureFlags flag) const;
 
+            // Scoped write access to a chunk payload. The directory entry's size and
+            // checksum are refreshed once, when the edit goes out of scope.
+            class ChunkEdit {
+            public:
+                ChunkEdit() = default;
+                ChunkEdit(Asset* asset, size_t index) : asset_(asset), index_(index) {}
+                ChunkEdit(ChunkEdit&& other) noexcept
+                    : asset_(std::exchange(other.asset_, nullptr)), index_(other.index_) {}
+                ChunkEdit& operator=(ChunkEdit&&) = delete;
+                ChunkEdit(const ChunkEdit&) = delete;
+                ChunkEdit& operator=(const ChunkEdit&) = delete;
+                inline ~ChunkEdit();
+
+                explicit operator bool() const { return asset_ != nullptr; }
+                std::vector<uint8_t>& operator*() const { return asset_->chunk_data_[index_]; }
+                std::vector<uint8_t>* operator->() const { return &asset_->chunk_data_[index_]; }
+
+            private:
+                Asset* asset_ = nullptr;
+                size_t index_ = 0;
+            };
+
             // Chunk management
-            inline void add_chunk(ChunkType type, const std::vector<uint8_t>& data, const std::string& name = "");
+            inline void add_chunk(ChunkType type, const std::vector<uint8_t>& data, const std::string& name = "",
+                                  ChunkCodec codec = ChunkCodec::None);
+            inline size_t set_chunk_codec(ChunkType type, ChunkCodec codec);  // Applies to every chunk of `type`
+            inline size_t set_chunk_residency(ChunkType type, ResidencyClass residency);  // Likewise
+            inline bool set_chunk_group(const std::string& name, uint32_t group);
             inline bool has_chunk(ChunkType type) const;
             inline bool has_chunk_named(const std::string& name) const;
             inline bool remove_chunk(ChunkType type);
@@ -627,6 +956,13 @@ namespace Taffy {
             inline std::optional<std::vector<uint8_t>> get_chunk_data(const std::string& name) const;
             inline std::optional<ChunkDirectoryEntry> get_chunk_entry(ChunkType type) const;
             inline std::optional<ChunkDirectoryEntry> get_chunk_entry(const std::string& name) const;
+
+            // Non-copying chunk access; views are invalidated by add_chunk/remove_chunk
+            inline std::optional<std::span<const uint8_t>> view_chunk(ChunkType type) const;
+            inline std::optional<std::span<const uint8_t>> view_chunk(const std::string& name) const;
+            inline ChunkEdit mutable_chunk(ChunkType type);
+            inline ChunkEdit mutable_chunk(const std::string& name);
+
             inline size_t get_chunk_count() const;
             inline std::vector<ChunkType> get_chunk_types() const;
             inline const std::vector<ChunkDirectoryEntry>& get_chunk_directory() const;
@@ -634,9 +970,25 @@ namespace Taffy {
             inline uint64_t get_file_size() const;
 
             // File I/O
+            // Minimum payload alignment used by save_to_file (power of two up to
+            // MAX_CHUNK_ALIGNMENT). Chunks loaded with a larger alignment keep it.
+            inline bool set_payload_alignment(uint32_t bytes);
+            inline uint32_t get_payload_alignment() const { return uint32_t(1) << payload_alignment_log2_; }
+            // Append an INDX chunk (ChunkIndexTable) on save so streaming loaders
+            // can open the file without reading its whole directory
+            inline void set_chunk_index(bool enabled) { write_chunk_index_ = enabled; }
+            inline bool get_chunk_index() const { return write_chunk_index_; }
             inline bool save_to_file(const std::filesystem::path& path);
             inline bool load_from_file_safe(const std::string& path);
 
+            // Reads the directory, then reads and verifies chunks on a pool of worker
+            // threads (0 = hardware concurrency). chunk_data_ keeps directory order and
+            // every chunk is attempted; failures are reported per chunk through
+            // `results` instead of aborting. Returns true only if all chunks verified.
+            inline bool load_from_file_parallel(const std::string& path,
+                                                std::vector<ChunkLoadResult>* results = nullptr,
+                                                unsigned thread_count = 0);
+
             // Utility
             inline void print_info() const;
 
@@ -645,7 +997,8 @@ namespace Taffy {
             inline AssetHeader get_header() const{ return header_; }
 
         private:
-            inline uint32_t calculate_crc32(const uint8_t* data, size_t length) const;
+            inline void refresh_chunk_entry(size_t index);
+            static inline uint32_t calculate_crc32(const uint8_t* data, size_t length);
         };
 
         // =============================================================================
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+#include "taffy.h"
+
+namespace Taffy {
+
+// Immutable, reference-counted chunk payload. Holders keep the bytes alive
+// even after the cache has evicted the chunk.
+class ChunkBuffer {
+public:
+    explicit ChunkBuffer(std::vector<uint8_t> bytes) : bytes_(std::move(bytes)) {}
+
+    const uint8_t* data() const { return bytes_.data(); }
+    size_t size() const { return bytes_.size(); }
+    bool empty() const { return bytes_.empty(); }
+    std::span<const uint8_t> span() const { return bytes_; }
+    const std::vector<uint8_t>& bytes() const { return bytes_; }
+    std::vector<uint8_t>::const_iterator begin() const { return bytes_.begin(); }
+    std::vector<uint8_t>::const_iterator end() const { return bytes_.end(); }
+
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+using ChunkBufferPtr = std::shared_ptr<const ChunkBuffer>;
+
+enum class EvictionPolicy : uint8_t {
+    Clock = 0,          // Second chance; cheapest hits
+    LRU = 1,            // Least recently used
+    LFU = 2,            // Least frequently used, counts halve under eviction pressure
+    GreedyDual = 3,     // Size-aware GreedyDual: large, cold chunks go first
+};
+
+const char* eviction_policy_name(EvictionPolicy policy);
+
+class ChunkCache;
+
+// Byte budget shared by several caches (e.g. every open loader). When the
+// pool is over budget, an inserting cache evicts from all member caches in
+// turn, each by its own policy.
+class CacheMemoryPool {
+public:
+    static constexpr uint64_t DEFAULT_BUDGET = 256ull * 1024 * 1024;
+
+    explicit CacheMemoryPool(uint64_t budget_bytes = DEFAULT_BUDGET) : budget_(budget_bytes) {}
+
+    CacheMemoryPool(const CacheMemoryPool&) = delete;
+    CacheMemoryPool& operator=(const CacheMemoryPool&) = delete;
+
+    // Process-wide pool that loaders join by default
+    static const std::shared_ptr<CacheMemoryPool>& global();
+
+    void set_budget(uint64_t budget_bytes) { budget_.store(budget_bytes, std::memory_order_relaxed); }
+    uint64_t get_budget() const { return budget_.load(std::memory_order_relaxed); }
+    uint64_t size_bytes() const { return bytes_.load(std::memory_order_relaxed); }
+    size_t cache_count() const;
+
+private:
+    friend class ChunkCache;
+
+    void attach(ChunkCache* cache);
+    void detach(ChunkCache* cache);
+
+    // Evict from member caches until back under budget; `keep` is never evicted
+    void reclaim(const ChunkCache* keep_cache, uint32_t keep);
+
+    mutable std::mutex mutex_;      // Guards caches_; held while evicting for the pool
+    std::vector<ChunkCache*> caches_;
+    size_t next_cache_ = 0;
+    std::atomic<uint64_t> budget_;
+    std::atomic<uint64_t> bytes_{ 0 };
+};
+
+// Chunk cache keyed by directory index.
+//
+// Every chunk has its own slot holding an atomic shared_ptr, so a hit is a
+// single atomic load plus relaxed stores of the policy's recency/frequency
+// data and never touches a shared lock. Bookkeeping for eviction is split
+// over SHARD_COUNT shards (index % SHARD_COUNT), each with its own mutex and
+// ring of resident chunks; misses only lock the shard they insert into and
+// the shards they evict from. CLOCK walks the ring; the other policies
+// sample up to EVICTION_SAMPLES candidates in each of SAMPLED_SHARDS shards
+// and evict the lowest score. Byte
+// totals are running atomic counters, so neither eviction nor statistics
+// walk the cache.
+//
+// Limits, checked on every insert: the cache's own budget, an optional quota
+// per ChunkType, and the budget of the memory pool the cache belongs to.
+// Pinned chunks count against all of them but are never evicted.
+//
+// Slots are allocated SLOT_PAGE_SIZE at a time when a chunk in the page is
+// first inserted or configured, so sizing the cache for a large directory
+// costs one pointer per page.
+class ChunkCache {
+public:
+    static constexpr size_t SHARD_COUNT = 16;
+    static constexpr size_t SLOT_PAGE_SIZE = 1024;
+    static constexpr size_t EVICTION_SAMPLES = 8;
+    static constexpr size_t SAMPLED_SHARDS = 4;
+    static constexpr size_t MAX_TRACKED_TYPES = 32;
+    static constexpr uint64_t UNLIMITED = UINT64_MAX;
+
+    explicit ChunkCache(uint64_t budget_bytes = UNLIMITED) : budget_(budget_bytes) {}
+    ~ChunkCache();
+
+    ChunkCache(const ChunkCache&) = delete;
+    ChunkCache& operator=(const ChunkCache&) = delete;
+
+    // Drop everything and size the slot table for `slot_count` chunks; slot
+    // pages are allocated on first use. Not safe to call while other threads
+    // use this cache directly.
+    void reset(size_t slot_count);
+
+    // Record a slot's chunk type (for quotas) and pin state; call after
+    // reset(), before the slot is used
+    void set_chunk_info(uint32_t index, ChunkType type, bool pinned);
+    void set_pinned(uint32_t index, bool pinned);
+    bool is_pinned(uint32_t index) const;
+
+    // Lock-free lookup; counts a hit or miss and marks the chunk as recently used
+    ChunkBufferPtr find(uint32_t index) const;
+
+    // Lookup without touching statistics or recency
+    ChunkBufferPtr peek(uint32_t index) const;
+
+    // Cache a loaded chunk and evict others until every limit is met.
+    // If another thread cached the same chunk first, its buffer is returned.
+    ChunkBufferPtr insert(uint32_t index, std::vector<uint8_t> data);
+
+    // Drop one chunk (even if pinned); false if it was not cached
+    bool erase(uint32_t index);
+
+    void clear();
+    void reset_stats();
+
+    // Lowering the budget or a quota evicts down to it right away
+    void set_budget(uint64_t budget_bytes);
+    uint64_t get_budget() const { return budget_.load(std::memory_order_relaxed); }
+
+    void set_policy(EvictionPolicy policy) { policy_.store(policy, std::memory_order_relaxed); }
+    EvictionPolicy get_policy() const { return policy_.load(std::memory_order_relaxed); }
+
+    // Byte quota for one chunk type (UNLIMITED removes it)
+    void set_type_quota(ChunkType type, uint64_t bytes);
+    uint64_t get_type_quota(ChunkType type) const;
+    uint64_t type_size_bytes(ChunkType type) const;
+
+    // Join a shared pool (nullptr to leave); cached bytes move with the cache
+    void set_memory_pool(std::shared_ptr<CacheMemoryPool> pool);
+    const std::shared_ptr<CacheMemoryPool>& memory_pool() const { return pool_; }
+
+    size_t slot_count() const { return slot_count_; }
+    size_t entry_count() const { return entries_.load(std::memory_order_relaxed); }
+    uint64_t size_bytes() const { return bytes_.load(std::memory_order_relaxed); }
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+    // Chunks (and their bytes) dropped to meet a limit; erase() is not counted
+    uint64_t evictions() const;
+    uint64_t evicted_bytes() const;
+
+private:
+    friend class CacheMemoryPool;
+
+    static constexpr uint8_t NO_TYPE = 0xFF;
+
+    struct Slot {
+        std::atomic<ChunkBufferPtr> buffer;
+        std::atomic<bool> referenced{ false };      // CLOCK
+        std::atomic<uint64_t> last_access{ 0 };     // LRU; tie-break for the others
+        std::atomic<uint32_t> frequency{ 0 };       // LFU
+        std::atomic<double> priority{ 0.0 };        // GreedyDual H value
+        std::atomic<bool> pinned{ false };
+        uint8_t type_slot = NO_TYPE;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::vector<uint32_t> ring;     // Resident chunk indices
+        size_t hand = 0;
+        mutable std::atomic<uint64_t> hits{ 0 };
+        mutable std::atomic<uint64_t> misses{ 0 };
+        std::atomic<uint64_t> evictions{ 0 };
+        std::atomic<uint64_t> evicted_bytes{ 0 };
+    };
+
+    struct TypeUsage {
+        std::atomic<uint32_t> type{ 0 };
+        std::atomic<uint64_t> quota{ UNLIMITED };
+        std::atomic<uint64_t> bytes{ 0 };
+    };
+
+    Shard& shard_for(uint32_t index) const { return shards_[index % SHARD_COUNT]; }
+
+    // nullptr if out of range or its page was never allocated
+    Slot* find_slot(uint32_t index) const;
+    // Allocates the page on first use; nullptr if out of range
+    Slot* slot(uint32_t index);
+    // Slot of a chunk known to be in a ring (its page exists)
+    Slot& resident_slot(uint32_t index) const {
+        return slot_pages_[index / SLOT_PAGE_SIZE].load(std::memory_order_acquire)[index % SLOT_PAGE_SIZE];
+    }
+    void free_slot_pages();
+
+    void touch(Slot& slot, size_t size) const;
+    uint8_t find_type_slot(ChunkType type) const;
+    uint8_t add_type_slot(ChunkType type);
+
+    // Lower scores are evicted first
+    using Score = std::pair<double, uint64_t>;
+    Score score(const Slot& slot, EvictionPolicy policy) const;
+
+    // Evict one chunk from `shard` (caller holds its mutex), never `keep` or
+    // a pinned chunk, and only of `type_slot` unless it is NO_TYPE. Returns
+    // false if nothing could be evicted.
+    bool evict_one(Shard& shard, uint32_t keep, uint8_t type_slot);
+    bool evict_clock(Shard& shard, uint32_t keep, uint8_t type_slot);
+
+    // Position of the lowest-scoring sampled candidate in `shard` (caller
+    // holds its mutex), ring.size() if none
+    size_t sample_shard(Shard& shard, uint32_t keep, uint8_t type_slot, size_t& sample_count);
+
+    // Compare the best candidates of several shards and evict the lowest
+    bool evict_sampled(uint32_t keep, uint8_t type_slot);
+    void evict_at(Shard& shard, size_t position, bool counted = true);
+    void release(const Slot& slot, size_t size);
+    bool evictable(uint32_t index, uint32_t keep, uint8_t type_slot) const;
+
+    // Evict round-robin over the shards while `over_limit()` holds; stops
+    // after a full pass that found nothing to evict
+    template <typename Predicate>
+    void evict_while(Predicate over_limit, uint32_t keep, uint8_t type_slot);
+    void enforce_limits(uint32_t index);
+
+    std::unique_ptr<std::atomic<Slot*>[]> slot_pages_;
+    size_t slot_page_count_ = 0;
+    size_t slot_count_ = 0;
+    mutable std::array<Shard, SHARD_COUNT> shards_;
+    std::atomic<uint64_t> budget_;
+    std::atomic<uint64_t> bytes_{ 0 };
+    std::atomic<size_t> entries_{ 0 };
+    std::atomic<size_t> next_victim_shard_{ 0 };
+    std::atomic<EvictionPolicy> policy_{ EvictionPolicy::Clock };
+    std::atomic<uint64_t> tick_{ 1 };           // Advances on every insert
+    std::atomic<double> inflation_{ 0.0 };      // GreedyDual L value
+
+    std::mutex type_mutex_;                     // Serializes adding type entries
+    std::array<TypeUsage, MAX_TRACKED_TYPES> types_;
+    std::atomic<size_t> type_count_{ 0 };
+
+    std::shared_ptr<CacheMemoryPool> pool_;
+};
+
+} // namespace Taffy
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "taffy.h"
+
+namespace Taffy {
+
+// Per-chunk compression codecs. Both LZ4 variants emit the standard LZ4 block
+// format and share one decoder; LZ4HC spends more time searching for matches
+// to produce smaller output for cold, write-once data.
+
+// Human readable codec name ("none", "lz4", "lz4hc", or "unknown")
+const char* chunk_codec_name(ChunkCodec codec);
+
+// Upper bound of the compressed size for `size` input bytes
+size_t chunk_compress_bound(size_t size);
+
+// Compress `input` into `output` (replacing its contents). Returns false for
+// ChunkCodec::None or an unknown codec.
+bool compress_chunk(ChunkCodec codec, std::span<const uint8_t> input, std::vector<uint8_t>& output);
+
+// Decompress exactly output.size() bytes. Fails on malformed input, on
+// truncated or oversized output, or an unknown codec; never writes outside
+// `output`.
+bool decompress_chunk(ChunkCodec codec, std::span<const uint8_t> input, std::span<uint8_t> output);
+
+// Decode the stored bytes of a directory entry into `decoded`. Chunks stored
+// with ChunkCodec::None are copied as-is. Rejects implausible
+// uncompressed_size values before allocating.
+bool decode_chunk_payload(const ChunkDirectoryEntry& entry, std::span<const uint8_t> stored,
+                          std::vector<uint8_t>& decoded);
+
+} // namespace Taffy
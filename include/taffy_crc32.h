@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Taffy {
+
+// CRC-32 as stored in ChunkDirectoryEntry::checksum (reflected polynomial
+// 0xEDB88320, init 0xFFFFFFFF, final xor 0xFFFFFFFF).
+//
+// Pass the previous result as `crc` to checksum data incrementally:
+//   crc32(b, nb, crc32(a, na)) == crc32(ab, na + nb)
+//
+// The fastest implementation available on the running CPU is selected once
+// at startup (PCLMULQDQ folding on x86-64, the CRC32 instructions on ARMv8,
+// slice-by-16 tables otherwise). All of them produce identical results.
+uint32_t crc32(const void* data, size_t length, uint32_t crc = 0);
+
+// Portable slice-by-16 table implementation
+uint32_t crc32_slice16(const void* data, size_t length, uint32_t crc = 0);
+
+// Bit-at-a-time reference implementation (verification and benchmarking only)
+uint32_t crc32_reference(const void* data, size_t length, uint32_t crc = 0);
+
+// Name of the implementation crc32() dispatches to
+const char* crc32_implementation();
+
+} // namespace Taffy
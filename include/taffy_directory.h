@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+#include "taffy.h"
+#include "taffy_file.h"
+#include "taffy_layout.h"
+
+namespace Taffy {
+
+// Name writers give the INDX chunk
+constexpr const char* CHUNK_INDEX_NAME = "chunk_index";
+
+// Serialize the INDX chunk (ChunkIndexTable) for `directory` followed by the
+// INDX chunk itself, named CHUNK_INDEX_NAME, as entry directory.size(). Only
+// types, names and residency are used, so it can be built before any
+// payload offset is known.
+std::vector<uint8_t> build_chunk_index_table(std::span<const ChunkDirectoryEntry> directory);
+
+// Array of fixed-size records in a file, read a page at a time on first
+// access. Resident pages are read without locking; page reads are
+// serialized. Pointers stay valid until reset() or clear().
+template <typename T>
+class PagedTable {
+public:
+    PagedTable() = default;
+    PagedTable(const PagedTable&) = delete;
+    PagedTable& operator=(const PagedTable&) = delete;
+
+    // Not safe while other threads use the table
+    void reset(const PositionalFile* file, uint64_t offset, uint32_t count, uint32_t page_entries) {
+        clear();
+        file_ = file;
+        offset_ = offset;
+        count_ = count;
+        page_entries_ = page_entries;
+        page_count_ = (count + page_entries - 1) / page_entries;
+        // Default-initialized: the OS commits memory only for pages we read
+        data_.reset(new T[count]);
+        resident_.reset(new std::atomic<bool>[page_count_]);
+        for (uint32_t page = 0; page < page_count_; ++page) {
+            resident_[page].store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void clear() {
+        data_.reset();
+        resident_.reset();
+        file_ = nullptr;
+        count_ = page_count_ = 0;
+    }
+
+    uint32_t size() const { return count_; }
+
+    // nullptr if out of range or the page could not be read
+    const T* get(uint32_t index) const {
+        if (index >= count_) {
+            return nullptr;
+        }
+        const uint32_t page = index / page_entries_;
+        if (!resident_[page].load(std::memory_order_acquire) && !load_pages(page, page + 1)) {
+            return nullptr;
+        }
+        return &data_[index];
+    }
+
+    // Read every missing page, each run of them with one read
+    bool load_all() const { return load_pages(0, page_count_); }
+
+    // Contiguous records; only meaningful after load_all()
+    std::span<const T> span() const { return { data_.get(), count_ }; }
+
+    bool is_resident(uint32_t index) const {
+        return index < count_ && resident_[index / page_entries_].load(std::memory_order_acquire);
+    }
+
+    size_t resident_pages() const {
+        size_t pages = 0;
+        for (uint32_t page = 0; page < page_count_; ++page) {
+            pages += resident_[page].load(std::memory_order_relaxed) ? 1 : 0;
+        }
+        return pages;
+    }
+
+    // Runs under the page lock for every record read, before it is published
+    std::function<void(uint32_t index, const T& record)> on_load;
+
+private:
+    bool load_pages(uint32_t first, uint32_t last) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (uint32_t page = first; page < last;) {
+            if (resident_[page].load(std::memory_order_relaxed)) {
+                ++page;
+                continue;
+            }
+            uint32_t end = page + 1;
+            while (end < last && !resident_[end].load(std::memory_order_relaxed)) {
+                ++end;
+            }
+            const uint32_t begin_index = page * page_entries_;
+            const uint32_t end_index = std::min(count_, end * page_entries_);
+            if (!file_ || !file_->read_at(offset_ + uint64_t(begin_index) * sizeof(T), &data_[begin_index],
+                                          size_t(end_index - begin_index) * sizeof(T))) {
+                return false;
+            }
+            if (on_load) {
+                for (uint32_t i = begin_index; i < end_index; ++i) {
+                    on_load(i, data_[i]);
+                }
+            }
+            for (; page < end; ++page) {
+                resident_[page].store(true, std::memory_order_release);
+            }
+        }
+        return true;
+    }
+
+    const PositionalFile* file_ = nullptr;
+    uint64_t offset_ = 0;
+    uint32_t count_ = 0;
+    uint32_t page_entries_ = 1;
+    uint32_t page_count_ = 0;
+    std::unique_ptr<T[]> data_;
+    std::unique_ptr<std::atomic<bool>[]> resident_;
+    mutable std::mutex mutex_;
+};
+
+// Chunk directory of an open package.
+//
+// Eager mode reads every entry at open and indexes them in a ChunkIndex
+// hash table. Lazy mode needs an INDX chunk (AssetHeader::index_chunk) and
+// reads only its header, type table and Boot list at open; directory
+// entries and pages of the sorted name table are read on first use, and
+// names resolve by binary search. A 100k-chunk package then opens with a
+// few KiB of reads instead of 7.5 MiB of directory.
+class ChunkDirectory {
+public:
+    static constexpr uint32_t DIRECTORY_PAGE_ENTRIES = 64;     // 4.75 KiB per read
+    static constexpr uint32_t NAME_PAGE_ENTRIES = 512;         // 6 KiB per read
+
+    ChunkDirectory() = default;
+    ChunkDirectory(const ChunkDirectory&) = delete;
+    ChunkDirectory& operator=(const ChunkDirectory&) = delete;
+
+    // Falls back to eager mode when `lazy` is false or the file has no
+    // usable INDX chunk. `file` must stay open while the directory is used.
+    bool open(const PositionalFile& file, const AssetHeader& header, bool lazy);
+    void clear();
+
+    bool is_lazy() const { return lazy_; }
+    uint32_t size() const { return entries_.size(); }
+
+    // nullptr if out of range or unreadable
+    const ChunkDirectoryEntry* entry(uint32_t index) const { return entries_.get(index); }
+
+    // Every entry; reads the rest of a lazy directory (empty on failure)
+    std::span<const ChunkDirectoryEntry> entries() const;
+
+    // Directory index, or -1. A repeated type or name resolves to its first entry.
+    int find(ChunkType type) const;
+    int find(const char* name, size_t length) const;
+    int find(const std::string& name) const { return find(name.data(), name.size()); }
+
+    // Byte range of a residency class. Lazy directories answer the Boot
+    // class from the index; other classes read the whole directory.
+    ResidencySpan residency_span(ResidencyClass residency) const;
+
+    // Visit the entries already in memory
+    void for_each_resident(const std::function<void(uint32_t index, const ChunkDirectoryEntry& entry)>& visit) const;
+    size_t resident_entries() const;
+
+    // Runs once for each entry as it is read, including those read by open()
+    void set_entry_observer(std::function<void(uint32_t index, const ChunkDirectoryEntry& entry)> observer) {
+        entries_.on_load = std::move(observer);
+    }
+
+private:
+    bool open_lazy(const PositionalFile& file, const AssetHeader& header);
+
+    PagedTable<ChunkDirectoryEntry> entries_;
+    bool lazy_ = false;
+
+    // Eager mode
+    ChunkIndex hash_index_;
+
+    // Lazy mode
+    PagedTable<ChunkIndexTable::NameEntry> names_;
+    std::vector<ChunkIndexTable::TypeEntry> types_;     // Sorted by type
+    std::vector<uint32_t> boot_chunks_;
+};
+
+} // namespace Taffy
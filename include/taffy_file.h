@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace Taffy {
+
+// Read-only file handle with positional reads.
+//
+// read_at() never touches a shared file position (pread on POSIX, ReadFile
+// with an explicit OVERLAPPED offset on Windows), so any number of threads
+// can read different chunks from one handle at the same time without a lock.
+class PositionalFile {
+public:
+    PositionalFile() = default;
+    ~PositionalFile();
+
+    // Move only, no copy
+    PositionalFile(PositionalFile&& other) noexcept;
+    PositionalFile& operator=(PositionalFile&& other) noexcept;
+    PositionalFile(const PositionalFile&) = delete;
+    PositionalFile& operator=(const PositionalFile&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+
+#ifdef _WIN32
+    bool is_open() const { return handle_ != nullptr; }
+    void* native_handle() const { return handle_; }
+#else
+    bool is_open() const { return fd_ >= 0; }
+    int native_handle() const { return fd_; }
+#endif
+
+    uint64_t size() const { return size_; }
+
+    // Read exactly `length` bytes at `offset`; false on error or end of file
+    bool read_at(uint64_t offset, void* buffer, size_t length) const;
+
+private:
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    uint64_t size_ = 0;
+};
+
+// Flush a closed file's data to stable storage (fsync / FlushFileBuffers)
+bool sync_file(const std::filesystem::path& path);
+
+// Make a rename or file creation in `directory` durable. fsync on POSIX; a
+// no-op on Windows, where metadata updates are not synced separately.
+bool sync_directory(const std::filesystem::path& directory);
+
+// Evict a file's pages from the OS page cache so the next reads hit the
+// device (for benchmarks). Dirty pages are written back first. Uses
+// posix_fadvise(POSIX_FADV_DONTNEED); false where that is unavailable
+// (Windows, macOS) or the call fails.
+bool drop_file_cache(const std::filesystem::path& path);
+
+} // namespace Taffy
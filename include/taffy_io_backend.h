@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include "taffy_file.h"
+
+namespace Taffy {
+
+enum class ReadBackendKind : uint8_t {
+    Auto = 0,       // io_uring when the build and kernel support it, else pread
+    Pread = 1,      // One positional read per chunk on the calling thread
+    IoUring = 2,    // Whole batch submitted with one io_uring_enter (Linux)
+};
+
+const char* read_backend_name(ReadBackendKind kind);
+
+// One read of a batch; `ok` is set by the backend
+struct ReadRequest {
+    uint64_t offset = 0;
+    void* buffer = nullptr;
+    size_t length = 0;
+    bool ok = false;
+};
+
+// Batched positional reads. A backend instance is not thread-safe; give each
+// I/O worker its own. Backends are independent of any one file.
+class ReadBackend {
+public:
+    virtual ~ReadBackend() = default;
+
+    virtual ReadBackendKind kind() const = 0;
+
+    // Read every request fully; on return each request's `ok` reports success
+    virtual void read_batch(const PositionalFile& file, std::span<ReadRequest> requests) = 0;
+};
+
+// True if this build has io_uring support and the kernel allows creating a ring
+bool io_uring_available();
+
+// Create the preferred backend, falling back to pread if io_uring is not
+// compiled in or the kernel refuses it (old kernel, seccomp, memlock limit)
+std::unique_ptr<ReadBackend> create_read_backend(ReadBackendKind preferred, unsigned queue_depth = 64);
+
+} // namespace Taffy
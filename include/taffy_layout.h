@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "taffy.h"
+
+namespace Taffy {
+
+// Physical chunk layout.
+//
+// Payloads are written in residency order: MANF, BOOT and DEPS first, then
+// the rest of the Boot class, Resident, Streamed and finally Debug. Within a
+// class, chunks that share a non-zero `group` are kept next to each other
+// (at the position of the group's first chunk); everything else keeps its
+// directory order. A loader can then fetch a whole class with one
+// sequential read.
+
+// Class used when a chunk has none recorded (files written before the field
+// existed, or chunks nobody classified)
+ResidencyClass default_residency(ChunkType type);
+
+// Recorded class, falling back to default_residency()
+ResidencyClass chunk_residency(const ChunkDirectoryEntry& entry);
+
+const char* residency_class_name(ResidencyClass residency);
+
+// Directory indices in the order their payloads should be written
+std::vector<size_t> plan_chunk_layout(std::span<const ChunkDirectoryEntry> directory);
+
+// Byte range covering every chunk of one residency class
+struct ResidencySpan {
+    uint64_t offset = 0;
+    uint64_t size = 0;               // Bytes to read, including padding and interleaved chunks
+    uint64_t payload_bytes = 0;      // Sum of the member chunks' stored sizes
+    std::vector<uint32_t> chunks;    // Directory indices of the member chunks
+};
+ResidencySpan residency_span(std::span<const ChunkDirectoryEntry> directory, ResidencyClass residency);
+
+} // namespace Taffy
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include "taffy.h"
+
+namespace Taffy {
+
+// Read-only, memory-mapped view of a TAF file.
+//
+// The file is mapped once; the header and chunk directory are validated on
+// open and chunk payloads are handed out as spans pointing straight into the
+// mapping, so nothing is copied and mount cost is proportional to the
+// directory size rather than the asset size. Views stay valid until close()
+// or destruction. Use copy_to_asset() when the data needs to be mutated.
+class MappedAsset {
+public:
+    MappedAsset() = default;
+    ~MappedAsset();
+
+    // Move only, no copy
+    MappedAsset(MappedAsset&& other) noexcept;
+    MappedAsset& operator=(MappedAsset&& other) noexcept;
+    MappedAsset(const MappedAsset&) = delete;
+    MappedAsset& operator=(const MappedAsset&) = delete;
+
+    // Map a TAF file and validate its header and chunk directory
+    bool open(const std::filesystem::path& path);
+
+    // Unmap the file; all previously returned views become invalid
+    void close();
+
+    bool is_open() const { return base_ != nullptr; }
+
+    const AssetHeader& get_header() const { return header_; }
+    std::span<const ChunkDirectoryEntry> get_chunk_directory() const { return { directory_, chunk_count_ }; }
+    size_t get_chunk_count() const { return chunk_count_; }
+    uint64_t get_file_size() const { return size_; }
+
+    // Chunk lookup
+    bool has_chunk(ChunkType type) const;
+    bool has_chunk_named(const std::string& name) const;
+    std::optional<ChunkDirectoryEntry> get_chunk_entry(ChunkType type) const;
+    std::optional<ChunkDirectoryEntry> get_chunk_entry(const std::string& name) const;
+
+    // Zero-copy access to chunk payloads. Compressed chunks cannot be viewed
+    // in place (empty span / nullopt); decode them with read_chunk() instead.
+    std::span<const uint8_t> view_chunk(size_t index) const;
+    std::optional<std::span<const uint8_t>> view_chunk(ChunkType type) const;
+    std::optional<std::span<const uint8_t>> view_chunk(const std::string& name) const;
+    bool is_compressed(size_t index) const;
+
+    // Guaranteed alignment of a chunk's mapped payload pointer, and a view that
+    // is only returned when it is at least `alignment`-byte aligned (for
+    // handing straight to a staging buffer copy or aligned SIMD loads)
+    size_t chunk_alignment(size_t index) const;
+    std::optional<std::span<const uint8_t>> view_chunk_aligned(ChunkType type, size_t alignment) const;
+
+    // Copy (and decompress if needed) a chunk payload into `out`
+    bool read_chunk(size_t index, std::vector<uint8_t>& out) const;
+
+    // Checksum verification is opt-in so that open() never touches payload pages
+    bool verify_chunk(size_t index) const;
+    bool verify_checksums() const;
+
+    // Copy-based fallback: materialize an owning Asset for mutation
+    bool copy_to_asset(Asset& asset) const;
+
+private:
+    std::span<const uint8_t> stored_chunk(size_t index) const;
+    std::optional<size_t> find_chunk(ChunkType type) const;
+    std::optional<size_t> find_chunk(const std::string& name) const;
+    void release_mapping();
+
+    const uint8_t* base_ = nullptr;
+    uint64_t size_ = 0;
+    AssetHeader header_{};
+    const ChunkDirectoryEntry* directory_ = nullptr;
+    size_t chunk_count_ = 0;
+    ChunkIndex chunk_index_;
+
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+};
+
+} // namespace Taffy
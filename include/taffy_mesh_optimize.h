@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Taffy {
+
+// Offline triangle and vertex ordering for the traditional (indexed draw)
+// path. The passes run in this order before a GEOM chunk is written:
+//
+//   1. optimize_vertex_cache   Tipsify (Sander, Nehab, Barczak 2007): fan
+//                              around recently used vertices so the
+//                              post-transform cache hits
+//   2. optimize_overdraw       Split the result into clusters and draw the
+//                              outward-facing ones first, giving up at most
+//                              `threshold` of the ACMR
+//   3. vertex fetch remap      Vertices in order of first use, so the
+//                              pre-transform fetch walks memory forwards
+//
+// All functions expect indices already checked against vertex_count.
+
+// Cache size the passes and statistics model
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+// Post-transform cache behaviour of an index buffer under a FIFO cache
+struct VertexCacheStats {
+    size_t triangles = 0;
+    size_t transformed = 0;         // Cache misses
+    size_t unique_vertices = 0;     // Distinct vertices referenced
+    double acmr = 0.0;              // Transforms per triangle (3 worst, ~0.5 best)
+    double atvr = 0.0;              // Transforms per referenced vertex (1 best)
+};
+
+VertexCacheStats analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count,
+                                      uint32_t cache_size = VERTEX_CACHE_SIZE);
+
+void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count,
+                           uint32_t cache_size = VERTEX_CACHE_SIZE);
+
+// `indices` must come from optimize_vertex_cache. `positions` holds one xyz
+// triple every `stride` floats.
+void optimize_overdraw(std::span<uint32_t> indices, std::span<const float> positions, size_t stride = 3,
+                       float threshold = 1.05f, uint32_t cache_size = VERTEX_CACHE_SIZE);
+
+// New position of every vertex: referenced vertices in order of first use,
+// then the unreferenced ones in their original order
+std::vector<uint32_t> vertex_fetch_remap(std::span<const uint32_t> indices, size_t vertex_count);
+void remap_indices(std::span<uint32_t> indices, std::span<const uint32_t> remap);
+void remap_vertices(std::span<uint8_t> vertices, size_t stride, std::span<const uint32_t> remap);
+
+struct MeshOptimizeReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// Run every pass in place. `vertices` holds the vertex records
+// (`vertex_stride` bytes each) and `positions` their float positions, which
+// are only read. False, with nothing changed, if an index is out of range.
+bool optimize_mesh(std::span<uint32_t> indices, std::span<uint8_t> vertices, size_t vertex_stride,
+                   std::span<const float> positions, size_t position_stride, MeshOptimizeReport& report);
+
+} // namespace Taffy
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+#include "taffy.h"
+
+namespace Taffy {
+
+// Limits the generated mesh shaders are compiled for
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_PRIMITIVES = 126;
+
+// Meshlets of one triangle list, in GEOM meshlet block order
+struct MeshletSet {
+    std::vector<MeshletDesc> meshlets;
+    std::vector<uint32_t> vertex_indices;       // Mesh vertex of each meshlet vertex
+    std::vector<uint32_t> primitive_indices;    // Meshlet-local, 3 per primitive
+    std::vector<MeshletBounds> bounds;          // One per meshlet, or empty
+    bool packed_primitives = true;              // Serialize primitive indices as uint8_t
+
+    // GeometryChunk::ms_flags describing serialize()
+    uint32_t geometry_flags() const;
+
+    // Descriptors, vertex indices, primitive indices, then bounds if present
+    std::vector<uint8_t> serialize() const;
+};
+
+// Meshlet block of a GEOM chunk, read in place. Primitive indices are
+// uint32_t in files written before GeometryChunk::MeshletPackedPrimitives.
+struct MeshletBlockView {
+    std::span<const MeshletDesc> meshlets;
+    std::span<const uint32_t> vertex_indices;
+    const uint8_t* primitive_data = nullptr;
+    size_t primitive_index_count = 0;
+    bool packed_primitives = false;
+    std::span<const MeshletBounds> bounds;      // Empty without MeshletBoundsData
+
+    uint32_t primitive_index(size_t i) const {
+        if (packed_primitives) {
+            return primitive_data[i];
+        }
+        uint32_t index;
+        std::memcpy(&index, primitive_data + i * sizeof(uint32_t), sizeof(index));
+        return index;
+    }
+};
+
+// Bytes the primitive indices take in a block with `flags`
+size_t meshlet_primitive_bytes(size_t primitive_index_count, uint32_t flags);
+
+// Parse the meshlet block that follows the index data. `block` runs from
+// there to the end of the chunk. False if the block does not match `geometry`.
+bool read_meshlet_block(const GeometryChunk& geometry, std::span<const uint8_t> block, MeshletBlockView& view);
+
+// Quality of a MeshletSet against the limits it was built for
+struct MeshletStats {
+    size_t meshlets = 0;
+    size_t triangles = 0;
+    size_t meshlet_vertices = 0;        // Vertices the mesh shaders transform
+    size_t unique_vertices = 0;         // Distinct mesh vertices referenced
+    double vertex_fill = 0.0;           // Mean vertex_count / max_vertices
+    double primitive_fill = 0.0;        // Mean primitive_count / max_primitives
+    double cullable = 0.0;              // Fraction of meshlets with a usable normal cone
+
+    // Times each vertex is transformed (1.0 = no duplication across meshlets)
+    double vertex_overhead() const {
+        return unique_vertices ? double(meshlet_vertices) / double(unique_vertices) : 0.0;
+    }
+};
+
+// Splits a triangle list into meshlets for mesh shader rendering.
+//
+// The Locality strategy grows each meshlet across shared vertices: the next
+// triangle is the one adding the fewest new vertices, with ties broken by
+// distance to the meshlet's center and by how far its normal turns from the
+// meshlet's average facing. When a meshlet's frontier is used up it continues
+// with the nearest unassigned triangle in Morton order, so disconnected
+// pieces still fill meshlets. New meshlets start next to the previous one.
+// Sequential is the plain index-order split the compiler used before.
+class MeshletBuilder {
+public:
+    enum class Strategy : uint8_t {
+        Sequential,     // Close the meshlet at the first triangle that does not fit
+        Locality,
+    };
+
+    struct Options {
+        uint32_t max_vertices = MESHLET_MAX_VERTICES;       // At most 256
+        uint32_t max_primitives = MESHLET_MAX_PRIMITIVES;   // At most 256
+        Strategy strategy = Strategy::Locality;
+        float cone_weight = 0.25f;      // 0 = clusters by distance only, 1 = by facing only
+        bool compute_bounds = true;
+        bool packed_primitives = true;  // 8-bit primitive indices (needs max_vertices <= 256)
+    };
+
+    MeshletBuilder() = default;
+    explicit MeshletBuilder(const Options& options) : options_(options) {}
+
+    const Options& options() const { return options_; }
+
+    // `positions` holds one xyz triple every `stride` floats; bounds come out
+    // in the same units. Returns an empty set if the limits or indices are invalid.
+    MeshletSet build(std::span<const uint32_t> indices, std::span<const float> positions,
+                     size_t stride = 3) const;
+
+    MeshletStats measure(const MeshletSet& set) const;
+
+    // Bounding sphere and normal cone of one meshlet
+    static MeshletBounds compute_bounds(const MeshletSet& set, size_t meshlet,
+                                        std::span<const float> positions, size_t stride = 3);
+
+private:
+    void build_sequential(std::span<const uint32_t> indices, size_t vertex_count, MeshletSet& set) const;
+    void build_locality(std::span<const uint32_t> indices, std::span<const float> positions,
+                        size_t stride, size_t vertex_count, MeshletSet& set) const;
+
+    Options options_;
+};
+
+} // namespace Taffy
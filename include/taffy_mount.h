@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "taffy_streaming.h"
+
+namespace Taffy {
+
+enum class MountEvent : uint8_t {
+    Mounted,        // First handle for a path: the package was opened
+    Unmounted,      // Last handle released: the package is being closed
+};
+
+using MountListener = std::function<void(MountEvent event, const std::string& path,
+                                         const std::shared_ptr<StreamingTaffyLoader>& loader)>;
+
+// Process-wide registry of mounted packages.
+//
+// mount() deduplicates by canonical path: the first call opens the package
+// and later calls share its loader, so the header and directory are read
+// once and all users share one chunk cache. Concurrent first mounts of the
+// same path wait for a single open. Each handle holds one reference; the
+// package is unmounted when the last is released. Events are queued under
+// the registry lock as they happen and delivered one at a time in that
+// order, so a package's Mounted always reaches listeners before its
+// Unmounted. Listeners run outside the registry lock, on the thread that
+// caused the event or on one already delivering earlier events.
+class PackageMountManager {
+public:
+    static PackageMountManager& instance();
+
+    PackageMountManager() = default;
+    PackageMountManager(const PackageMountManager&) = delete;
+    PackageMountManager& operator=(const PackageMountManager&) = delete;
+
+    // Invalid handle if the package cannot be opened
+    StreamingTaffyHandle mount(const std::string& filepath);
+
+    bool isMounted(const std::string& filepath) const;
+    size_t getRefCount(const std::string& filepath) const;
+    std::vector<std::string> getMountedPaths() const;
+
+    // Returns an id for removeListener
+    size_t addListener(MountListener listener);
+    void removeListener(size_t id);
+
+    // Key used for deduplication
+    static std::string mountKey(const std::string& filepath);
+
+private:
+    friend class StreamingTaffyHandle;
+
+    struct Mount {
+        uint64_t id = 0;
+        size_t refs = 0;
+        std::shared_future<std::shared_ptr<StreamingTaffyLoader>> loader;  // nullptr if the open failed
+    };
+
+    struct PendingEvent {
+        MountEvent event;
+        std::string key;
+        std::shared_ptr<StreamingTaffyLoader> loader;
+    };
+
+    void release(const std::string& key, uint64_t mount_id);
+    // Delivers queued events unless another thread already is
+    void deliverEvents();
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Mount> mounts_;
+    uint64_t next_mount_id_ = 1;
+    std::vector<std::pair<size_t, MountListener>> listeners_;
+    size_t next_listener_id_ = 1;
+    std::deque<PendingEvent> events_;
+    bool delivering_ = false;
+};
+
+} // namespace Taffy
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "taffy_chunk_cache.h"
+
+namespace Taffy {
+
+// Lower value = served first
+enum class PrefetchPriority : uint8_t {
+    Immediate = 0,      // Needed this frame
+    High = 1,
+    Normal = 2,
+    Speculative = 3,    // Predicted future use
+};
+
+using ChunkFuture = std::shared_future<ChunkBufferPtr>;
+
+// Called once per request with the loaded chunk, or nullptr if the load
+// failed or the request was cancelled
+using PrefetchCallback = std::function<void(uint32_t index, const ChunkBufferPtr& chunk)>;
+
+// Background chunk loader with a priority queue.
+//
+// Requests for the same chunk are merged: a second request gets the same
+// future, and a more urgent priority moves the queued request ahead of
+// speculative work. Queued requests can be cancelled; requests that a worker
+// has already started always complete. Futures of cancelled requests resolve
+// to nullptr.
+//
+// With a batch load function a worker takes up to `max_batch` queued requests
+// of the same priority at once, so a backend such as io_uring can submit them
+// together.
+class ChunkPrefetcher {
+public:
+    using LoadFunction = std::function<ChunkBufferPtr(uint32_t index)>;
+    using BatchLoadFunction = std::function<void(std::span<const uint32_t> indices, std::span<ChunkBufferPtr> chunks)>;
+
+    // thread_count 0 picks a default based on hardware concurrency
+    explicit ChunkPrefetcher(LoadFunction load, unsigned thread_count = 0);
+    ChunkPrefetcher(BatchLoadFunction load, unsigned thread_count, size_t max_batch);
+    ~ChunkPrefetcher();
+
+    ChunkPrefetcher(const ChunkPrefetcher&) = delete;
+    ChunkPrefetcher& operator=(const ChunkPrefetcher&) = delete;
+
+    ChunkFuture request(uint32_t index, PrefetchPriority priority, PrefetchCallback callback = {});
+
+    // Cancel a queued request; false if it is unknown or already in flight
+    bool cancel(uint32_t index);
+
+    // Cancel everything queued and join the workers. Further requests
+    // resolve to nullptr immediately.
+    void stop();
+
+    size_t pending_count() const;
+    unsigned thread_count() const { return static_cast<unsigned>(workers_.size()); }
+
+private:
+    struct Request {
+        uint32_t index = 0;
+        PrefetchPriority priority = PrefetchPriority::Normal;
+        bool in_flight = false;
+        std::promise<ChunkBufferPtr> promise;
+        ChunkFuture future;
+        std::vector<PrefetchCallback> callbacks;
+    };
+
+    // Re-prioritizing pushes a new entry; the old one is skipped when popped
+    struct QueueEntry {
+        PrefetchPriority priority;
+        uint64_t sequence;
+        std::shared_ptr<Request> request;
+
+        bool operator<(const QueueEntry& other) const {
+            // std::priority_queue pops the largest; we want lowest priority value, then FIFO
+            if (priority != other.priority) {
+                return priority > other.priority;
+            }
+            return sequence > other.sequence;
+        }
+    };
+
+    void worker_loop();
+    static void complete(Request& request, const ChunkBufferPtr& chunk);
+
+    BatchLoadFunction load_;
+    size_t max_batch_ = 1;
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::priority_queue<QueueEntry> queue_;
+    std::unordered_map<uint32_t, std::shared_ptr<Request>> pending_;  // Queued or in flight
+    std::vector<std::thread> workers_;
+    uint64_t next_sequence_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace Taffy
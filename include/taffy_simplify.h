@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+#include "taffy.h"
+
+namespace Taffy {
+
+// Screen-space LOD selection. A GEOM chunk's GeometryLodInfo::geometric_error
+// is in meters; at distance d it covers error * projection_scale / d pixels,
+// with projection_scale = viewport_height / (2 tan(fov_y / 2)).
+// GeometryChunk::lod_distance is that switch distance for the reference
+// projection below, for runtimes that do not project themselves.
+constexpr float LOD_REFERENCE_PIXEL_ERROR = 1.0f;
+constexpr float LOD_REFERENCE_VIEWPORT_HEIGHT = 1080.0f;
+constexpr float LOD_REFERENCE_FOV_Y = 1.04719755f;     // 60 degrees
+
+// Pixels `geometric_error` meters cover at `distance` meters
+float lod_screen_error(float geometric_error, float distance,
+                       float viewport_height = LOD_REFERENCE_VIEWPORT_HEIGHT, float fov_y = LOD_REFERENCE_FOV_Y);
+
+// Nearest distance at which `geometric_error` covers at most `pixel_error` pixels
+float lod_switch_distance(float geometric_error, float pixel_error = LOD_REFERENCE_PIXEL_ERROR,
+                          float viewport_height = LOD_REFERENCE_VIEWPORT_HEIGHT, float fov_y = LOD_REFERENCE_FOV_Y);
+
+// Coarsest level within `pixel_error` at `distance`. `geometric_errors`
+// holds one entry per lod_level, ascending.
+uint32_t select_lod(std::span<const float> geometric_errors, float distance, float pixel_error,
+                    float viewport_height = LOD_REFERENCE_VIEWPORT_HEIGHT, float fov_y = LOD_REFERENCE_FOV_Y);
+
+// GeometryLodInfo of a whole GEOM chunk (header included). False without
+// GeometryChunk::LodErrorData.
+bool read_geometry_lod(const GeometryChunk& geometry, std::span<const uint8_t> chunk, GeometryLodInfo& info);
+
+// Quadric error metric (Garland and Heckbert 1997) edge collapse
+// simplification.
+//
+// Every collapse moves a vertex onto a neighbour, so output positions are
+// the input Vec3Q values and the vertex buffer can be reused. Quadrics are
+// built in double precision relative to the first vertex, so meshes far
+// from the origin simplify like meshes next to it. Vertices are welded by
+// position for topology: a vertex sharing its position with another vertex
+// (UV, normal or color seams) and vertices on open borders never move, which
+// keeps seams and silhouettes of open meshes intact. With texture
+// coordinates, collapses that flip a surviving triangle in UV space or
+// shrink its UV area to (almost) nothing are rejected as well.
+class MeshSimplifier {
+public:
+    // Indices must be checked against positions.size(). `uvs` is empty or
+    // holds a u, v pair per vertex.
+    MeshSimplifier(std::span<const uint32_t> indices, std::span<const Vec3Q> positions,
+                   std::span<const float> uvs = {});
+
+    // Collapse edges until at most `target_triangles` remain or the next
+    // collapse would exceed `max_error` meters. Calls continue from the
+    // previous result, and error() stays relative to the input mesh.
+    size_t simplify(size_t target_triangles, double max_error = std::numeric_limits<double>::infinity());
+
+    size_t triangle_count() const { return live_triangles_; }
+
+    // Largest collapse error so far, in meters (square root of the quadric error)
+    double error() const { return error_; }
+
+    std::vector<uint32_t> indices() const;
+
+private:
+    struct Quadric {
+        double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+        Quadric& operator+=(const Quadric& other);
+        double evaluate(const double p[3]) const;
+    };
+
+    struct Collapse {
+        double cost;
+        uint32_t from, to;
+        uint32_t from_version, to_version;
+        bool operator>(const Collapse& other) const { return cost > other.cost; }
+    };
+
+    double collapse_cost(uint32_t from, uint32_t to) const;
+    void push_collapse(uint32_t from, uint32_t to);
+    void push_neighbourhood(uint32_t vertex);
+    bool can_collapse(uint32_t from, uint32_t to) const;
+    void apply_collapse(uint32_t from, uint32_t to);
+    bool same_group(uint32_t a, uint32_t b) const { return group_[a] == group_[b]; }
+    double uv_area(uint32_t a, uint32_t b, uint32_t c) const;     // Twice the signed area
+
+    std::vector<uint32_t> triangles_;               // 3 per triangle, updated in place
+    std::vector<uint8_t> triangle_live_;
+    std::vector<std::vector<uint32_t>> vertex_triangles_;
+    std::vector<uint32_t> group_;                   // Welded position of each vertex
+    std::vector<std::vector<uint32_t>> group_vertices_;
+    std::vector<std::array<double, 3>> group_position_;     // Meters from the first vertex
+    std::vector<float> uvs_;                        // Empty, or u, v per vertex
+    std::vector<Quadric> group_quadric_;
+    std::vector<uint32_t> group_version_;           // Bumped when the quadric changes
+    std::vector<uint8_t> locked_;
+    std::vector<uint8_t> removed_;
+    std::vector<Collapse> heap_;
+    size_t live_triangles_ = 0;
+    double error_ = 0.0;
+};
+
+// One level of an LOD chain
+struct LodLevel {
+    uint32_t lod_level = 0;
+    std::vector<uint32_t> indices;      // Into the LOD 0 vertices
+    float geometric_error = 0.0f;       // Meters, relative to LOD 0
+    float lod_distance = 0.0f;          // lod_switch_distance() of geometric_error
+};
+
+struct LodChainOptions {
+    uint32_t max_levels = 4;            // Including LOD 0
+    float reduction = 0.5f;             // Triangle ratio each level aims for
+    float min_reduction = 0.85f;        // Stop once a level keeps more than this of the previous
+    size_t min_triangles = 32;          // Do not simplify below this
+    double max_error = std::numeric_limits<double>::infinity();    // Meters
+    float pixel_error = LOD_REFERENCE_PIXEL_ERROR;                  // For lod_distance
+};
+
+// LOD 0 (the input) followed by progressively simplified levels. `uvs` as
+// for MeshSimplifier.
+std::vector<LodLevel> build_lod_chain(std::span<const uint32_t> indices, std::span<const Vec3Q> positions,
+                                      const LodChainOptions& options = {}, std::span<const float> uvs = {});
+
+// Where build_geometry_lods finds positions and texture coordinates in a
+// vertex record. GEOM chunks do not describe their attributes, so the
+// caller has to.
+struct LodVertexLayout {
+    VertexAttribute::Type position_type = VertexAttribute::Vec3Q;  // Vec3Q, Position16 or Position32
+    uint32_t position_offset = 0;
+    VertexAttribute::Type uv_type = VertexAttribute::Float2;       // Float2 or Half2
+    int32_t uv_offset = -1;                                         // -1 = no texture coordinates
+};
+
+// Layout of the built-in meshes: the compact 24-byte record for
+// VertexFormat::Packed, else Vec3Q first. UVs are assumed for the compact
+// record and the 76-byte one (position, normal, color, uv, tangent) only.
+LodVertexLayout default_lod_vertex_layout(const GeometryChunk& geometry);
+
+// LOD stage for an existing GEOM chunk (header included). On success
+// `lods[0]` is the input with GeometryLodInfo appended and `lods[n]` holds
+// LOD n: only the vertices it uses, reordered for the vertex cache, with
+// meshlets rebuilt if the input had them and positions still relative to
+// the input's bounds. A single entry means the mesh could not be
+// simplified. False if the chunk is malformed, not a triangle LOD 0,
+// already carries GeometryChunk::LodErrorData, or declares Position32 over
+// bounds it cannot span.
+bool build_geometry_lods(std::span<const uint8_t> chunk, const LodVertexLayout& layout,
+                         const LodChainOptions& options, std::vector<std::vector<uint8_t>>& lods);
+
+} // namespace Taffy
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+#include "taffy.h"
+
+namespace Taffy {
+
+// Write a TAF file without holding chunk payloads in memory.
+//
+// open() reserves room for the header and a fixed number of directory
+// entries, chunk payloads are then appended straight to disk as the producer
+// emits them (the CRC32 is updated per write), and finalize() seeks back to
+// patch the header and directory. Memory use is bounded by whatever the
+// caller passes to write(), independent of chunk or file size.
+//
+// Directory slots that are reserved but never used stay as zero padding
+// between the directory and the first payload. Chunks are always stored
+// uncompressed (ChunkCodec::None).
+//
+//   AssetStreamWriter writer;
+//   writer.open("music.taf", 1);
+//   writer.begin_chunk(ChunkType::AUDI, "streaming_audio");
+//   while (...) writer.write(block.data(), block.size());
+//   writer.end_chunk();
+//   writer.finalize();
+class AssetStreamWriter {
+public:
+    AssetStreamWriter();
+    ~AssetStreamWriter();
+
+    AssetStreamWriter(const AssetStreamWriter&) = delete;
+    AssetStreamWriter& operator=(const AssetStreamWriter&) = delete;
+
+    // Header properties; may be changed any time before finalize()
+    void set_creator(const std::string& creator);
+    void set_description(const std::string& description);
+    void set_feature_flags(FeatureFlags flags);
+    AssetHeader& header() { return header_; }
+
+    // Pad every following chunk payload to `bytes` (power of two up to MAX_CHUNK_ALIGNMENT)
+    bool set_payload_alignment(uint32_t bytes);
+
+    // Append an INDX chunk (ChunkIndexTable) at finalize() so streaming
+    // loaders can open the file without reading its whole directory. Takes
+    // one of the reserved directory slots.
+    void set_chunk_index(bool enabled) { write_chunk_index_ = enabled; }
+
+    // Create the file and reserve space for up to `max_chunks` directory entries
+    bool open(const std::filesystem::path& path, uint32_t max_chunks);
+
+    // Stream one chunk: begin, any number of writes, end
+    bool begin_chunk(ChunkType type, const std::string& name, uint32_t flags = 0);
+    bool write(const void* data, size_t size);
+    bool write(std::span<const uint8_t> data) { return write(data.data(), data.size()); }
+    bool end_chunk();
+
+    // Convenience for payloads that are already in memory
+    bool add_chunk(ChunkType type, std::span<const uint8_t> data, const std::string& name, uint32_t flags = 0);
+
+    // Patch header and directory, then close the file. A writer that is
+    // destroyed without finalize() leaves an invalid (zero-magic) file behind.
+    bool finalize();
+
+    // Close and delete the file opened by open(). Use on error paths so a
+    // failed export leaves nothing behind; does nothing after a successful
+    // finalize().
+    void abort();
+
+    bool is_open() const { return file_.is_open(); }
+    bool in_chunk() const { return in_chunk_; }
+    size_t get_chunk_count() const { return directory_.size(); }
+    uint64_t get_bytes_written() const { return current_offset_; }
+
+private:
+    bool fail(const char* message);
+
+    std::ofstream file_;
+    std::filesystem::path path_;
+    AssetHeader header_{};
+    std::vector<ChunkDirectoryEntry> directory_;
+    uint32_t max_chunks_ = 0;
+    uint8_t alignment_log2_ = 0;
+    uint64_t current_offset_ = 0;
+    bool in_chunk_ = false;
+    bool failed_ = false;
+    bool unfinished_ = false;       // File created by open() and not yet finalized
+    bool write_chunk_index_ = false;
+};
+
+} // namespace Taffy
@@ -3,24 +3,35 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <future>
 #include <memory>
 #include <unordered_map>
 #include <mutex>
 #include <optional>
+#include <span>
 #include "taffy.h"
+#include "taffy_chunk_cache.h"
+#include "taffy_directory.h"
+#include "taffy_file.h"
+#include "taffy_io_backend.h"
+#include "taffy_prefetch.h"
+#include "taffy_telemetry.h"
 
 namespace Taffy {
 
-// Forward declaration
+// Forward declarations
 class StreamingTaffyLoader;
+class PackageMountManager;
 
-// Handle for streaming TAF files
+// Reference to a package mounted through PackageMountManager. Every handle
+// for the same path shares one loader (directory, index and cache); the
+// package is unmounted when the last handle goes away.
 class StreamingTaffyHandle {
 public:
     StreamingTaffyHandle() = default;
     ~StreamingTaffyHandle();
     
-    // Move only, no copy
+    // Move only, no copy; mount the path again for another reference
     StreamingTaffyHandle(StreamingTaffyHandle&& other) noexcept;
     StreamingTaffyHandle& operator=(StreamingTaffyHandle&& other) noexcept;
     StreamingTaffyHandle(const StreamingTaffyHandle&) = delete;
@@ -28,17 +39,28 @@ public:
     
     bool isValid() const { return loader_ != nullptr; }
     
+    StreamingTaffyLoader* get() const { return loader_.get(); }
+    StreamingTaffyLoader* operator->() const { return loader_.get(); }
+    StreamingTaffyLoader& operator*() const { return *loader_; }
+    const std::shared_ptr<StreamingTaffyLoader>& getLoader() const { return loader_; }
+    
+    // Mount key (canonical path) of the package
+    const std::string& getPath() const { return path_; }
+    
+    // Drop this reference now
+    void reset();
+    
 private:
-    friend class StreamingTaffyLoader;
+    friend class PackageMountManager;
     std::shared_ptr<StreamingTaffyLoader> loader_;
-    size_t handle_id_ = 0;
+    std::string path_;
+    uint64_t mount_id_ = 0;
 };
 
 // Partial TAF loader for streaming large assets
 class StreamingTaffyLoader : public std::enable_shared_from_this<StreamingTaffyLoader> {
-    friend class StreamingTaffyHandle;
 public:
-    StreamingTaffyLoader() = default;
+    StreamingTaffyLoader();
     ~StreamingTaffyLoader();
     
     // Open a TAF file for streaming
@@ -53,31 +75,52 @@ public:
     // Get asset header
     const AssetHeader& getHeader() const { return header_; }
     
-    // Get chunk directory
-    const std::vector<ChunkDirectoryEntry>& getDirectory() const { return directory_; }
+    // Get chunk directory; reads all of a lazy directory
+    std::span<const ChunkDirectoryEntry> getDirectory() const { return directory_.entries(); }
     
-    // Load a specific chunk by index
-    std::vector<uint8_t> loadChunk(uint32_t index);
+    // With an INDX chunk in the file, open() reads only the header, the
+    // index head and the Boot chunks; other directory entries are read in
+    // pages on first use. Applied at the next open(); on by default.
+    void setLazyDirectory(bool lazy) { lazy_directory_ = lazy; }
+    bool isDirectoryLazy() const { return directory_.is_lazy(); }
+    
+    // Load a specific chunk by index. Cache hits return the cached buffer
+    // without copying; the returned reference keeps the data alive after
+    // eviction. nullptr if the chunk is missing or unreadable.
+    ChunkBufferPtr loadChunk(uint32_t index);
 
     // Load a chunk by type
-    std::vector<uint8_t> loadChunk(ChunkType type);
+    ChunkBufferPtr loadChunk(ChunkType type);
     
     // Load a chunk by name
-    std::vector<uint8_t> loadChunk(const std::string& name);
+    ChunkBufferPtr loadChunk(const std::string& name);
     
     // Find chunk index by name
     int findChunkIndex(const std::string& name) const;
     int findChunkIndex(ChunkType type) const;
     
-    // Get chunk info without loading data
+    // Get chunk info without loading data (nullptr if missing or unreadable)
     const ChunkDirectoryEntry* getChunkInfo(const std::string& name) const;
     const ChunkDirectoryEntry* getChunkInfo(uint32_t index) const;
     
     // Load only the metadata chunk (first AUDI chunk)
-    std::vector<uint8_t> loadMetadata();
+    ChunkBufferPtr loadMetadata();
     
     // Load audio chunk by sequential index (for streaming audio)
-    std::vector<uint8_t> loadAudioChunk(uint32_t chunkIndex);
+    ChunkBufferPtr loadAudioChunk(uint32_t chunkIndex);
+
+    // Read `length` bytes at `offset` within a chunk's payload without
+    // loading the whole chunk. Served from the cache if the chunk is cached;
+    // otherwise one positional read that bypasses the cache. Compressed
+    // chunks can only be decoded whole, so they are loaded (and cached) first.
+    bool readRange(uint32_t index, uint64_t offset, void* buffer, size_t length);
+    
+    // Logical (decoded) payload size of a chunk
+    uint64_t getChunkDataSize(uint32_t index) const;
+    
+    // Read the StreamingAudio entry of an AUDI chunk from its header only.
+    // `streamIndex` selects among AudioChunk::streaming_count entries.
+    std::optional<AudioChunk::StreamingAudio> loadStreamingAudioInfo(uint32_t index, uint32_t streamIndex = 0);
 
     // Convenience accessors for package-level metadata
     std::optional<ManifestChunk> loadManifest();
@@ -87,19 +130,75 @@ public:
     // Get total number of chunks
     uint32_t getChunkCount() const { return header_.chunk_count; }
     
-    // Create a handle for external reference counting
+    // Mount through PackageMountManager::instance(); repeated calls for the
+    // same file share one loader
     static StreamingTaffyHandle createHandle(const std::string& filepath);
     
-    // Preload specific chunks into cache
+    // Queue chunks for background loading into the cache. Returns one future
+    // per index (nullptr result on failure or cancellation); the callback, if
+    // any, runs on an I/O worker, or immediately for chunks already cached.
+    // Re-requesting a queued chunk with a more urgent priority moves it ahead.
+    std::vector<ChunkFuture> prefetch(const std::vector<uint32_t>& indices,
+                                      PrefetchPriority priority = PrefetchPriority::Normal,
+                                      PrefetchCallback callback = {});
+
+    // Single-chunk form; defaults to "needed this frame"
+    ChunkFuture requestChunk(uint32_t index, PrefetchPriority priority = PrefetchPriority::Immediate);
+
+    // Cancel queued prefetches; returns how many were still waiting
+    size_t cancelPrefetch(const std::vector<uint32_t>& indices);
+
+    // Cancel queued prefetches and drop the chunks from the cache
+    void evict(const std::vector<uint32_t>& indices);
+
+    // I/O worker count, applied when the worker pool next starts (0 = default)
+    void setPrefetchThreads(unsigned threads) { prefetch_threads_ = threads; }
+
+    // Prefetch I/O backend, applied when the worker pool next starts. With
+    // io_uring each worker submits up to PREFETCH_BATCH queued reads in one
+    // syscall; otherwise (or if the kernel refuses io_uring) every worker
+    // issues its own pread.
+    void setReadBackend(ReadBackendKind kind) { read_backend_ = kind; }
+    ReadBackendKind getActiveReadBackend() const { return active_backend_; }
+    static constexpr size_t PREFETCH_BATCH = 64;
+
+    // Preload specific chunks into cache in the background (speculative priority)
     void preloadChunks(const std::vector<uint32_t>& indices);
 
-    // Ensure a chunk is cached, then return a stable pointer to cached data.
+    // Cache every chunk of a residency class with one sequential read of its
+    // byte range (open() does this for ResidencyClass::Boot). Returns false if
+    // the class is too scattered or too large for a single read.
+    bool preloadResidency(ResidencyClass residency);
+
+    // Ensure a chunk is cached; getCachedChunkData returns a shared reference
+    // (nullptr if not cached) that stays valid even if the chunk is evicted.
     bool ensureChunkCached(uint32_t index);
-    const std::vector<uint8_t>* getCachedChunkData(uint32_t index) const;
+    ChunkBufferPtr getCachedChunkData(uint32_t index) const;
     
     // Clear chunk cache
     void clearCache();
     
+    // Cache limits and policy. Every loader also counts against a memory
+    // pool, by default CacheMemoryPool::global() (DEFAULT_BUDGET shared by
+    // all loaders); size that once per process, e.g. small on dedicated
+    // servers and large on clients. Apply before loading from several threads.
+    struct CacheConfig {
+        uint64_t budget_bytes = ChunkCache::UNLIMITED;      // This loader alone
+        EvictionPolicy policy = EvictionPolicy::Clock;
+        std::vector<std::pair<ChunkType, uint64_t>> type_quotas;
+        bool pin_boot = true;           // Never evict ResidencyClass::Boot chunks
+        bool pin_resident = false;      // Never evict ResidencyClass::Resident chunks
+        std::shared_ptr<CacheMemoryPool> memory_pool = CacheMemoryPool::global();  // nullptr = none
+    };
+    void configureCache(const CacheConfig& config);
+    const CacheConfig& getCacheConfig() const { return cache_config_; }
+    
+    // Byte budget of this loader's cache alone
+    void setCacheBudget(uint64_t bytes);
+    
+    // Keep a chunk in the cache regardless of budget and policy
+    void pinChunk(uint32_t index, bool pinned = true) { cache_.set_pinned(index, pinned); }
+    
     // Get cache statistics
     struct CacheStats {
         size_t total_chunks_loaded;
@@ -109,40 +208,144 @@ public:
     };
     CacheStats getCacheStats() const;
     
+    // Read telemetry: latency histograms per ChunkType (and per chunk at
+    // TelemetryLevel::PerChunk), bytes read, decode time, cache hit ratio,
+    // evictions and prefetch queue depth. Summary level by default; set the
+    // level before loading from several threads. Counters restart at open().
+    void setTelemetryLevel(TelemetryLevel level) { telemetry_.set_level(level); }
+    TelemetrySnapshot getTelemetry() const;
+    void resetTelemetry();
+    std::string exportTelemetryJson() const { return telemetry_to_json(getTelemetry()); }
+    std::string exportTelemetryPrometheus(const std::string& prefix = "taffy_streaming") const {
+        return telemetry_to_prometheus(getTelemetry(), prefix);
+    }
+    
 private:
     std::string filepath_;
-    mutable std::ifstream file_;
-    mutable std::mutex file_mutex_;
+    PositionalFile file_;           // Thread-safe positional reads, no seek state
+    mutable std::mutex file_mutex_; // Serializes open/close only
     AssetHeader header_;
-    std::vector<ChunkDirectoryEntry> directory_;
+    ChunkDirectory directory_;
+    bool lazy_directory_ = true;
     
-    // Simple cache for recently loaded chunks
-    struct CachedChunk {
+    // Sharded cache of recently loaded chunks
+    mutable ChunkCache cache_;
+    CacheConfig cache_config_;
+    mutable StreamingTelemetry telemetry_;
+
+    // Background I/O workers, started on first prefetch
+    std::shared_ptr<ChunkPrefetcher> prefetcher_;
+    mutable std::mutex prefetcher_mutex_;
+    unsigned prefetch_threads_ = 0;
+    ReadBackendKind read_backend_ = ReadBackendKind::Auto;
+    ReadBackendKind active_backend_ = ReadBackendKind::Pread;
+    std::vector<std::unique_ptr<ReadBackend>> idle_backends_;  // One per busy worker, reused
+    std::mutex backend_mutex_;
+    
+    // Internal chunk loading
+    std::optional<std::vector<uint8_t>> loadChunkInternal(uint32_t index) const;
+    std::optional<std::vector<uint8_t>> decodeChunkInternal(uint32_t index, std::vector<uint8_t> stored) const;
+    void loadChunkBatch(std::span<const uint32_t> indices, std::span<ChunkBufferPtr> chunks);
+    bool readResidencySpan(ResidencyClass residency);
+    void applyChunkPinning();
+    void applyChunkPinning(uint32_t index, const ChunkDirectoryEntry& entry);
+    std::shared_ptr<ChunkPrefetcher> getPrefetcher();
+    void stopPrefetcher();
+};
+
+// Sequential reader over a byte range of one chunk, in constant memory.
+//
+// Keeps two windows of `windowBytes`: the one being consumed and the next,
+// which is read on a background task as soon as the current one is entered,
+// so steady sequential reads (e.g. a music track) rarely wait on the disk.
+// Seeking outside both windows costs one synchronous read. The loader must
+// outlive the reader.
+class ChunkRangeReader {
+public:
+    static constexpr size_t DEFAULT_WINDOW = 256 * 1024;
+    
+    // Range [begin, begin + length) of the chunk, clamped to its size
+    ChunkRangeReader(StreamingTaffyLoader& loader, uint32_t chunkIndex,
+                     uint64_t begin = 0, uint64_t length = UINT64_MAX,
+                     size_t windowBytes = DEFAULT_WINDOW);
+    ~ChunkRangeReader();
+    
+    ChunkRangeReader(const ChunkRangeReader&) = delete;
+    ChunkRangeReader& operator=(const ChunkRangeReader&) = delete;
+    
+    bool isValid() const { return valid_; }
+    
+    // Copy up to `length` bytes; returns the count read (0 at the end or on error)
+    size_t read(void* buffer, size_t length);
+    
+    // Position relative to the start of the range
+    bool seek(uint64_t position);
+    uint64_t tell() const { return position_; }
+    uint64_t size() const { return length_; }
+    bool eof() const { return position_ >= length_; }
+    
+private:
+    struct Window {
         std::vector<uint8_t> data;
-        size_t access_count = 0;
+        uint64_t start = 0;     // Relative to the range
+        size_t size = 0;
+        
+        bool contains(uint64_t position) const { return position >= start && position < start + size; }
     };
-    mutable std::unordered_map<uint32_t, CachedChunk> chunk_cache_;
-    mutable std::mutex cache_mutex_;
-    mutable size_t cache_hits_ = 0;
-    mutable size_t cache_misses_ = 0;
     
-    // Handle management
-    static std::mutex handle_mutex_;
-    static size_t next_handle_id_;
-    static std::unordered_map<size_t, std::weak_ptr<StreamingTaffyLoader>> active_handles_;
+    bool fillWindow(Window& window, uint64_t start);
+    bool enterWindow(uint64_t position);
+    void waitReadAhead();
     
-    // Internal chunk loading
-    std::vector<uint8_t> loadChunkInternal(uint32_t index) const;
+    StreamingTaffyLoader& loader_;
+    uint32_t chunk_index_;
+    uint64_t begin_ = 0;
+    uint64_t length_ = 0;
+    size_t window_bytes_;
+    uint64_t position_ = 0;
+    bool valid_ = false;
+    
+    Window current_;
+    Window ahead_;
+    std::future<bool> ahead_ready_;
+    bool ahead_ok_ = false;
 };
 
 // Helper class for creating chunked streaming TAF files
+// Append-only, crash-safe TAF writer for content larger than RAM.
+//
+// Payloads go straight to "<filepath>.partial" as they are added (the CRC32
+// is computed incrementally), and finalize() patches the header and
+// directory, syncs the temp file to disk and atomically renames it over
+// `filepath`. A crash, abort() or destroying the writer without finalize()
+// therefore never leaves a truncated asset at `filepath`.
+// Directory space for `reserve_chunks` entries is set aside at begin(); if
+// more chunks are added, finalize() relocates the payloads once in bounded
+// memory.
 class ChunkedTaffyWriter {
 public:
     ChunkedTaffyWriter();
     ~ChunkedTaffyWriter();
     
     // Start writing a new chunked TAF
-    bool begin(const std::string& filepath);
+    bool begin(const std::string& filepath, uint32_t reserve_chunks = 64);
+    
+    // Header properties; may be changed any time before finalize()
+    void setCreator(const std::string& creator);
+    void setDescription(const std::string& description);
+    void setFeatureFlags(FeatureFlags flags);
+    
+    // Append an INDX chunk at finalize() so StreamingTaffyLoader can open the
+    // file without reading its whole directory
+    void setChunkIndex(bool enabled) { write_chunk_index_ = enabled; }
+    
+    // Add a complete chunk of any type
+    bool addChunk(ChunkType type, std::span<const uint8_t> data, const std::string& name, uint32_t flags = 0);
+    
+    // Stream a single chunk in pieces: beginChunk, any number of writeChunkData, endChunk
+    bool beginChunk(ChunkType type, const std::string& name, uint32_t flags = 0);
+    bool writeChunkData(const void* data, size_t size);
+    bool endChunk();
     
     // Add metadata chunk (should be first)
     bool addMetadataChunk(const std::vector<uint8_t>& data, const std::string& name = "audio_metadata");
@@ -150,22 +353,31 @@ public:
     // Add audio data chunk
     bool addAudioChunk(const std::vector<uint8_t>& data, uint32_t chunkIndex);
     
-    // Finalize and close the file
+    // Write header and directory, then move the file into place
     bool finalize();
     
+    // Discard everything written so far
+    void abort();
+    
     // Get current chunk count
-    uint32_t getChunkCount() const { return chunk_count_; }
+    uint32_t getChunkCount() const { return static_cast<uint32_t>(directory_.size()); }
     
 private:
     std::ofstream file_;
     std::string filepath_;
+    std::string temp_path_;
+    AssetHeader header_{};
     std::vector<ChunkDirectoryEntry> directory_;
-    uint32_t chunk_count_ = 0;
-    size_t current_offset_ = 0;
-    bool header_written_ = false;
+    uint32_t reserved_chunks_ = 0;
+    uint64_t current_offset_ = 0;
+    bool in_chunk_ = false;
+    bool failed_ = false;
+    bool write_chunk_index_ = false;
+    
+    bool fail(const std::string& message);
     
-    // Write header and directory
-    bool writeHeaderAndDirectory();
+    // Rewrite the temp file with a larger directory when the reservation overflowed
+    bool relocatePayloads();
 };
 
 } // namespace Taffy
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "taffy.h"
+
+namespace Taffy {
+
+// Lock-free latency histogram with power-of-two microsecond buckets:
+// bucket 0 counts samples under 1 us, bucket b samples in [2^(b-1), 2^b) us,
+// and the last bucket everything slower.
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 24;       // Last finite bound 2^22 us (~4.2 s)
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> counts{};
+        uint64_t count = 0;
+        uint64_t sum_ns = 0;
+        uint64_t max_ns = 0;
+
+        double mean_us() const { return count ? sum_ns / 1000.0 / count : 0.0; }
+
+        // Upper bound (us) of the bucket holding the q-quantile
+        double quantile_us(double q) const;
+
+        void merge(const Snapshot& other);
+    };
+
+    void record(uint64_t nanoseconds);
+    void reset();
+    Snapshot snapshot() const;
+
+    // Upper bound of `bucket` in microseconds (infinity for the last)
+    static double bucket_bound_us(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    std::atomic<uint64_t> sum_ns_{ 0 };
+    std::atomic<uint64_t> max_ns_{ 0 };
+};
+
+enum class TelemetryLevel : uint8_t {
+    Off = 0,            // Nothing recorded, the clock is never read
+    Summary = 1,        // Totals and per-ChunkType histograms
+    PerChunk = 2,       // Also one histogram per chunk (~220 bytes each)
+};
+
+const char* telemetry_level_name(TelemetryLevel level);
+
+// Point-in-time copy of a loader's counters, ready for export
+struct TelemetrySnapshot {
+    struct TypeStats {
+        ChunkType type{};
+        uint64_t bytes = 0;
+        LatencyHistogram::Snapshot latency;
+    };
+    struct ChunkStats {
+        uint32_t index = 0;
+        std::string name;
+        uint64_t bytes = 0;
+        LatencyHistogram::Snapshot latency;
+    };
+
+    TelemetryLevel level = TelemetryLevel::Off;
+    double elapsed_seconds = 0.0;       // Since the last reset
+
+    // Disk reads (stored bytes) and decompression (decoded bytes)
+    uint64_t reads = 0;
+    uint64_t bytes_read = 0;
+    uint64_t bytes_decoded = 0;
+    double read_bytes_per_second = 0.0;
+    LatencyHistogram::Snapshot read_latency;
+    LatencyHistogram::Snapshot decode_latency;
+    std::vector<TypeStats> types;
+    std::vector<ChunkStats> chunks;     // PerChunk level, chunks that were read
+
+    // Cache
+    uint64_t cache_hits = 0;
+    uint64_t cache_misses = 0;
+    uint64_t cache_evictions = 0;
+    uint64_t cache_evicted_bytes = 0;
+    uint64_t cache_bytes = 0;
+    uint64_t cache_entries = 0;
+
+    // Prefetch queue
+    uint64_t queue_depth = 0;
+    uint64_t max_queue_depth = 0;
+
+    double hit_ratio() const {
+        const uint64_t lookups = cache_hits + cache_misses;
+        return lookups ? double(cache_hits) / double(lookups) : 0.0;
+    }
+};
+
+std::string telemetry_to_json(const TelemetrySnapshot& snapshot);
+
+// Prometheus text exposition format; latencies are exported in seconds
+std::string telemetry_to_prometheus(const TelemetrySnapshot& snapshot,
+                                    const std::string& prefix = "taffy_streaming");
+
+// Read counters of one loader. Recording is a handful of relaxed atomic
+// adds; per-type entries are found by a lock-free scan and only adding a
+// new type takes a lock. The caller fills in cache and queue fields.
+class StreamingTelemetry {
+public:
+    static constexpr size_t MAX_TRACKED_TYPES = 32;
+
+    StreamingTelemetry();
+
+    // Not safe while other threads record; PerChunk allocates the per-chunk table
+    void set_level(TelemetryLevel level);
+    TelemetryLevel level() const { return level_.load(std::memory_order_relaxed); }
+    bool enabled() const { return level() != TelemetryLevel::Off; }
+
+    // Clear every counter. Safe while recording unless `chunk_count` differs
+    // from the last call and the per-chunk table has to be reallocated.
+    void reset(size_t chunk_count);
+
+    // Start of a timed operation; 0 when telemetry is off
+    uint64_t begin() const;
+
+    // One read of `bytes` stored bytes that started at `begin_ns` (from begin())
+    void record_read(uint32_t index, ChunkType type, uint64_t bytes, uint64_t begin_ns);
+    void record_decode(uint64_t bytes, uint64_t begin_ns);
+    void record_queue_depth(size_t depth);
+
+    // Counters only; cache, queue depth and chunk names are left to the caller
+    TelemetrySnapshot snapshot() const;
+
+private:
+    struct TypeSlot {
+        std::atomic<uint32_t> type{ 0 };
+        std::atomic<uint64_t> bytes{ 0 };
+        LatencyHistogram latency;
+    };
+    struct ChunkSlot {
+        std::atomic<uint64_t> bytes{ 0 };
+        LatencyHistogram latency;
+    };
+
+    static uint64_t now_ns();
+    TypeSlot* type_slot(ChunkType type);
+
+    std::atomic<TelemetryLevel> level_{ TelemetryLevel::Summary };
+    std::atomic<uint64_t> started_ns_;
+    std::atomic<uint64_t> reads_{ 0 };
+    std::atomic<uint64_t> bytes_read_{ 0 };
+    std::atomic<uint64_t> bytes_decoded_{ 0 };
+    std::atomic<uint64_t> max_queue_depth_{ 0 };
+    LatencyHistogram read_latency_;
+    LatencyHistogram decode_latency_;
+
+    std::array<TypeSlot, MAX_TRACKED_TYPES> types_;
+    std::atomic<size_t> type_count_{ 0 };
+    std::mutex type_mutex_;                     // Serializes adding type slots
+
+    std::unique_ptr<ChunkSlot[]> chunks_;
+    size_t chunk_count_ = 0;
+};
+
+} // namespace Taffy
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "taffy.h"
+
+namespace Taffy {
+
+// Encoders for the packed VertexAttribute types. The decoders mirror what
+// MeshShaderGenerator emits, so tools can check what the GPU will see.
+
+// Bytes an attribute of `type` occupies in a vertex (0 if unknown)
+uint32_t vertex_attribute_size(VertexAttribute::Type type);
+
+// OctNormal: unit vector folded onto an octahedron, 2 x snorm16
+uint32_t encode_octahedral(float x, float y, float z);
+void decode_octahedral(uint32_t packed, float out[3]);
+
+// OctTangent: octahedral snorm16 + snorm15, sign of `w` in bit 31
+uint32_t encode_octahedral_tangent(float x, float y, float z, float w);
+void decode_octahedral_tangent(uint32_t packed, float out[4]);
+
+// Unorm8x4: RGBA, red in the low byte
+uint32_t pack_unorm8x4(float r, float g, float b, float a);
+
+// Half2: IEEE binary16, round to nearest even; u in the low half
+uint16_t float_to_half(float value);
+float half_to_float(uint16_t value);
+uint32_t pack_half2(float u, float v);
+
+// Position16 / Position32 relative to a GEOM chunk's bounds_min. Positions
+// outside the bounds are clamped.
+class PositionQuantizer {
+public:
+    PositionQuantizer(const Vec3Q& bounds_min, const Vec3Q& bounds_max);
+
+    // Position32 holds at most UINT32_MAX Vec3Q units per axis (about 33.5 km);
+    // false when the bounds are larger, in which case encode32 writes nothing
+    bool fits32() const { return fits32_; }
+
+    void encode16(const Vec3Q& position, uint8_t out[8]) const;
+    bool encode32(const Vec3Q& position, uint8_t out[12]) const;
+
+    // Meters, as the generated shaders compute them
+    void decode16(const uint8_t in[8], double out[3]) const;
+    void decode32(const uint8_t in[12], double out[3]) const;
+
+    // Origin in meters and the Position16 step per axis in meters
+    double origin_meters(int axis) const;
+    double step16_meters(int axis) const { return step16_[axis] / VEC3Q_UNITS_PER_METER; }
+
+    static constexpr double VEC3Q_UNITS_PER_METER = 128000.0;
+
+private:
+    int64_t offset(const Vec3Q& position, int axis) const;
+
+    Vec3Q origin_;
+    int64_t extent_[3];     // Vec3Q units
+    double step16_[3];      // Vec3Q units per Position16 step
+    bool fits32_;
+};
+
+} // namespace Taffy
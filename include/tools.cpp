@@ -1,7 +1,12 @@
 ﻿#include "tools.h"
 #include "quan.h"
 #include "asset.h"
+#include "taffy_meshlet.h"
+#include "taffy_mesh_optimize.h"
+#include "taffy_vertex_format.h"
+#include "taffy_simplify.h"
 
+#include <algorithm>
 #include <iomanip>
 
 #include <iostream>
@@ -373,7 +378,7 @@ bool validateOverlayCompatibility(const std::string& overlay_path, const std::st
 
         std::cout << "🔍 Validating hash-based shader chunk..." << std::endl;
 
-        auto shader_data = asset.get_chunk_data(ChunkType::SHDR);
+        auto shader_data = asset.view_chunk(ChunkType::SHDR);
         if (!shader_data) {
             std::cout << "❌ No shader chunk found in asset" << std::endl;
             return false;
@@ -838,6 +843,9 @@ void main() {
                 uint32_t index_count = 0;
                 bool prefersCompactVertexOutput = true;  // Output vertex data directly instead of reading from buffer
                 bool supportsOverlays = true;  // Enable overlay system support
+                uint32_t meshlet_flags = 0;    // GeometryChunk::ms_flags of the geometry drawn
+                Vec3Q bounds_min;              // GeometryChunk bounds, the origin of packed positions
+                Vec3Q bounds_max;
             };
 
             static std::string generateMeshShader(const ShaderConfig& config) {
@@ -950,8 +958,15 @@ void main() {
                 shader << "}\n\n";
 
                 shader << "uint readMeshletPrimitiveIndex(uint indexNum) {\n";
-                shader << "    uint byte_offset = pc.meshlet_primitive_index_offset_bytes + indexNum * 4u;\n";
-                shader << "    return vertexBuffer.vertices[byte_offset / 4u];\n";
+                if (config.meshlet_flags & GeometryChunk::MeshletPackedPrimitives) {
+                    // One byte per index, four to a word
+                    shader << "    uint byte_offset = pc.meshlet_primitive_index_offset_bytes + indexNum;\n";
+                    shader << "    uint word = vertexBuffer.vertices[byte_offset / 4u];\n";
+                    shader << "    return (word >> ((byte_offset & 3u) * 8u)) & 0xFFu;\n";
+                } else {
+                    shader << "    uint byte_offset = pc.meshlet_primitive_index_offset_bytes + indexNum * 4u;\n";
+                    shader << "    return vertexBuffer.vertices[byte_offset / 4u];\n";
+                }
                 shader << "}\n\n";
 
                 // Other attribute accessors
@@ -1289,9 +1304,34 @@ void main() {
                 shader << "\n";
             }
 
+            // Double literal with full precision for constants baked into shaders
+            static std::string glslDouble(double value) {
+                std::ostringstream literal;
+                literal << std::setprecision(17) << std::showpoint << value << "LF";
+                return literal.str();
+            }
+
             static void generateAttributeAccessors(std::stringstream& shader, const ShaderConfig& config) {
                 shader << "// Attribute accessor functions\n";
 
+                const bool octahedral = std::any_of(config.attributes.begin(), config.attributes.end(), [](const VertexAttribute& attr) {
+                    return attr.type == VertexAttribute::OctNormal || attr.type == VertexAttribute::OctTangent;
+                });
+                if (octahedral) {
+                    shader << "vec3 decodeOctahedral(vec2 e) {\n";
+                    shader << "    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n";
+                    shader << "    float t = max(-n.z, 0.0);\n";
+                    shader << "    n.x += n.x >= 0.0 ? -t : t;\n";
+                    shader << "    n.y += n.y >= 0.0 ? -t : t;\n";
+                    shader << "    return normalize(n);\n";
+                    shader << "}\n\n";
+                }
+
+                // Packed positions decode against the chunk bounds, as PositionQuantizer does
+                const PositionQuantizer quantizer(config.bounds_min, config.bounds_max);
+                const std::string origin = "dvec3(" + glslDouble(quantizer.origin_meters(0)) + ", " +
+                    glslDouble(quantizer.origin_meters(1)) + ", " + glslDouble(quantizer.origin_meters(2)) + ")";
+
                 for (const auto& attr : config.attributes) {
                     // Skip Vec3Q as it has its own special function
                     if (attr.type == VertexAttribute::Vec3Q) continue;
@@ -1333,6 +1373,46 @@ void main() {
                         shader << "    );\n";
                         break;
 
+                    case VertexAttribute::Position16:
+                        shader << "    uint w0 = vertexBuffer.vertices[offset];\n";
+                        shader << "    uint w1 = vertexBuffer.vertices[offset + 1u];\n";
+                        shader << "    dvec3 steps = dvec3(w0 & 0xFFFFu, w0 >> 16, w1 & 0xFFFFu);\n";
+                        shader << "    return vec3(" << origin << " + steps * dvec3("
+                            << glslDouble(quantizer.step16_meters(0)) << ", "
+                            << glslDouble(quantizer.step16_meters(1)) << ", "
+                            << glslDouble(quantizer.step16_meters(2)) << "));\n";
+                        break;
+
+                    case VertexAttribute::Position32:
+                        if (!quantizer.fits32()) {
+                            std::cerr << "⚠️ Position32 attribute '" << attr.name
+                                      << "' cannot span these bounds (over 2^32 Vec3Q units per axis)" << std::endl;
+                        }
+                        shader << "    dvec3 units = dvec3(uvec3(\n";
+                        shader << "        vertexBuffer.vertices[offset],\n";
+                        shader << "        vertexBuffer.vertices[offset + 1u],\n";
+                        shader << "        vertexBuffer.vertices[offset + 2u]));\n";
+                        shader << "    return vec3(" << origin << " + units / 128000.0LF);\n";
+                        break;
+
+                    case VertexAttribute::OctNormal:
+                        shader << "    return decodeOctahedral(unpackSnorm2x16(vertexBuffer.vertices[offset]));\n";
+                        break;
+
+                    case VertexAttribute::OctTangent:
+                        shader << "    uint w = vertexBuffer.vertices[offset];\n";
+                        shader << "    vec2 e = vec2(unpackSnorm2x16(w).x, max(float(bitfieldExtract(int(w), 16, 15)) / 16383.0, -1.0));\n";
+                        shader << "    return vec4(decodeOctahedral(e), (w & 0x80000000u) != 0u ? -1.0 : 1.0);\n";
+                        break;
+
+                    case VertexAttribute::Unorm8x4:
+                        shader << "    return unpackUnorm4x8(vertexBuffer.vertices[offset]);\n";
+                        break;
+
+                    case VertexAttribute::Half2:
+                        shader << "    return unpackHalf2x16(vertexBuffer.vertices[offset]);\n";
+                        break;
+
                     default:
                         shader << "    return " << getGLSLDefaultValue(attr.type) << ";\n";
                         break;
@@ -1407,6 +1487,12 @@ void main() {
                 case VertexAttribute::Float3: return "vec3";
                 case VertexAttribute::Float4: return "vec4";
                 case VertexAttribute::Vec3Q: return "vec3"; // Output type after conversion
+                case VertexAttribute::Position16:
+                case VertexAttribute::Position32:
+                case VertexAttribute::OctNormal: return "vec3";
+                case VertexAttribute::OctTangent:
+                case VertexAttribute::Unorm8x4: return "vec4";
+                case VertexAttribute::Half2: return "vec2";
                 default: return "float";
                 }
             }
@@ -1418,6 +1504,12 @@ void main() {
                 case VertexAttribute::Float3: return "vec3(0.0)";
                 case VertexAttribute::Float4: return "vec4(0.0, 0.0, 0.0, 1.0)";
                 case VertexAttribute::Vec3Q: return "vec3(0.0)";
+                case VertexAttribute::Position16:
+                case VertexAttribute::Position32:
+                case VertexAttribute::OctNormal: return "vec3(0.0)";
+                case VertexAttribute::OctTangent:
+                case VertexAttribute::Unorm8x4: return "vec4(0.0, 0.0, 0.0, 1.0)";
+                case VertexAttribute::Half2: return "vec2(0.0)";
                 default: return "0.0";
                 }
             }
@@ -1427,6 +1519,60 @@ void main() {
         // DATA-DRIVEN ASSET COMPILER
         // =============================================================================
 
+        // Reorder triangles for the post-transform cache and overdraw, then
+        // vertices for fetch locality, before the mesh is packed into GEOM
+        template <typename Vertex>
+        static void optimizeMeshOrder(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+            std::vector<float> positions;
+            positions.reserve(vertices.size() * 3);
+            for (const auto& vert : vertices) {
+                const glm::vec3 p = vert.position.toFloat();
+                positions.insert(positions.end(), { p.x, p.y, p.z });
+            }
+
+            MeshOptimizeReport report;
+            std::span<uint8_t> vertexBytes(reinterpret_cast<uint8_t*>(vertices.data()), vertices.size() * sizeof(Vertex));
+            if (!optimize_mesh(indices, vertexBytes, sizeof(Vertex), positions, 3, report)) {
+                return;
+            }
+            std::cout << "   Vertex cache ACMR: " << report.before.acmr << " -> " << report.after.acmr
+                      << ", ATVR: " << report.before.atvr << " -> " << report.after.atvr << std::endl;
+        }
+
+        // Compact layout of the built-in meshes: Position16, OctNormal,
+        // Unorm8x4 color, Half2 uv, OctTangent
+        constexpr uint32_t COMPACT_VERTEX_STRIDE = 24;
+
+        static std::vector<VertexAttribute> compactVertexAttributes() {
+            return {
+                {VertexAttribute::Position16, 0,  0, "position"},
+                {VertexAttribute::OctNormal,  8,  1, "normal"},
+                {VertexAttribute::Unorm8x4,   12, 2, "color"},
+                {VertexAttribute::Half2,      16, 3, "uv"},
+                {VertexAttribute::OctTangent, 20, 4, "tangent"}
+            };
+        }
+
+        template <typename Vertex>
+        static std::vector<uint8_t> packCompactVertices(const std::vector<Vertex>& vertices,
+                                                        const Vec3Q& bounds_min, const Vec3Q& bounds_max) {
+            const PositionQuantizer quantizer(bounds_min, bounds_max);
+            std::vector<uint8_t> packed(vertices.size() * COMPACT_VERTEX_STRIDE);
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                const Vertex& vert = vertices[i];
+                uint8_t* out = packed.data() + i * COMPACT_VERTEX_STRIDE;
+                const uint32_t words[4] = {
+                    encode_octahedral(vert.normal[0], vert.normal[1], vert.normal[2]),
+                    pack_unorm8x4(vert.color[0], vert.color[1], vert.color[2], vert.color[3]),
+                    pack_half2(vert.uv[0], vert.uv[1]),
+                    encode_octahedral_tangent(vert.tangent[0], vert.tangent[1], vert.tangent[2], vert.tangent[3])
+                };
+                quantizer.encode16(vert.position, out);
+                std::memcpy(out + 8, words, sizeof(words));
+            }
+            return packed;
+        }
+
             // Create a data-driven mesh shader asset
         bool DataDrivenAssetCompiler::createDataDrivenTriangle(const std::string& output_path, bool mesh) {
             Asset asset;
@@ -1519,6 +1665,7 @@ void main() {
                 // Left face
                 20, 21, 22, 20, 22, 23
             };
+            optimizeMeshOrder(vertices, indices);
             geom_header.index_count = static_cast<uint32_t>(indices.size());
             geom_header.vertex_stride = sizeof(Vertex);
             std::cout << "DEBUG: Vertex struct size is " << sizeof(Vertex) << " bytes" << std::endl;
@@ -1681,11 +1828,15 @@ void main() {
         bool DataDrivenAssetCompiler::createDataDrivenSphere(const std::string& output_path,
                                                             uint32_t stacks, uint32_t slices,
                                                             int64_t radius_units,
-                                                            bool mesh) {
+                                                            bool mesh, bool compact,
+                                                            uint32_t lod_levels) {
             std::cout << "🚀 Creating UV sphere with Vec3Q support..." << std::endl;
             std::cout << "   Stacks: " << stacks << ", Slices: " << slices << std::endl;
             std::cout << "   Radius: " << radius_units << " units (" 
                     << (radius_units / 128000.0) << "m)" << std::endl;
+            if (compact) {
+                std::cout << "   Vertex layout: compact (" << COMPACT_VERTEX_STRIDE << " bytes)" << std::endl;
+            }
 
             float M_PI = 3.14159265358979323846f;
 
@@ -1811,119 +1962,48 @@ void main() {
               << static_cast<int64_t>(vertices[vertices.size()/2].position.z - 9223372036854775808ULL) << ")" << std::endl;
 
 
+            optimizeMeshOrder(vertices, indices);
+
+            // LOD chain, simplified from the ordered LOD 0 mesh
+            std::vector<LodLevel> lod_chain;
+            if (lod_levels > 1) {
+                std::vector<Vec3Q> lod_positions;
+                std::vector<float> lod_uvs;
+                lod_positions.reserve(vertices.size());
+                lod_uvs.reserve(vertices.size() * 2);
+                for (const auto& vert : vertices) {
+                    lod_positions.push_back(vert.position);
+                    lod_uvs.insert(lod_uvs.end(), { vert.uv[0], vert.uv[1] });
+                }
+
+                LodChainOptions lod_options;
+                lod_options.max_levels = lod_levels;
+                lod_chain = build_lod_chain(indices, lod_positions, lod_options, lod_uvs);
+                if (lod_chain.size() > 1) {
+                    asset.set_feature_flags(asset.get_feature_flags() | FeatureFlags::MultiLOD);
+                }
+            }
+            const bool multi_lod = lod_chain.size() > 1;
+
             // Geometry chunk
             GeometryChunk geom_header{};
-            geom_header.vertex_count   = static_cast<uint32_t>(vertices.size());
-            geom_header.index_count    = static_cast<uint32_t>(indices.size());
-            geom_header.vertex_stride  = sizeof(Vertex);
+            geom_header.vertex_stride  = compact ? COMPACT_VERTEX_STRIDE : sizeof(Vertex);
             geom_header.vertex_format  = VertexFormat::Position3D | VertexFormat::Normal |
                                         VertexFormat::Color | VertexFormat::TexCoord0 | VertexFormat::Tangent;
+            if (compact) {
+                geom_header.vertex_format = geom_header.vertex_format | VertexFormat::Packed;
+            }
             geom_header.bounds_min     = Vec3Q(-radius_units, -radius_units, -radius_units);
             geom_header.bounds_max     = Vec3Q( radius_units,  radius_units,  radius_units);
-            geom_header.lod_distance   = 1000.0f;
+            geom_header.lod_distance   = multi_lod ? 0.0f : 1000.0f;
             geom_header.lod_level      = 0;
 
             // Mesh shader config — sphere can have many verts, workgroup covers one quad strip
             uint32_t max_verts = std::min((slices + 1) * 2, 256u); // Two rows per workgroup
             uint32_t max_prims = std::min(slices * 2, 256u);
-            std::vector<uint8_t> meshlet_data;
-
             if (mesh) {
-                struct Meshlet {
-                    std::vector<uint32_t> vertexIndices;
-                    std::vector<uint32_t> primitiveIndices;
-                };
-                struct MeshletDesc {
-                    uint32_t vertexOffset;
-                    uint32_t vertexCount;
-                    uint32_t primitiveOffset;
-                    uint32_t primitiveCount;
-                };
-
-                constexpr uint32_t MESHLET_MAX_VERTS = 64;
-                constexpr uint32_t MESHLET_MAX_PRIMS = 126;
-                max_verts = MESHLET_MAX_VERTS;
-                max_prims = MESHLET_MAX_PRIMS;
-
-                auto buildMeshlets = [&](uint32_t maxVerts, uint32_t maxPrims) -> std::vector<Meshlet> {
-                    std::vector<Meshlet> meshlets;
-                    Meshlet current;
-                    std::unordered_map<uint32_t, uint32_t> globalToLocal;
-
-                    for (size_t i = 0; i < indices.size(); i += 3) {
-                        uint32_t tri[3] = { indices[i], indices[i + 1], indices[i + 2] };
-
-                        uint32_t newVerts = 0;
-                        for (uint32_t idx : tri) {
-                            if (globalToLocal.find(idx) == globalToLocal.end()) {
-                                ++newVerts;
-                            }
-                        }
-
-                        bool vertOverflow = (current.vertexIndices.size() + newVerts > maxVerts);
-                        bool primOverflow = (current.primitiveIndices.size() / 3 + 1 > maxPrims);
-                        if (!current.vertexIndices.empty() && (vertOverflow || primOverflow)) {
-                            meshlets.push_back(std::move(current));
-                            current = Meshlet{};
-                            globalToLocal.clear();
-                        }
-
-                        for (uint32_t idx : tri) {
-                            if (globalToLocal.find(idx) == globalToLocal.end()) {
-                                globalToLocal[idx] = static_cast<uint32_t>(current.vertexIndices.size());
-                                current.vertexIndices.push_back(idx);
-                            }
-                            current.primitiveIndices.push_back(globalToLocal[idx]);
-                        }
-                    }
-
-                    if (!current.vertexIndices.empty()) {
-                        meshlets.push_back(std::move(current));
-                    }
-
-                    return meshlets;
-                };
-
-                auto meshlets = buildMeshlets(MESHLET_MAX_VERTS, MESHLET_MAX_PRIMS);
-                std::cout << "   Meshlets: " << meshlets.size() << std::endl;
-
-                std::vector<MeshletDesc> meshletDescs;
-                std::vector<uint32_t> meshletVertexIndices;
-                std::vector<uint32_t> meshletPrimIndices;
-
-                for (const auto& m : meshlets) {
-                    MeshletDesc desc{};
-                    desc.vertexOffset = static_cast<uint32_t>(meshletVertexIndices.size());
-                    desc.vertexCount = static_cast<uint32_t>(m.vertexIndices.size());
-                    desc.primitiveOffset = static_cast<uint32_t>(meshletPrimIndices.size());
-                    desc.primitiveCount = static_cast<uint32_t>(m.primitiveIndices.size() / 3);
-
-                    meshletDescs.push_back(desc);
-                    meshletVertexIndices.insert(meshletVertexIndices.end(),
-                        m.vertexIndices.begin(), m.vertexIndices.end());
-                    meshletPrimIndices.insert(meshletPrimIndices.end(),
-                        m.primitiveIndices.begin(), m.primitiveIndices.end());
-                }
-
-                size_t meshletDescSize = meshletDescs.size() * sizeof(MeshletDesc);
-                size_t meshletVertSize = meshletVertexIndices.size() * sizeof(uint32_t);
-                size_t meshletPrimSize = meshletPrimIndices.size() * sizeof(uint32_t);
-                meshlet_data.resize(meshletDescSize + meshletVertSize + meshletPrimSize);
-
-                size_t meshletOffset = 0;
-                std::memcpy(meshlet_data.data() + meshletOffset, meshletDescs.data(), meshletDescSize);
-                meshletOffset += meshletDescSize;
-                std::memcpy(meshlet_data.data() + meshletOffset, meshletVertexIndices.data(), meshletVertSize);
-                meshletOffset += meshletVertSize;
-                std::memcpy(meshlet_data.data() + meshletOffset, meshletPrimIndices.data(), meshletPrimSize);
-
-                geom_header.ms_flags = 1u;
-                geom_header.reserved[0] = static_cast<uint32_t>(meshletDescs.size());
-                geom_header.reserved[1] = static_cast<uint32_t>(meshletVertexIndices.size());
-            } else {
-                geom_header.ms_flags = 0u;
-                geom_header.reserved[0] = 0u;
-                geom_header.reserved[1] = 0u;
+                max_verts = MESHLET_MAX_VERTICES;
+                max_prims = MESHLET_MAX_PRIMITIVES;
             }
 
             geom_header.render_mode           = mesh ? GeometryChunk::MeshShader : GeometryChunk::Traditional;
@@ -1934,25 +2014,94 @@ void main() {
             geom_header.ms_workgroup_size[2]  = 1;
             geom_header.ms_primitive_type     = GeometryChunk::Triangles;
 
-            // Pack geometry data
-            size_t vertex_data_size = vertices.size() * sizeof(Vertex);
-            size_t index_data_size  = indices.size()  * sizeof(uint32_t);
-            size_t total_size       = sizeof(GeometryChunk) + vertex_data_size + index_data_size + meshlet_data.size();
+            // Meshlets and payload of one LOD; fills in the per-LOD header fields
+            auto packGeometry = [&](GeometryChunk& header, const std::vector<Vertex>& lod_vertices,
+                                    const std::vector<uint32_t>& lod_indices, const GeometryLodInfo* lod_info) {
+                header.vertex_count = static_cast<uint32_t>(lod_vertices.size());
+                header.index_count  = static_cast<uint32_t>(lod_indices.size());
+
+                std::vector<uint8_t> meshlet_data;
+                if (mesh) {
+                    // Bounds in the units the shader decodes Vec3Q positions to
+                    std::vector<float> positions;
+                    positions.reserve(lod_vertices.size() * 3);
+                    for (const auto& vert : lod_vertices) {
+                        const glm::vec3 p = vert.position.toFloat();
+                        positions.insert(positions.end(), { p.x, p.y, p.z });
+                    }
 
-            std::vector<uint8_t> geom_data(total_size);
-            size_t offset = 0;
+                    MeshletBuilder builder;
+                    const MeshletSet meshlets = builder.build(lod_indices, positions);
+                    const MeshletStats stats = builder.measure(meshlets);
+                    std::cout << "   Meshlets: " << meshlets.meshlets.size()
+                              << " (vertex fill " << static_cast<int>(stats.vertex_fill * 100.0)
+                              << "%, primitive fill " << static_cast<int>(stats.primitive_fill * 100.0) << "%)" << std::endl;
+
+                    meshlet_data = meshlets.serialize();
+                    header.ms_flags = meshlets.geometry_flags();
+                    header.reserved[0] = static_cast<uint32_t>(meshlets.meshlets.size());
+                    header.reserved[1] = static_cast<uint32_t>(meshlets.vertex_indices.size());
+                } else {
+                    header.ms_flags = 0u;
+                    header.reserved[0] = 0u;
+                    header.reserved[1] = 0u;
+                }
+                if (lod_info) {
+                    header.ms_flags |= GeometryChunk::LodErrorData;
+                }
 
-            std::memcpy(geom_data.data() + offset, &geom_header, sizeof(geom_header));
-            offset += sizeof(geom_header);
-            std::memcpy(geom_data.data() + offset, vertices.data(), vertex_data_size);
-            offset += vertex_data_size;
-            std::memcpy(geom_data.data() + offset, indices.data(), index_data_size);
-            offset += index_data_size;
-            if (!meshlet_data.empty()) {
-                std::memcpy(geom_data.data() + offset, meshlet_data.data(), meshlet_data.size());
-            }
+                std::vector<uint8_t> compact_vertices;
+                if (compact) {
+                    compact_vertices = packCompactVertices(lod_vertices, header.bounds_min, header.bounds_max);
+                }
+                const void* vertex_data = compact ? static_cast<const void*>(compact_vertices.data()) : lod_vertices.data();
+                size_t vertex_data_size = lod_vertices.size() * header.vertex_stride;
+                size_t index_data_size  = lod_indices.size()  * sizeof(uint32_t);
+                size_t lod_info_size    = lod_info ? sizeof(GeometryLodInfo) : 0;
+                size_t total_size       = sizeof(GeometryChunk) + vertex_data_size + index_data_size +
+                                          meshlet_data.size() + lod_info_size;
+
+                std::vector<uint8_t> geom_data(total_size);
+                size_t offset = 0;
 
-            asset.add_chunk(ChunkType::GEOM, geom_data, "vec3q_sphere_geometry");
+                std::memcpy(geom_data.data() + offset, &header, sizeof(header));
+                offset += sizeof(header);
+                std::memcpy(geom_data.data() + offset, vertex_data, vertex_data_size);
+                offset += vertex_data_size;
+                std::memcpy(geom_data.data() + offset, lod_indices.data(), index_data_size);
+                offset += index_data_size;
+                if (!meshlet_data.empty()) {
+                    std::memcpy(geom_data.data() + offset, meshlet_data.data(), meshlet_data.size());
+                    offset += meshlet_data.size();
+                }
+                if (lod_info) {
+                    std::memcpy(geom_data.data() + offset, lod_info, lod_info_size);
+                }
+                return geom_data;
+            };
+
+            const uint32_t source_triangles = static_cast<uint32_t>(indices.size() / 3);
+            const GeometryLodInfo lod0_info{ 0.0f, source_triangles, { 0u, 0u } };
+            asset.add_chunk(ChunkType::GEOM, packGeometry(geom_header, vertices, indices, multi_lod ? &lod0_info : nullptr),
+                            "vec3q_sphere_geometry");
+
+            for (size_t level = 1; level < lod_chain.size(); ++level) {
+                LodLevel& lod = lod_chain[level];
+                std::cout << "   LOD " << lod.lod_level << ": " << lod.indices.size() / 3 << " triangles, error "
+                          << lod.geometric_error << "m, from " << lod.lod_distance << "m" << std::endl;
+
+                // Each LOD keeps only the vertices it references, in fetch order
+                std::vector<Vertex> lod_vertices = vertices;
+                optimizeMeshOrder(lod_vertices, lod.indices);
+                lod_vertices.resize(*std::max_element(lod.indices.begin(), lod.indices.end()) + 1);
+
+                GeometryChunk lod_header = geom_header;
+                lod_header.lod_level    = lod.lod_level;
+                lod_header.lod_distance = lod.lod_distance;
+                const GeometryLodInfo lod_info{ lod.geometric_error, source_triangles, { 0u, 0u } };
+                asset.add_chunk(ChunkType::GEOM, packGeometry(lod_header, lod_vertices, lod.indices, &lod_info),
+                                "vec3q_sphere_geometry_lod" + std::to_string(lod.lod_level));
+            }
 
             // Shader config — identical attribute layout to cube
             MeshShaderGenerator::ShaderConfig config;
@@ -1962,20 +2111,27 @@ void main() {
             config.workgroup_y           = 1;
             config.workgroup_z           = 1;
             config.primitive_type        = GeometryChunk::Triangles;
-            config.vertex_stride         = sizeof(Vertex);
+            config.vertex_stride         = geom_header.vertex_stride;
             config.vertex_count          = geom_header.vertex_count;
             config.has_indices           = true;
             config.index_count           = geom_header.index_count;
             config.prefersCompactVertexOutput = true;
             config.supportsOverlays      = true;
+            config.meshlet_flags         = geom_header.ms_flags;
+            config.bounds_min            = geom_header.bounds_min;
+            config.bounds_max            = geom_header.bounds_max;
 
-            config.attributes = {
-                {VertexAttribute::Vec3Q,  0,  0, "position"},
-                {VertexAttribute::Float3, 24, 1, "normal"},
-                {VertexAttribute::Float4, 36, 2, "color"},
-                {VertexAttribute::Float2, 52, 3, "uv"},
-                {VertexAttribute::Float4, 60, 4, "tangent"}
-            };
+            if (compact) {
+                config.attributes = compactVertexAttributes();
+            } else {
+                config.attributes = {
+                    {VertexAttribute::Vec3Q,  0,  0, "position"},
+                    {VertexAttribute::Float3, 24, 1, "normal"},
+                    {VertexAttribute::Float4, 36, 2, "color"},
+                    {VertexAttribute::Float2, 52, 3, "uv"},
+                    {VertexAttribute::Float4, 60, 4, "tangent"}
+                };
+            }
 
             tremor::taffy::tools::TaffyAssetCompiler compiler;
             if (mesh) {
@@ -2027,7 +2183,7 @@ void main() {
             std::cout << "   📁 File: " << output_path << std::endl;
             std::cout << "   📊 Vertices: " << vertices.size() << std::endl;
             std::cout << "   📊 Triangles: " << indices.size() / 3 << std::endl;
-            std::cout << "   🎯 Vertex stride: " << sizeof(Vertex) << " bytes" << std::endl;
+            std::cout << "   🎯 Vertex stride: " << geom_header.vertex_stride << " bytes" << std::endl;
 
             return true;
         }
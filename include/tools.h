@@ -80,7 +80,9 @@ namespace Taffy {
         static bool createDataDrivenSphere(const std::string& output_path,
                                             uint32_t stacks, uint32_t slices,
                                             int64_t radius_units,
-                                            bool mesh = false);
+                                            bool mesh = false,
+                                            bool compact = false,
+                                            uint32_t lod_levels = 1);
         static bool createDataDrivenTriangle(const std::string& output_path,bool mesh = false);
         static bool createDataDrivenShaderChunk(Asset& asset,
             const std::vector<uint32_t>& vertex_spirv,
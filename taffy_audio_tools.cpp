@@ -1,7 +1,9 @@
 #include "include/taffy_audio_tools.h"
 #include "include/taffy.h"
 #include "include/asset.h"
+#include "include/taffy_stream_writer.h"
 #include <iostream>
+#include <algorithm>
 #include <cstring>
 #include <filesystem>
 #include <ctime>
@@ -1787,13 +1789,13 @@ bool createStreamingAudioAsset(const std::string& inputWavPath,
     std::cout << "  Chunk size: " << chunkSizeMs << " ms (" << samplesPerChunk << " samples)" << std::endl;
     std::cout << "  Total chunks: " << chunkCount << std::endl;
     
-    // CREATE PROPER TAFFY ASSET using Asset API
-    Taffy::Asset asset;
-    asset.set_creator("Taffy Streaming Audio Creator");
-    asset.set_description("Streaming audio from WAV file");
-    asset.set_feature_flags(Taffy::FeatureFlags::Audio);
+    // Stream the asset to disk; only the graph header is built in memory
+    Taffy::AssetStreamWriter writer;
+    writer.set_creator("Taffy Streaming Audio Creator");
+    writer.set_description("Streaming audio from WAV file");
+    writer.set_feature_flags(Taffy::FeatureFlags::Audio);
     
-    // Create audio chunk in memory
+    // Audio graph portion of the chunk (the sample data follows it on disk)
     std::vector<uint8_t> audioChunkData;
     
     // Audio chunk header
@@ -1940,45 +1942,55 @@ bool createStreamingAudioAsset(const std::string& inputWavPath,
                          reinterpret_cast<uint8_t*>(&streamInfo),
                          reinterpret_cast<uint8_t*>(&streamInfo) + sizeof(streamInfo));
     
-    // Now add the actual audio data from the WAV file
+    // Ensure directory exists
+    auto parentPath = std::filesystem::path(outputPath).parent_path();
+    if (!parentPath.empty() && !std::filesystem::exists(parentPath)) {
+        std::filesystem::create_directories(parentPath);
+    }
+    
+    std::cout << "💾 Saving streaming asset to: " << outputPath << std::endl;
+    if (!writer.open(outputPath, 1) ||
+        !writer.begin_chunk(Taffy::ChunkType::AUDI, "streaming_audio") ||
+        !writer.write(audioChunkData.data(), audioChunkData.size())) {
+        std::cerr << "❌ Failed to save streaming asset!" << std::endl;
+        writer.abort();
+        return false;
+    }
+    
+    // Copy the audio data from the WAV file in fixed-size blocks
     std::ifstream wavFile(inputWavPath, std::ios::binary);
     wavFile.seekg(dataOffset);
     
-    // Read and embed the entire audio data into the TAF file
-    std::vector<uint8_t> audioData(dataSize);
-    wavFile.read(reinterpret_cast<char*>(audioData.data()), dataSize);
-    if (!wavFile) {
-        std::cerr << "❌ Failed to read audio data from WAV file" << std::endl;
-        return false;
+    std::vector<uint8_t> block(1024 * 1024);
+    for (uint64_t remaining = dataSize; remaining > 0;) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(remaining, block.size()));
+        wavFile.read(reinterpret_cast<char*>(block.data()), count);
+        if (!wavFile) {
+            std::cerr << "❌ Failed to read audio data from WAV file" << std::endl;
+            writer.abort();
+            return false;
+        }
+        if (!writer.write(block.data(), count)) {
+            std::cerr << "❌ Failed to save streaming asset!" << std::endl;
+            writer.abort();
+            return false;
+        }
+        remaining -= count;
     }
     wavFile.close();
     
-    // Append the audio data to the chunk
-    audioChunkData.insert(audioChunkData.end(), audioData.begin(), audioData.end());
-    
     std::cout << "📊 Embedded " << dataSize << " bytes of audio data into TAF" << std::endl;
     std::cout << "📊 Audio data size: " << (dataSize / (1024.0 * 1024.0)) << " MB (included in TAF)" << std::endl;
-    std::cout << "📊 Total TAF chunk size: " << audioChunkData.size() << " bytes" << std::endl;
-    
-    // Add audio chunk to asset
-    asset.add_chunk(Taffy::ChunkType::AUDI, audioChunkData, "streaming_audio");
-    
-    // Save asset
-    std::cout << "💾 Saving streaming asset to: " << outputPath << std::endl;
-    
-    // Ensure directory exists
-    auto parentPath = std::filesystem::path(outputPath).parent_path();
-    if (!parentPath.empty() && !std::filesystem::exists(parentPath)) {
-        std::filesystem::create_directories(parentPath);
-    }
+    std::cout << "📊 Total TAF chunk size: " << (audioChunkData.size() + dataSize) << " bytes" << std::endl;
     
-    if (!asset.save_to_file(outputPath)) {
+    if (!writer.end_chunk() || !writer.finalize()) {
         std::cerr << "❌ Failed to save streaming asset!" << std::endl;
+        writer.abort();
         return false;
     }
     
     std::cout << "✅ Streaming audio asset created successfully!" << std::endl;
-    std::cout << "   📊 Total TAF size: " << (audioChunkData.size() / (1024.0 * 1024.0)) << " MB" << std::endl;
+    std::cout << "   📊 Total TAF size: " << (writer.get_bytes_written() / (1024.0 * 1024.0)) << " MB" << std::endl;
     std::cout << "   🎵 Duration: " << static_cast<float>(totalSamples) / sampleRate << " seconds" << std::endl;
     std::cout << "   📦 Chunk size: " << chunkSizeMs << " ms" << std::endl;
     std::cout << "   🔄 Total chunks: " << chunkCount << std::endl;
@@ -0,0 +1,579 @@
+#include "include/taffy_chunk_cache.h"
+#include <algorithm>
+
+namespace Taffy {
+
+const char* eviction_policy_name(EvictionPolicy policy) {
+    switch (policy) {
+        case EvictionPolicy::Clock: return "clock";
+        case EvictionPolicy::LRU: return "lru";
+        case EvictionPolicy::LFU: return "lfu";
+        case EvictionPolicy::GreedyDual: return "greedy-dual";
+    }
+    return "unknown";
+}
+
+// =============================================================================
+// CacheMemoryPool
+// =============================================================================
+
+const std::shared_ptr<CacheMemoryPool>& CacheMemoryPool::global() {
+    static const std::shared_ptr<CacheMemoryPool> pool = std::make_shared<CacheMemoryPool>();
+    return pool;
+}
+
+size_t CacheMemoryPool::cache_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return caches_.size();
+}
+
+void CacheMemoryPool::attach(ChunkCache* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    caches_.push_back(cache);
+    bytes_.fetch_add(cache->size_bytes(), std::memory_order_relaxed);
+}
+
+void CacheMemoryPool::detach(ChunkCache* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    caches_.erase(std::remove(caches_.begin(), caches_.end(), cache), caches_.end());
+    bytes_.fetch_sub(cache->size_bytes(), std::memory_order_relaxed);
+}
+
+void CacheMemoryPool::reclaim(const ChunkCache* keep_cache, uint32_t keep) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // One eviction per cache in turn; stop after a full round without progress
+    size_t idle_caches = 0;
+    while (bytes_.load(std::memory_order_relaxed) > get_budget() && idle_caches < caches_.size()) {
+        ChunkCache* cache = caches_[next_cache_++ % caches_.size()];
+        const uint32_t cache_keep = (cache == keep_cache) ? keep : UINT32_MAX;
+
+        bool evicted = false;
+        for (size_t i = 0; i < ChunkCache::SHARD_COUNT && !evicted; ++i) {
+            auto& shard = cache->shards_[cache->next_victim_shard_.fetch_add(1, std::memory_order_relaxed) % ChunkCache::SHARD_COUNT];
+            std::lock_guard<std::mutex> shard_lock(shard.mutex);
+            evicted = cache->evict_one(shard, cache_keep, ChunkCache::NO_TYPE);
+        }
+        idle_caches = evicted ? 0 : idle_caches + 1;
+    }
+}
+
+// =============================================================================
+// ChunkCache
+// =============================================================================
+
+ChunkCache::~ChunkCache() {
+    set_memory_pool(nullptr);
+    free_slot_pages();
+}
+
+ChunkCache::Slot* ChunkCache::find_slot(uint32_t index) const {
+    if (index >= slot_count_) {
+        return nullptr;
+    }
+    Slot* page = slot_pages_[index / SLOT_PAGE_SIZE].load(std::memory_order_acquire);
+    return page ? &page[index % SLOT_PAGE_SIZE] : nullptr;
+}
+
+ChunkCache::Slot* ChunkCache::slot(uint32_t index) {
+    if (index >= slot_count_) {
+        return nullptr;
+    }
+    std::atomic<Slot*>& entry = slot_pages_[index / SLOT_PAGE_SIZE];
+    Slot* page = entry.load(std::memory_order_acquire);
+    if (!page) {
+        // Racing threads may both allocate; the loser frees its page
+        Slot* fresh = new Slot[SLOT_PAGE_SIZE];
+        if (entry.compare_exchange_strong(page, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            page = fresh;
+        } else {
+            delete[] fresh;
+        }
+    }
+    return &page[index % SLOT_PAGE_SIZE];
+}
+
+void ChunkCache::free_slot_pages() {
+    for (size_t page = 0; page < slot_page_count_; ++page) {
+        delete[] slot_pages_[page].load(std::memory_order_relaxed);
+    }
+    slot_pages_.reset();
+    slot_page_count_ = 0;
+}
+
+void ChunkCache::reset(size_t slot_count) {
+    // Another cache may be evicting from us on behalf of the pool
+    std::unique_lock<std::mutex> pool_lock;
+    if (pool_) {
+        pool_lock = std::unique_lock<std::mutex>(pool_->mutex_);
+        pool_->bytes_.fetch_sub(bytes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.ring.clear();
+        shard.hand = 0;
+    }
+    free_slot_pages();
+    slot_page_count_ = (slot_count + SLOT_PAGE_SIZE - 1) / SLOT_PAGE_SIZE;
+    if (slot_page_count_ > 0) {
+        slot_pages_ = std::make_unique<std::atomic<Slot*>[]>(slot_page_count_);
+        for (size_t page = 0; page < slot_page_count_; ++page) {
+            slot_pages_[page].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    slot_count_ = slot_count;
+    bytes_.store(0, std::memory_order_relaxed);
+    entries_.store(0, std::memory_order_relaxed);
+    inflation_.store(0.0, std::memory_order_relaxed);
+    for (auto& usage : types_) {
+        usage.bytes.store(0, std::memory_order_relaxed);
+    }
+    reset_stats();
+}
+
+void ChunkCache::set_chunk_info(uint32_t index, ChunkType type, bool pinned) {
+    Slot* target = slot(index);
+    if (!target) {
+        return;
+    }
+    target->type_slot = add_type_slot(type);
+    target->pinned.store(pinned, std::memory_order_relaxed);
+}
+
+void ChunkCache::set_pinned(uint32_t index, bool pinned) {
+    // Unpinning a slot that was never allocated has nothing to do
+    if (Slot* target = pinned ? slot(index) : find_slot(index)) {
+        target->pinned.store(pinned, std::memory_order_relaxed);
+    }
+}
+
+bool ChunkCache::is_pinned(uint32_t index) const {
+    const Slot* target = find_slot(index);
+    return target && target->pinned.load(std::memory_order_relaxed);
+}
+
+void ChunkCache::touch(Slot& slot, size_t size) const {
+    switch (policy_.load(std::memory_order_relaxed)) {
+        case EvictionPolicy::Clock:
+            // Plain store: the bit is usually already set, avoid an RMW on hot chunks
+            if (!slot.referenced.load(std::memory_order_relaxed)) {
+                slot.referenced.store(true, std::memory_order_relaxed);
+            }
+            break;
+        case EvictionPolicy::LRU:
+            slot.last_access.store(tick_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            break;
+        case EvictionPolicy::LFU: {
+            // Racy increment: a lost count on a contended hot chunk is harmless
+            const uint32_t frequency = slot.frequency.load(std::memory_order_relaxed);
+            if (frequency < UINT32_MAX) {
+                slot.frequency.store(frequency + 1, std::memory_order_relaxed);
+            }
+            slot.last_access.store(tick_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            break;
+        }
+        case EvictionPolicy::GreedyDual:
+            slot.priority.store(inflation_.load(std::memory_order_relaxed) + 1.0 / static_cast<double>(std::max<size_t>(size, 1)),
+                                std::memory_order_relaxed);
+            slot.last_access.store(tick_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            break;
+    }
+}
+
+ChunkBufferPtr ChunkCache::find(uint32_t index) const {
+    if (index >= slot_count_) {
+        return nullptr;
+    }
+    Slot* slot = find_slot(index);
+    ChunkBufferPtr buffer = slot ? slot->buffer.load(std::memory_order_acquire) : nullptr;
+    Shard& shard = shard_for(index);
+    if (buffer) {
+        touch(*slot, buffer->size());
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    return buffer;
+}
+
+ChunkBufferPtr ChunkCache::peek(uint32_t index) const {
+    const Slot* slot = find_slot(index);
+    return slot ? slot->buffer.load(std::memory_order_acquire) : nullptr;
+}
+
+ChunkBufferPtr ChunkCache::insert(uint32_t index, std::vector<uint8_t> data) {
+    Slot* target = slot(index);
+    if (!target) {
+        return std::make_shared<const ChunkBuffer>(std::move(data));
+    }
+
+    Slot& slot = *target;
+    ChunkBufferPtr buffer;
+    {
+        Shard& shard = shard_for(index);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (ChunkBufferPtr existing = slot.buffer.load(std::memory_order_acquire)) {
+            return existing;
+        }
+        buffer = std::make_shared<const ChunkBuffer>(std::move(data));
+        const size_t size = buffer->size();
+
+        slot.referenced.store(true, std::memory_order_relaxed);
+        slot.last_access.store(tick_.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        slot.frequency.store(1, std::memory_order_relaxed);
+        slot.priority.store(inflation_.load(std::memory_order_relaxed) + 1.0 / static_cast<double>(std::max<size_t>(size, 1)),
+                            std::memory_order_relaxed);
+        slot.buffer.store(buffer, std::memory_order_release);
+        shard.ring.push_back(index);
+
+        bytes_.fetch_add(size, std::memory_order_relaxed);
+        entries_.fetch_add(1, std::memory_order_relaxed);
+        if (slot.type_slot != NO_TYPE) {
+            types_[slot.type_slot].bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+        if (pool_) {
+            pool_->bytes_.fetch_add(size, std::memory_order_relaxed);
+        }
+    }
+
+    enforce_limits(index);
+    return buffer;
+}
+
+bool ChunkCache::evictable(uint32_t index, uint32_t keep, uint8_t type_slot) const {
+    const Slot& slot = resident_slot(index);
+    return index != keep &&
+           !slot.pinned.load(std::memory_order_relaxed) &&
+           (type_slot == NO_TYPE || slot.type_slot == type_slot);
+}
+
+void ChunkCache::release(const Slot& slot, size_t size) {
+    bytes_.fetch_sub(size, std::memory_order_relaxed);
+    entries_.fetch_sub(1, std::memory_order_relaxed);
+    if (slot.type_slot != NO_TYPE) {
+        types_[slot.type_slot].bytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+    if (pool_) {
+        pool_->bytes_.fetch_sub(size, std::memory_order_relaxed);
+    }
+}
+
+void ChunkCache::evict_at(Shard& shard, size_t position, bool counted) {
+    Slot& slot = resident_slot(shard.ring[position]);
+    ChunkBufferPtr victim = slot.buffer.exchange(nullptr, std::memory_order_acq_rel);
+    shard.ring[position] = shard.ring.back();
+    shard.ring.pop_back();
+    if (victim) {
+        release(slot, victim->size());
+        if (counted) {
+            shard.evictions.fetch_add(1, std::memory_order_relaxed);
+            shard.evicted_bytes.fetch_add(victim->size(), std::memory_order_relaxed);
+        }
+    }
+}
+
+bool ChunkCache::evict_one(Shard& shard, uint32_t keep, uint8_t type_slot) {
+    if (shard.ring.empty()) {
+        return false;
+    }
+    if (get_policy() == EvictionPolicy::Clock) {
+        return evict_clock(shard, keep, type_slot);
+    }
+    size_t sampled = 0;
+    const size_t best = sample_shard(shard, keep, type_slot, sampled);
+    if (best == shard.ring.size()) {
+        return false;
+    }
+    evict_at(shard, best);
+    return true;
+}
+
+bool ChunkCache::evict_clock(Shard& shard, uint32_t keep, uint8_t type_slot) {
+    // Two sweeps clear every referenced bit, so this terminates
+    for (size_t step = 0, limit = shard.ring.size() * 2; step < limit && !shard.ring.empty(); ++step) {
+        if (shard.hand >= shard.ring.size()) {
+            shard.hand = 0;
+        }
+        const uint32_t index = shard.ring[shard.hand];
+        if (!evictable(index, keep, type_slot) ||
+            resident_slot(index).referenced.exchange(false, std::memory_order_relaxed)) {
+            ++shard.hand;
+            continue;
+        }
+        evict_at(shard, shard.hand);
+        return true;
+    }
+    return false;
+}
+
+ChunkCache::Score ChunkCache::score(const Slot& slot, EvictionPolicy policy) const {
+    const uint64_t last_access = slot.last_access.load(std::memory_order_relaxed);
+    switch (policy) {
+        case EvictionPolicy::LFU:
+            return { static_cast<double>(slot.frequency.load(std::memory_order_relaxed)), last_access };
+        case EvictionPolicy::GreedyDual:
+            return { slot.priority.load(std::memory_order_relaxed), last_access };
+        default:
+            return { static_cast<double>(last_access), 0 };
+    }
+}
+
+size_t ChunkCache::sample_shard(Shard& shard, uint32_t keep, uint8_t type_slot, size_t& sample_count) {
+    const EvictionPolicy policy = get_policy();
+    const size_t count = shard.ring.size();
+    if (count == 0) {
+        return 0;
+    }
+    if (shard.hand >= count) {
+        shard.hand = 0;
+    }
+
+    // Scan from the hand until EVICTION_SAMPLES candidates have been seen
+    std::array<size_t, EVICTION_SAMPLES> sampled{};
+    sample_count = 0;
+    size_t best = count;
+    Score best_score{};
+    for (size_t step = 0; step < count && sample_count < EVICTION_SAMPLES; ++step) {
+        const size_t position = (shard.hand + step) % count;
+        if (!evictable(shard.ring[position], keep, type_slot)) {
+            continue;
+        }
+        sampled[sample_count++] = position;
+        const Score candidate = score(resident_slot(shard.ring[position]), policy);
+        if (best == count || candidate < best_score) {
+            best = position;
+            best_score = candidate;
+        }
+    }
+    shard.hand += EVICTION_SAMPLES;
+
+    if (policy == EvictionPolicy::LFU) {
+        // Age the survivors so formerly hot chunks eventually become evictable
+        for (size_t i = 0; i < sample_count; ++i) {
+            if (sampled[i] != best) {
+                auto& frequency = resident_slot(shard.ring[sampled[i]]).frequency;
+                frequency.store(frequency.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+            }
+        }
+    }
+    return best;
+}
+
+bool ChunkCache::evict_sampled(uint32_t keep, uint8_t type_slot) {
+    const EvictionPolicy policy = get_policy();
+
+    // Best candidate of at least SAMPLED_SHARDS shards, one lock at a time;
+    // sparse caches keep visiting shards until EVICTION_SAMPLES were seen
+    uint32_t victim = UINT32_MAX;
+    Score victim_score{};
+    size_t total_sampled = 0;
+    for (size_t visited = 0; visited < SHARD_COUNT && (visited < SAMPLED_SHARDS || total_sampled < EVICTION_SAMPLES); ++visited) {
+        Shard& shard = shards_[next_victim_shard_.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t sampled = 0;
+        const size_t best = sample_shard(shard, keep, type_slot, sampled);
+        total_sampled += sampled;
+        if (best == shard.ring.size()) {
+            continue;
+        }
+        const Score candidate = score(resident_slot(shard.ring[best]), policy);
+        if (victim == UINT32_MAX || candidate < victim_score) {
+            victim = shard.ring[best];
+            victim_score = candidate;
+        }
+    }
+    if (victim == UINT32_MAX) {
+        return false;
+    }
+
+    Shard& shard = shard_for(victim);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = std::find(shard.ring.begin(), shard.ring.end(), victim);
+    if (it == shard.ring.end()) {
+        return true;    // Someone else evicted it meanwhile; still progress
+    }
+    if (policy == EvictionPolicy::GreedyDual) {
+        // L rises to the evicted H, so untouched chunks age relative to new ones
+        const double h = resident_slot(victim).priority.load(std::memory_order_relaxed);
+        double inflation = inflation_.load(std::memory_order_relaxed);
+        while (h > inflation && !inflation_.compare_exchange_weak(inflation, h, std::memory_order_relaxed)) {
+        }
+    }
+    evict_at(shard, static_cast<size_t>(it - shard.ring.begin()));
+    return true;
+}
+
+template <typename Predicate>
+void ChunkCache::evict_while(Predicate over_limit, uint32_t keep, uint8_t type_slot) {
+    if (get_policy() != EvictionPolicy::Clock) {
+        // A failed sample has visited every shard: nothing is evictable
+        while (over_limit() && evict_sampled(keep, type_slot)) {
+        }
+        return;
+    }
+
+    // Visit shards round-robin, one lock at a time
+    size_t idle_shards = 0;
+    while (over_limit() && idle_shards < SHARD_COUNT) {
+        Shard& shard = shards_[next_victim_shard_.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        idle_shards = evict_one(shard, keep, type_slot) ? 0 : idle_shards + 1;
+    }
+}
+
+void ChunkCache::enforce_limits(uint32_t index) {
+    const Slot* slot = find_slot(index);
+    const uint8_t type_slot = slot ? slot->type_slot : NO_TYPE;
+    if (type_slot != NO_TYPE) {
+        const TypeUsage& usage = types_[type_slot];
+        evict_while([&usage]() {
+            return usage.bytes.load(std::memory_order_relaxed) > usage.quota.load(std::memory_order_relaxed);
+        }, index, type_slot);
+    }
+
+    evict_while([this]() { return size_bytes() > get_budget(); }, index, NO_TYPE);
+
+    if (pool_ && pool_->size_bytes() > pool_->get_budget()) {
+        pool_->reclaim(this, index);
+    }
+}
+
+void ChunkCache::set_budget(uint64_t budget_bytes) {
+    budget_.store(budget_bytes, std::memory_order_relaxed);
+    if (slot_count_ > 0) {
+        evict_while([this]() { return size_bytes() > get_budget(); }, UINT32_MAX, NO_TYPE);
+    }
+}
+
+uint8_t ChunkCache::find_type_slot(ChunkType type) const {
+    const size_t count = type_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        if (types_[i].type.load(std::memory_order_relaxed) == static_cast<uint32_t>(type)) {
+            return static_cast<uint8_t>(i);
+        }
+    }
+    return NO_TYPE;
+}
+
+uint8_t ChunkCache::add_type_slot(ChunkType type) {
+    std::lock_guard<std::mutex> lock(type_mutex_);
+    uint8_t type_slot = find_type_slot(type);
+    const size_t count = type_count_.load(std::memory_order_relaxed);
+    if (type_slot == NO_TYPE && count < MAX_TRACKED_TYPES) {
+        types_[count].type.store(static_cast<uint32_t>(type), std::memory_order_relaxed);
+        types_[count].quota.store(UNLIMITED, std::memory_order_relaxed);
+        types_[count].bytes.store(0, std::memory_order_relaxed);
+        type_count_.store(count + 1, std::memory_order_release);
+        type_slot = static_cast<uint8_t>(count);
+    }
+    return type_slot;
+}
+
+void ChunkCache::set_type_quota(ChunkType type, uint64_t bytes) {
+    const uint8_t type_slot = add_type_slot(type);
+    if (type_slot == NO_TYPE) {
+        return;
+    }
+    TypeUsage& usage = types_[type_slot];
+    usage.quota.store(bytes, std::memory_order_relaxed);
+    if (slot_count_ > 0) {
+        evict_while([&usage]() {
+            return usage.bytes.load(std::memory_order_relaxed) > usage.quota.load(std::memory_order_relaxed);
+        }, UINT32_MAX, type_slot);
+    }
+}
+
+uint64_t ChunkCache::get_type_quota(ChunkType type) const {
+    const uint8_t type_slot = find_type_slot(type);
+    return type_slot == NO_TYPE ? UNLIMITED : types_[type_slot].quota.load(std::memory_order_relaxed);
+}
+
+uint64_t ChunkCache::type_size_bytes(ChunkType type) const {
+    const uint8_t type_slot = find_type_slot(type);
+    return type_slot == NO_TYPE ? 0 : types_[type_slot].bytes.load(std::memory_order_relaxed);
+}
+
+void ChunkCache::set_memory_pool(std::shared_ptr<CacheMemoryPool> pool) {
+    if (pool == pool_) {
+        return;
+    }
+    if (pool_) {
+        pool_->detach(this);
+    }
+    pool_ = std::move(pool);
+    if (pool_) {
+        pool_->attach(this);
+    }
+}
+
+bool ChunkCache::erase(uint32_t index) {
+    if (index >= slot_count_) {
+        return false;
+    }
+    Shard& shard = shard_for(index);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = std::find(shard.ring.begin(), shard.ring.end(), index);
+    if (it == shard.ring.end()) {
+        return false;
+    }
+    evict_at(shard, static_cast<size_t>(it - shard.ring.begin()), false);
+    return true;
+}
+
+void ChunkCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (uint32_t index : shard.ring) {
+            Slot& slot = resident_slot(index);
+            if (ChunkBufferPtr victim = slot.buffer.exchange(nullptr, std::memory_order_acq_rel)) {
+                release(slot, victim->size());
+            }
+        }
+        shard.ring.clear();
+        shard.hand = 0;
+    }
+}
+
+void ChunkCache::reset_stats() {
+    for (auto& shard : shards_) {
+        shard.hits.store(0, std::memory_order_relaxed);
+        shard.misses.store(0, std::memory_order_relaxed);
+        shard.evictions.store(0, std::memory_order_relaxed);
+        shard.evicted_bytes.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t ChunkCache::hits() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.hits.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t ChunkCache::misses() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.misses.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t ChunkCache::evictions() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.evictions.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t ChunkCache::evicted_bytes() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.evicted_bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+} // namespace Taffy
@@ -0,0 +1,319 @@
+#include "include/taffy_codec.h"
+#include <cstring>
+
+namespace Taffy {
+
+namespace {
+
+// LZ4 block format parameters
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;     // The last 5 bytes are always literals
+constexpr size_t MF_LIMIT = 12;         // The last match must start 12+ bytes before the end
+constexpr size_t MAX_DISTANCE = 65535;
+constexpr int HASH_BITS = 16;
+constexpr int HC_MAX_ATTEMPTS = 64;
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hash4(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+inline size_t matchLength(const uint8_t* a, const uint8_t* b, const uint8_t* limit) {
+    const uint8_t* start = a;
+    while (a < limit && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return static_cast<size_t>(a - start);
+}
+
+void writeLength(std::vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+// Emit one sequence: literals [literals, literals + literal_length) followed by a
+// match of match_length bytes at `offset` back. match_length == 0 marks the
+// final, literals-only sequence.
+void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literal_length,
+                   size_t offset, size_t match_length) {
+    const size_t token_pos = out.size();
+    out.push_back(0);
+
+    uint8_t token = 0;
+    if (literal_length >= 15) {
+        token = 15 << 4;
+        writeLength(out, literal_length - 15);
+    } else {
+        token = static_cast<uint8_t>(literal_length << 4);
+    }
+    out.insert(out.end(), literals, literals + literal_length);
+
+    if (match_length > 0) {
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        const size_t extra = match_length - MIN_MATCH;
+        if (extra >= 15) {
+            token |= 15;
+            writeLength(out, extra - 15);
+        } else {
+            token |= static_cast<uint8_t>(extra);
+        }
+    }
+    out[token_pos] = token;
+}
+
+// Greedy single-probe encoder
+void compressFast(std::span<const uint8_t> input, std::vector<uint8_t>& out) {
+    const uint8_t* base = input.data();
+    const size_t n = input.size();
+    size_t anchor = 0;
+
+    if (n >= MF_LIMIT + 1) {
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+        const uint8_t* match_limit = base + n - LAST_LITERALS;
+        size_t ip = 0;
+
+        while (ip + MF_LIMIT <= n) {
+            const uint32_t sequence = read32(base + ip);
+            const uint32_t h = hash4(sequence);
+            size_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(ip);
+
+            if (candidate >= ip || ip - candidate > MAX_DISTANCE || read32(base + candidate) != sequence) {
+                // Skip faster through incompressible regions
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // Extend the match backwards into pending literals
+            while (ip > anchor && candidate > 0 && base[ip - 1] == base[candidate - 1]) {
+                --ip;
+                --candidate;
+            }
+
+            const size_t length = MIN_MATCH +
+                matchLength(base + ip + MIN_MATCH, base + candidate + MIN_MATCH, match_limit);
+            writeSequence(out, base + anchor, ip - anchor, ip - candidate, length);
+            ip += length;
+            anchor = ip;
+
+            if (ip + MF_LIMIT <= n) {
+                table[hash4(read32(base + ip - 2))] = static_cast<uint32_t>(ip - 2);
+            }
+        }
+    }
+
+    writeSequence(out, base + anchor, n - anchor, 0, 0);
+}
+
+// Hash-chain encoder: searches up to HC_MAX_ATTEMPTS earlier positions with
+// the same 4-byte prefix inside the 64 KiB window and keeps the longest match.
+void compressHighRatio(std::span<const uint8_t> input, std::vector<uint8_t>& out) {
+    const uint8_t* base = input.data();
+    const size_t n = input.size();
+    size_t anchor = 0;
+
+    if (n >= MF_LIMIT + 1) {
+        std::vector<int64_t> head(size_t(1) << HASH_BITS, -1);
+        std::vector<uint16_t> chain(MAX_DISTANCE + 1, 0);  // Delta to the previous position, 0 = end
+        const uint8_t* match_limit = base + n - LAST_LITERALS;
+        size_t next_to_insert = 0;
+        size_t ip = 0;
+
+        auto insert = [&](size_t pos) {
+            const uint32_t h = hash4(read32(base + pos));
+            const int64_t previous = head[h];
+            const size_t delta = previous >= 0 ? pos - static_cast<size_t>(previous) : 0;
+            chain[pos & MAX_DISTANCE] = delta <= MAX_DISTANCE ? static_cast<uint16_t>(delta) : 0;
+            head[h] = static_cast<int64_t>(pos);
+        };
+
+        while (ip + MF_LIMIT <= n) {
+            while (next_to_insert < ip) {
+                insert(next_to_insert++);
+            }
+
+            const uint32_t sequence = read32(base + ip);
+            size_t best_length = 0;
+            size_t best_offset = 0;
+            int64_t candidate = head[hash4(sequence)];
+            for (int attempt = 0; attempt < HC_MAX_ATTEMPTS && candidate >= 0; ++attempt) {
+                const size_t pos = static_cast<size_t>(candidate);
+                if (ip - pos > MAX_DISTANCE) {
+                    break;
+                }
+                if (read32(base + pos) == sequence) {
+                    const size_t length = MIN_MATCH +
+                        matchLength(base + ip + MIN_MATCH, base + pos + MIN_MATCH, match_limit);
+                    if (length > best_length) {
+                        best_length = length;
+                        best_offset = ip - pos;
+                    }
+                }
+                const uint16_t delta = chain[pos & MAX_DISTANCE];
+                if (delta == 0) {
+                    break;
+                }
+                candidate -= delta;
+            }
+
+            if (best_length == 0) {
+                ++ip;
+                continue;
+            }
+
+            writeSequence(out, base + anchor, ip - anchor, best_offset, best_length);
+            ip += best_length;
+            anchor = ip;
+        }
+    }
+
+    writeSequence(out, base + anchor, n - anchor, 0, 0);
+}
+
+bool decompressLz4(std::span<const uint8_t> input, std::span<uint8_t> output) {
+    const uint8_t* ip = input.data();
+    const uint8_t* const in_end = ip + input.size();
+    uint8_t* op = output.data();
+    uint8_t* const out_start = op;
+    uint8_t* const out_end = op + output.size();
+
+    auto readLength = [&](size_t& length) {
+        uint8_t byte = 0;
+        do {
+            if (ip >= in_end) {
+                return false;
+            }
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (ip < in_end) {
+        const uint8_t token = *ip++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !readLength(literal_length)) {
+            return false;
+        }
+        if (literal_length > static_cast<size_t>(in_end - ip) ||
+            literal_length > static_cast<size_t>(out_end - op)) {
+            return false;
+        }
+        if (literal_length) {
+            // Empty output may have a null data(); memcpy(nullptr, _, 0) is UB
+            std::memcpy(op, ip, literal_length);
+            ip += literal_length;
+            op += literal_length;
+        }
+
+        if (ip == in_end) {
+            break;  // Final literals-only sequence
+        }
+
+        if (in_end - ip < 2) {
+            return false;
+        }
+        const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - out_start)) {
+            return false;
+        }
+
+        size_t match_length = token & 15;
+        if (match_length == 15 && !readLength(match_length)) {
+            return false;
+        }
+        match_length += MIN_MATCH;
+        if (match_length > static_cast<size_t>(out_end - op)) {
+            return false;
+        }
+
+        const uint8_t* match = op - offset;
+        if (offset >= match_length) {
+            if (match_length) {
+                std::memcpy(op, match, match_length);
+            }
+            op += match_length;
+        } else {
+            // Overlapping copy replicates the last `offset` bytes
+            for (size_t i = 0; i < match_length; ++i) {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    return op == out_end;
+}
+
+} // namespace
+
+const char* chunk_codec_name(ChunkCodec codec) {
+    switch (codec) {
+    case ChunkCodec::None: return "none";
+    case ChunkCodec::LZ4: return "lz4";
+    case ChunkCodec::LZ4HC: return "lz4hc";
+    }
+    return "unknown";
+}
+
+size_t chunk_compress_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+bool compress_chunk(ChunkCodec codec, std::span<const uint8_t> input, std::vector<uint8_t>& output) {
+    output.clear();
+    output.reserve(chunk_compress_bound(input.size()));
+    switch (codec) {
+    case ChunkCodec::LZ4:
+        compressFast(input, output);
+        return true;
+    case ChunkCodec::LZ4HC:
+        compressHighRatio(input, output);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool decompress_chunk(ChunkCodec codec, std::span<const uint8_t> input, std::span<uint8_t> output) {
+    switch (codec) {
+    case ChunkCodec::LZ4:
+    case ChunkCodec::LZ4HC:
+        return decompressLz4(input, output);
+    default:
+        return false;
+    }
+}
+
+bool decode_chunk_payload(const ChunkDirectoryEntry& entry, std::span<const uint8_t> stored,
+                          std::vector<uint8_t>& decoded) {
+    if (entry.codec == ChunkCodec::None) {
+        decoded.assign(stored.begin(), stored.end());
+        return true;
+    }
+
+    // LZ4 cannot expand data by more than ~255x; anything larger is corrupt
+    if (entry.uncompressed_size / 255 > stored.size() + 1) {
+        return false;
+    }
+
+    decoded.resize(static_cast<size_t>(entry.uncompressed_size));
+    if (!decompress_chunk(entry.codec, stored, decoded)) {
+        decoded.clear();
+        return false;
+    }
+    return true;
+}
+
+} // namespace Taffy
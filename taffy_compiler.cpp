@@ -12,19 +12,13 @@
 #include <string>
 #include <sstream>
 #include "include/taffy.h"
+#include "include/taffy_crc32.h"
 
 using namespace Taffy;
 
-// Simple CRC32 implementation
+// Shared chunk checksum (build together with taffy_crc32.cpp)
 uint32_t calculate_crc32(const uint8_t* data, size_t size) {
-    uint32_t crc = 0xFFFFFFFF;
-    for (size_t i = 0; i < size; i++) {
-        crc ^= data[i];
-        for (int j = 0; j < 8; j++) {
-            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
-        }
-    }
-    return ~crc;
+    return crc32(data, size);
 }
 
 class TaffyCompiler {
@@ -0,0 +1,299 @@
+#include "include/taffy_crc32.h"
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TAFFY_CRC32_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TAFFY_CRC32_ARM 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <windows.h>
+#else
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+#endif
+
+namespace Taffy {
+
+namespace {
+
+constexpr uint32_t CRC32_POLYNOMIAL = 0xEDB88320u;
+
+// tables[0] is the classic byte-at-a-time table; tables[k][b] is the CRC of
+// byte b followed by k zero bytes, which lets 16 input bytes be folded per step.
+constexpr std::array<std::array<uint32_t, 256>, 16> makeCrc32Tables() {
+    std::array<std::array<uint32_t, 256>, 16> tables{};
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint32_t crc = b;
+        for (int j = 0; j < 8; ++j) {
+            crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & (0u - (crc & 1u)));
+        }
+        tables[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; ++b) {
+        for (size_t k = 1; k < 16; ++k) {
+            const uint32_t prev = tables[k - 1][b];
+            tables[k][b] = (prev >> 8) ^ tables[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr auto CRC32_TABLES = makeCrc32Tables();
+
+inline uint32_t load32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Operates on the pre-inverted CRC state
+uint32_t slice16Update(uint32_t crc, const uint8_t* p, size_t length) {
+    const auto& t = CRC32_TABLES;
+    while (length >= 16) {
+        const uint32_t a = load32(p) ^ crc;
+        const uint32_t b = load32(p + 4);
+        const uint32_t c = load32(p + 8);
+        const uint32_t d = load32(p + 12);
+        crc = t[15][a & 0xFF] ^ t[14][(a >> 8) & 0xFF] ^ t[13][(a >> 16) & 0xFF] ^ t[12][a >> 24] ^
+              t[11][b & 0xFF] ^ t[10][(b >> 8) & 0xFF] ^ t[9][(b >> 16) & 0xFF] ^ t[8][b >> 24] ^
+              t[7][c & 0xFF] ^ t[6][(c >> 8) & 0xFF] ^ t[5][(c >> 16) & 0xFF] ^ t[4][c >> 24] ^
+              t[3][d & 0xFF] ^ t[2][(d >> 8) & 0xFF] ^ t[1][(d >> 16) & 0xFF] ^ t[0][d >> 24];
+        p += 16;
+        length -= 16;
+    }
+    while (length--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#if TAFFY_CRC32_X86
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TAFFY_TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#else
+#define TAFFY_TARGET_PCLMUL
+#endif
+
+// Carry-less multiplication folding (Gopal et al., "Fast CRC Computation for
+// Generic Polynomials Using PCLMULQDQ Instruction") with the bit-reflected
+// constants for 0xEDB88320. Requires length >= 64 and a multiple of 16;
+// operates on the pre-inverted CRC state.
+TAFFY_TARGET_PCLMUL
+uint32_t pclmulFold(uint32_t crc, const uint8_t* p, size_t length) {
+    alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+    alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+    alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+    alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    p += 64;
+    length -= 64;
+
+    // Fold four 128-bit lanes in parallel
+    while (length >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        y5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00));
+        y6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10));
+        y7 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20));
+        y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30));
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+        p += 64;
+        length -= 64;
+    }
+
+    // Fold the four lanes into one
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // Remaining 16-byte blocks
+    while (length >= 16) {
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        p += 16;
+        length -= 16;
+    }
+
+    // Fold 128 bits to 64 bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+uint32_t pclmulUpdate(uint32_t crc, const uint8_t* p, size_t length) {
+    if (length >= 64) {
+        const size_t folded = length & ~size_t(15);
+        crc = pclmulFold(crc, p, folded);
+        p += folded;
+        length -= folded;
+    }
+    return slice16Update(crc, p, length);
+}
+
+bool cpuHasPclmul() {
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    ecx = static_cast<unsigned int>(info[2]);
+#else
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+#endif
+    const bool pclmul = (ecx & (1u << 1)) != 0;
+    const bool sse41 = (ecx & (1u << 19)) != 0;
+    return pclmul && sse41;
+}
+
+#endif // TAFFY_CRC32_X86
+
+#if TAFFY_CRC32_ARM
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TAFFY_TARGET_CRC __attribute__((target("+crc")))
+#else
+#define TAFFY_TARGET_CRC
+#endif
+
+// ARMv8 CRC32X/W/B implement the same reflected 0xEDB88320 polynomial
+// (the CRC32C variants are the Castagnoli ones). Operates on the
+// pre-inverted CRC state.
+TAFFY_TARGET_CRC
+uint32_t armCrcUpdate(uint32_t crc, const uint8_t* p, size_t length) {
+    while (length >= 8) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        crc = __crc32d(crc, value);
+        p += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = __crc32b(crc, *p++);
+    }
+    return crc;
+}
+
+bool cpuHasArmCrc() {
+#if defined(_MSC_VER)
+    return IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined(__APPLE__)
+    return true;
+#elif defined(__linux__) && defined(HWCAP_CRC32)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#elif defined(__ARM_FEATURE_CRC32)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#endif // TAFFY_CRC32_ARM
+
+using Crc32UpdateFn = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+struct Crc32Dispatch {
+    Crc32UpdateFn update = slice16Update;
+    const char* name = "slice-by-16";
+
+    Crc32Dispatch() {
+#if TAFFY_CRC32_X86
+        if (cpuHasPclmul()) {
+            update = pclmulUpdate;
+            name = "pclmul";
+        }
+#elif TAFFY_CRC32_ARM
+        if (cpuHasArmCrc()) {
+            update = armCrcUpdate;
+            name = "armv8-crc";
+        }
+#endif
+    }
+};
+
+const Crc32Dispatch& crc32Dispatch() {
+    static const Crc32Dispatch dispatch;
+    return dispatch;
+}
+
+} // namespace
+
+uint32_t crc32(const void* data, size_t length, uint32_t crc) {
+    return ~crc32Dispatch().update(~crc, static_cast<const uint8_t*>(data), length);
+}
+
+uint32_t crc32_slice16(const void* data, size_t length, uint32_t crc) {
+    return ~slice16Update(~crc, static_cast<const uint8_t*>(data), length);
+}
+
+uint32_t crc32_reference(const void* data, size_t length, uint32_t crc) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= p[i];
+        for (int j = 0; j < 8; ++j) {
+            crc = (crc >> 1) ^ (CRC32_POLYNOMIAL * (crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+const char* crc32_implementation() {
+    return crc32Dispatch().name;
+}
+
+} // namespace Taffy
@@ -0,0 +1,238 @@
+#include "include/taffy_directory.h"
+#include <cstring>
+#include <iostream>
+#include <map>
+
+namespace Taffy {
+
+std::vector<uint8_t> build_chunk_index_table(std::span<const ChunkDirectoryEntry> stored) {
+    std::vector<ChunkDirectoryEntry> directory(stored.begin(), stored.end());
+    ChunkDirectoryEntry index_entry{};
+    index_entry.type = ChunkType::INDX;
+    std::strncpy(index_entry.name, CHUNK_INDEX_NAME, sizeof(index_entry.name) - 1);
+    directory.push_back(index_entry);
+
+    // Types in order, each with its first directory entry
+    std::map<uint32_t, ChunkIndexTable::TypeEntry> types;
+    std::vector<uint32_t> boot;
+    std::vector<ChunkIndexTable::NameEntry> names;
+    names.reserve(directory.size());
+    for (uint32_t i = 0; i < directory.size(); ++i) {
+        const auto& entry = directory[i];
+        auto [it, inserted] = types.try_emplace(static_cast<uint32_t>(entry.type),
+                                                ChunkIndexTable::TypeEntry{ entry.type, i, 0 });
+        it->second.count++;
+        if (chunk_residency(entry) == ResidencyClass::Boot) {
+            boot.push_back(i);
+        }
+        names.push_back({ fnv1a_hash(entry.name, sizeof(entry.name)), i });
+    }
+    std::sort(names.begin(), names.end(), [](const auto& a, const auto& b) {
+        return a.name_hash != b.name_hash ? a.name_hash < b.name_hash : a.index < b.index;
+    });
+
+    ChunkIndexTable header{};
+    std::memcpy(header.magic, "CIDX", 4);
+    header.version = ChunkIndexTable::VERSION;
+    header.entry_count = static_cast<uint32_t>(names.size());
+    header.type_count = static_cast<uint32_t>(types.size());
+    header.boot_count = static_cast<uint32_t>(boot.size());
+
+    std::vector<uint8_t> table;
+    table.reserve(sizeof(header) + types.size() * sizeof(ChunkIndexTable::TypeEntry) +
+                  boot.size() * sizeof(uint32_t) + names.size() * sizeof(ChunkIndexTable::NameEntry));
+    auto append = [&table](const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        table.insert(table.end(), bytes, bytes + size);
+    };
+    append(&header, sizeof(header));
+    for (const auto& [type, entry] : types) {
+        append(&entry, sizeof(entry));
+    }
+    append(boot.data(), boot.size() * sizeof(uint32_t));
+    append(names.data(), names.size() * sizeof(ChunkIndexTable::NameEntry));
+    return table;
+}
+
+bool ChunkDirectory::open(const PositionalFile& file, const AssetHeader& header, bool lazy) {
+    clear();
+
+    if (lazy && header.index_chunk != 0) {
+        if (open_lazy(file, header)) {
+            return true;
+        }
+        std::cerr << "⚠️ Ignoring invalid chunk index, reading the full directory" << std::endl;
+        clear();
+    }
+
+    const uint64_t directory_bytes = uint64_t(header.chunk_count) * sizeof(ChunkDirectoryEntry);
+    if (directory_bytes > file.size() - sizeof(AssetHeader)) {
+        std::cerr << "Chunk directory extends beyond file" << std::endl;
+        return false;
+    }
+    entries_.reset(&file, sizeof(AssetHeader), header.chunk_count, DIRECTORY_PAGE_ENTRIES);
+    if (!entries_.load_all()) {
+        std::cerr << "Failed to read chunk directory" << std::endl;
+        entries_.clear();
+        return false;
+    }
+    hash_index_.build(entries_.span());
+    return true;
+}
+
+bool ChunkDirectory::open_lazy(const PositionalFile& file, const AssetHeader& header) {
+    const uint64_t directory_bytes = uint64_t(header.chunk_count) * sizeof(ChunkDirectoryEntry);
+    if (header.index_chunk > header.chunk_count || directory_bytes > file.size() - sizeof(AssetHeader)) {
+        return false;
+    }
+    entries_.reset(&file, sizeof(AssetHeader), header.chunk_count, DIRECTORY_PAGE_ENTRIES);
+
+    const ChunkDirectoryEntry* index_entry = entries_.get(header.index_chunk - 1);
+    if (!index_entry || index_entry->type != ChunkType::INDX || index_entry->codec != ChunkCodec::None ||
+        index_entry->offset > file.size() || index_entry->size > file.size() - index_entry->offset) {
+        return false;
+    }
+
+    ChunkIndexTable table;
+    if (index_entry->size < sizeof(table) || !file.read_at(index_entry->offset, &table, sizeof(table)) ||
+        std::memcmp(table.magic, "CIDX", 4) != 0 || table.version != ChunkIndexTable::VERSION ||
+        table.entry_count != header.chunk_count) {
+        return false;
+    }
+    const uint64_t types_bytes = uint64_t(table.type_count) * sizeof(ChunkIndexTable::TypeEntry);
+    const uint64_t boot_bytes = uint64_t(table.boot_count) * sizeof(uint32_t);
+    const uint64_t names_offset = sizeof(table) + types_bytes + boot_bytes;
+    if (names_offset + uint64_t(table.entry_count) * sizeof(ChunkIndexTable::NameEntry) != index_entry->size) {
+        return false;
+    }
+
+    // Type table and Boot list in one read; the name table stays on disk
+    std::vector<uint8_t> head(static_cast<size_t>(types_bytes + boot_bytes));
+    if (!file.read_at(index_entry->offset + sizeof(table), head.data(), head.size())) {
+        return false;
+    }
+    types_.resize(table.type_count);
+    boot_chunks_.resize(table.boot_count);
+    std::memcpy(types_.data(), head.data(), static_cast<size_t>(types_bytes));
+    std::memcpy(boot_chunks_.data(), head.data() + types_bytes, static_cast<size_t>(boot_bytes));
+    for (const uint32_t index : boot_chunks_) {
+        if (index >= header.chunk_count) {
+            return false;
+        }
+    }
+
+    names_.reset(&file, index_entry->offset + names_offset, table.entry_count, NAME_PAGE_ENTRIES);
+    lazy_ = true;
+    return true;
+}
+
+void ChunkDirectory::clear() {
+    entries_.clear();
+    names_.clear();
+    hash_index_.clear();
+    types_.clear();
+    boot_chunks_.clear();
+    lazy_ = false;
+}
+
+std::span<const ChunkDirectoryEntry> ChunkDirectory::entries() const {
+    if (!entries_.load_all()) {
+        std::cerr << "Failed to read chunk directory" << std::endl;
+        return {};
+    }
+    return entries_.span();
+}
+
+int ChunkDirectory::find(ChunkType type) const {
+    if (!lazy_) {
+        return hash_index_.find(entries_.span(), type);
+    }
+    auto it = std::lower_bound(types_.begin(), types_.end(), type, [](const auto& entry, ChunkType value) {
+        return static_cast<uint32_t>(entry.type) < static_cast<uint32_t>(value);
+    });
+    if (it == types_.end() || it->type != type || it->first_index >= size()) {
+        return -1;
+    }
+    return static_cast<int>(it->first_index);
+}
+
+int ChunkDirectory::find(const char* name, size_t length) const {
+    if (!lazy_) {
+        return hash_index_.find(entries_.span(), name, length);
+    }
+    if (length >= sizeof(ChunkDirectoryEntry::name)) {
+        return -1;
+    }
+
+    // Lower bound of the hash; the upper levels of the search hit the same
+    // few pages every time, so they stay resident
+    const uint64_t hash = fnv1a_hash(name, length);
+    uint32_t low = 0;
+    uint32_t high = names_.size();
+    while (low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        const auto* probe = names_.get(mid);
+        if (!probe) {
+            return -1;
+        }
+        if (probe->name_hash < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    // Equal hashes are ordered by directory index, so the first match wins
+    for (; low < names_.size(); ++low) {
+        const auto* candidate = names_.get(low);
+        if (!candidate || candidate->name_hash != hash) {
+            break;
+        }
+        const ChunkDirectoryEntry* entry = entries_.get(candidate->index);
+        if (entry && ::strnlen(entry->name, sizeof(entry->name)) == length &&
+            std::memcmp(entry->name, name, length) == 0) {
+            return static_cast<int>(candidate->index);
+        }
+    }
+    return -1;
+}
+
+ResidencySpan ChunkDirectory::residency_span(ResidencyClass residency) const {
+    if (!lazy_ || residency != ResidencyClass::Boot) {
+        return Taffy::residency_span(entries(), residency);
+    }
+
+    std::vector<ChunkDirectoryEntry> members;
+    members.reserve(boot_chunks_.size());
+    for (const uint32_t index : boot_chunks_) {
+        const ChunkDirectoryEntry* entry = entries_.get(index);
+        if (!entry) {
+            return {};
+        }
+        members.push_back(*entry);
+    }
+    ResidencySpan span = Taffy::residency_span(members, residency);
+    for (auto& index : span.chunks) {
+        index = boot_chunks_[index];
+    }
+    return span;
+}
+
+void ChunkDirectory::for_each_resident(
+    const std::function<void(uint32_t index, const ChunkDirectoryEntry& entry)>& visit) const {
+    for (uint32_t i = 0; i < entries_.size(); ++i) {
+        if (entries_.is_resident(i)) {
+            visit(i, *entries_.get(i));
+        }
+    }
+}
+
+size_t ChunkDirectory::resident_entries() const {
+    size_t count = 0;
+    for (uint32_t i = 0; i < entries_.size(); ++i) {
+        count += entries_.is_resident(i) ? 1 : 0;
+    }
+    return count;
+}
+
+} // namespace Taffy
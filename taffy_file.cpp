@@ -0,0 +1,181 @@
+#include "include/taffy_file.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Taffy {
+
+PositionalFile::~PositionalFile() {
+    close();
+}
+
+PositionalFile::PositionalFile(PositionalFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+PositionalFile& PositionalFile::operator=(PositionalFile&& other) noexcept {
+    if (this != &other) {
+        close();
+#ifdef _WIN32
+        handle_ = std::exchange(other.handle_, nullptr);
+#else
+        fd_ = std::exchange(other.fd_, -1);
+#endif
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+bool PositionalFile::open(const std::filesystem::path& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+    handle_ = file;
+    size_ = static_cast<uint64_t>(file_size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    size_ = static_cast<uint64_t>(st.st_size);
+#endif
+    return true;
+}
+
+void PositionalFile::close() {
+#ifdef _WIN32
+    if (handle_) {
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = nullptr;
+    }
+#else
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+    size_ = 0;
+}
+
+bool PositionalFile::read_at(uint64_t offset, void* buffer, size_t length) const {
+    if (!is_open() || offset > size_ || length > size_ - offset) {
+        return false;
+    }
+
+    auto* out = static_cast<uint8_t*>(buffer);
+    while (length > 0) {
+#ifdef _WIN32
+        const DWORD request = static_cast<DWORD>(std::min<size_t>(length, 1u << 30));
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD read = 0;
+        if (!ReadFile(static_cast<HANDLE>(handle_), out, request, &read, &overlapped) || read == 0) {
+            return false;
+        }
+#else
+        const ssize_t read = ::pread(fd_, out, std::min<size_t>(length, 1u << 30), static_cast<off_t>(offset));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            return false;
+        }
+#endif
+        out += read;
+        offset += static_cast<uint64_t>(read);
+        length -= static_cast<size_t>(read);
+    }
+    return true;
+}
+
+bool sync_file(const std::filesystem::path& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    const bool flushed = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+    return flushed;
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    int result;
+    do {
+        result = ::fsync(fd);
+    } while (result != 0 && errno == EINTR);
+    ::close(fd);
+    return result == 0;
+#endif
+}
+
+bool sync_directory(const std::filesystem::path& directory) {
+#ifdef _WIN32
+    (void)directory;
+    return true;
+#else
+    const std::filesystem::path target = directory.empty() ? std::filesystem::path(".") : directory;
+    int fd = ::open(target.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    int result;
+    do {
+        result = ::fsync(fd);
+    } while (result != 0 && errno == EINTR);
+    ::close(fd);
+    return result == 0;
+#endif
+}
+
+bool drop_file_cache(const std::filesystem::path& path) {
+#if defined(_WIN32) || !defined(POSIX_FADV_DONTNEED)
+    (void)path;
+    return false;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    // DONTNEED skips dirty pages, so write them back first
+    int result;
+    do {
+        result = ::fdatasync(fd);
+    } while (result != 0 && errno == EINTR);
+    if (result == 0) {
+        result = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+    ::close(fd);
+    return result == 0;
+#endif
+}
+
+} // namespace Taffy
@@ -0,0 +1,344 @@
+#include "include/taffy_io_backend.h"
+#include <algorithm>
+#include <vector>
+
+#ifdef HAS_IO_URING
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Taffy {
+
+const char* read_backend_name(ReadBackendKind kind) {
+    switch (kind) {
+        case ReadBackendKind::Auto: return "auto";
+        case ReadBackendKind::Pread: return "pread";
+        case ReadBackendKind::IoUring: return "io_uring";
+    }
+    return "unknown";
+}
+
+namespace {
+
+class PreadBackend : public ReadBackend {
+public:
+    ReadBackendKind kind() const override { return ReadBackendKind::Pread; }
+
+    void read_batch(const PositionalFile& file, std::span<ReadRequest> requests) override {
+        for (auto& request : requests) {
+            request.ok = file.read_at(request.offset, request.buffer, request.length);
+        }
+    }
+};
+
+#ifdef HAS_IO_URING
+
+// Minimal io_uring ring driven through the raw syscalls, so there is no
+// liburing dependency. Reads go straight into the callers' buffers.
+class IoUringBackend : public ReadBackend {
+public:
+    static std::unique_ptr<IoUringBackend> create(unsigned queue_depth) {
+        auto backend = std::unique_ptr<IoUringBackend>(new IoUringBackend());
+        if (!backend->setup(std::max(queue_depth, 1u))) {
+            return nullptr;
+        }
+        return backend;
+    }
+
+    ~IoUringBackend() override {
+        if (sqes_) {
+            munmap(sqes_, sqes_bytes_);
+        }
+        if (cq_ring_ && cq_ring_ != sq_ring_) {
+            munmap(cq_ring_, cq_ring_bytes_);
+        }
+        if (sq_ring_) {
+            munmap(sq_ring_, sq_ring_bytes_);
+        }
+        if (ring_fd_ >= 0) {
+            ::close(ring_fd_);
+        }
+    }
+
+    ReadBackendKind kind() const override { return ReadBackendKind::IoUring; }
+
+    void read_batch(const PositionalFile& file, std::span<ReadRequest> requests) override {
+        if (broken_) {
+            read_synchronously(file, requests, {}, {});
+            return;
+        }
+
+        // Bytes completed per request; short reads are resubmitted for the rest
+        std::vector<size_t> done(requests.size(), 0);
+        std::vector<uint8_t> finished(requests.size(), 0);
+        std::vector<uint32_t> queue;
+        queue.reserve(requests.size());
+        for (uint32_t i = 0; i < requests.size(); ++i) {
+            requests[i].ok = false;
+            if (requests[i].length == 0) {
+                requests[i].ok = true;
+                finished[i] = 1;
+            } else if (!file.is_open() || requests[i].offset > file.size() ||
+                       requests[i].length > file.size() - requests[i].offset) {
+                finished[i] = 1;
+            } else {
+                queue.push_back(i);
+            }
+        }
+
+        // Record one completion; false if the request needs another read
+        auto complete = [&](const io_uring_cqe& cqe) {
+            const uint32_t i = static_cast<uint32_t>(cqe.user_data);
+            ReadRequest& request = requests[i];
+            if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                return false;
+            }
+            if (cqe.res < 0) {
+                // e.g. -EINVAL on kernels without IORING_OP_READ
+                request.ok = file.read_at(request.offset + done[i],
+                                          static_cast<uint8_t*>(request.buffer) + done[i],
+                                          request.length - done[i]);
+            } else if (cqe.res == 0) {
+                request.ok = false;     // Unexpected end of file
+            } else {
+                done[i] += static_cast<size_t>(cqe.res);
+                if (done[i] < request.length) {
+                    return false;
+                }
+                request.ok = true;
+            }
+            finished[i] = 1;
+            return true;
+        };
+
+        size_t next = 0;
+        unsigned in_flight = 0;
+        while (next < queue.size() || in_flight > 0) {
+            unsigned to_submit = 0;
+            while (next < queue.size() && in_flight + to_submit < sq_entries_) {
+                const uint32_t i = queue[next++];
+                push_read(file.native_handle(), requests[i], done[i], i);
+                ++to_submit;
+            }
+
+            unsigned submitted = 0;
+            if (!enter(to_submit, 1, submitted)) {
+                // Ring unusable. Take back what the kernel never saw, wait for
+                // every read it owns to land in the callers' buffers, then
+                // finish the rest synchronously.
+                broken_ = true;
+                retract_unsubmitted();
+                in_flight += submitted;
+                drain(in_flight, [&](const io_uring_cqe& cqe) { complete(cqe); });
+                read_synchronously(file, requests, done, finished);
+                return;
+            }
+            in_flight += to_submit;
+
+            // Reap every completion that is ready
+            reap([&](const io_uring_cqe& cqe) {
+                --in_flight;
+                if (!complete(cqe)) {
+                    queue.push_back(static_cast<uint32_t>(cqe.user_data));
+                }
+            });
+        }
+    }
+
+private:
+    IoUringBackend() = default;
+
+    bool setup(unsigned queue_depth) {
+        io_uring_params params{};
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+        if (ring_fd_ < 0) {
+            return false;
+        }
+
+        sq_ring_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_bytes_ = cq_ring_bytes_ = std::max(sq_ring_bytes_, cq_ring_bytes_);
+        }
+
+        sq_ring_ = map(sq_ring_bytes_, IORING_OFF_SQ_RING);
+        if (!sq_ring_) {
+            return false;
+        }
+        cq_ring_ = single_mmap ? sq_ring_ : map(cq_ring_bytes_, IORING_OFF_CQ_RING);
+        if (!cq_ring_) {
+            return false;
+        }
+        sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_bytes_, IORING_OFF_SQES));
+        if (!sqes_) {
+            return false;
+        }
+
+        auto* sq = static_cast<uint8_t*>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+
+        auto* cq = static_cast<uint8_t*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void* map(size_t bytes, uint64_t offset) {
+        void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring_fd_, static_cast<off_t>(offset));
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    void push_read(int fd, const ReadRequest& request, size_t done, uint32_t user_data) {
+        // We are the only submitter, so the tail is ours to read relaxed
+        const unsigned tail = std::atomic_ref<unsigned>(*sq_tail_).load(std::memory_order_relaxed);
+        const unsigned slot = tail & *sq_mask_;
+        io_uring_sqe& sqe = sqes_[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.off = request.offset + done;
+        sqe.addr = reinterpret_cast<uint64_t>(static_cast<uint8_t*>(request.buffer) + done);
+        sqe.len = static_cast<uint32_t>(std::min<size_t>(request.length - done, 1u << 30));
+        sqe.user_data = user_data;
+        sq_array_[slot] = slot;
+        std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+    }
+
+    // `submitted` counts the SQEs the kernel took, also when this fails
+    bool enter(unsigned to_submit, unsigned min_complete, unsigned& submitted) {
+        submitted = 0;
+        while (to_submit > 0 || min_complete > 0) {
+            const long result = syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete,
+                                        IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            if (result == 0 && to_submit > 0) {
+                return false;
+            }
+            const unsigned taken = std::min<unsigned>(to_submit, static_cast<unsigned>(result));
+            submitted += taken;
+            to_submit -= taken;
+            min_complete = 0;
+        }
+        return true;
+    }
+
+    template <typename Handler>
+    unsigned reap(Handler&& handler) {
+        unsigned head = std::atomic_ref<unsigned>(*cq_head_).load(std::memory_order_relaxed);
+        const unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        unsigned count = 0;
+        for (; head != tail; ++head, ++count) {
+            handler(cqes_[head & *cq_mask_]);
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+        return count;
+    }
+
+    // Drop queued SQEs the kernel has not consumed; nothing submits them
+    // afterwards because the ring is marked broken
+    void retract_unsubmitted() {
+        const unsigned head = std::atomic_ref<unsigned>(*sq_head_).load(std::memory_order_acquire);
+        std::atomic_ref<unsigned>(*sq_tail_).store(head, std::memory_order_release);
+    }
+
+    // Wait until all `in_flight` reads completed. The kernel posts
+    // completions without io_uring_enter, so poll if waiting fails too.
+    template <typename Handler>
+    void drain(unsigned in_flight, Handler&& handler) {
+        while (in_flight > 0) {
+            in_flight -= std::min(in_flight, reap(handler));
+            if (in_flight == 0) {
+                break;
+            }
+            if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR) {
+                sched_yield();
+            }
+        }
+    }
+
+    // Finish requests that are not `finished` with positional reads, from
+    // the `done` bytes on (all requests when both are empty)
+    static void read_synchronously(const PositionalFile& file, std::span<ReadRequest> requests,
+                                   std::span<const size_t> done, std::span<const uint8_t> finished) {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            ReadRequest& request = requests[i];
+            if (!finished.empty() && finished[i]) {
+                continue;
+            }
+            const size_t skip = done.empty() ? 0 : done[i];
+            request.ok = file.read_at(request.offset + skip, static_cast<uint8_t*>(request.buffer) + skip,
+                                      request.length - skip);
+        }
+    }
+
+    int ring_fd_ = -1;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    size_t sq_ring_bytes_ = 0;
+    size_t cq_ring_bytes_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_bytes_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_entries_ = 0;
+
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    bool broken_ = false;       // A failed io_uring_enter; only positional reads from then on
+};
+
+#endif // HAS_IO_URING
+
+} // namespace
+
+bool io_uring_available() {
+#ifdef HAS_IO_URING
+    static const bool available = IoUringBackend::create(1) != nullptr;
+    return available;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<ReadBackend> create_read_backend(ReadBackendKind preferred, unsigned queue_depth) {
+#ifdef HAS_IO_URING
+    if (preferred != ReadBackendKind::Pread) {
+        if (auto ring = IoUringBackend::create(queue_depth)) {
+            return ring;
+        }
+    }
+#else
+    (void)preferred;
+    (void)queue_depth;
+#endif
+    return std::make_unique<PreadBackend>();
+}
+
+} // namespace Taffy
@@ -0,0 +1,107 @@
+#include "include/taffy_layout.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace Taffy {
+
+namespace {
+
+// MANF, BOOT and DEPS lead the file regardless of their class
+int mountPriority(ChunkType type) {
+    switch (type) {
+    case ChunkType::MANF: return 0;
+    case ChunkType::BOOT: return 1;
+    case ChunkType::DEPS: return 2;
+    default: return 3;
+    }
+}
+
+} // namespace
+
+ResidencyClass default_residency(ChunkType type) {
+    switch (type) {
+    case ChunkType::MANF:
+    case ChunkType::BOOT:
+    case ChunkType::DEPS:
+        return ResidencyClass::Boot;
+    case ChunkType::AUDI:
+    case ChunkType::TXTR:
+    case ChunkType::INDX:           // Read a page at a time, never cached whole
+        return ResidencyClass::Streamed;
+    default:
+        return ResidencyClass::Resident;
+    }
+}
+
+ResidencyClass chunk_residency(const ChunkDirectoryEntry& entry) {
+    return entry.residency == ResidencyClass::Unspecified ? default_residency(entry.type) : entry.residency;
+}
+
+const char* residency_class_name(ResidencyClass residency) {
+    switch (residency) {
+    case ResidencyClass::Unspecified: return "unspecified";
+    case ResidencyClass::Boot: return "boot";
+    case ResidencyClass::Resident: return "resident";
+    case ResidencyClass::Streamed: return "streamed";
+    case ResidencyClass::Debug: return "debug";
+    }
+    return "unknown";
+}
+
+std::vector<size_t> plan_chunk_layout(std::span<const ChunkDirectoryEntry> directory) {
+    struct Key {
+        int priority;
+        ResidencyClass residency;
+        size_t anchor;      // First directory index of the chunk's group
+        size_t index;
+    };
+
+    std::vector<Key> keys;
+    keys.reserve(directory.size());
+    std::unordered_map<uint64_t, size_t> group_anchors;
+    for (size_t i = 0; i < directory.size(); ++i) {
+        const auto& entry = directory[i];
+        const ResidencyClass residency = chunk_residency(entry);
+        size_t anchor = i;
+        if (entry.group != 0) {
+            const uint64_t group_key = (uint64_t(residency) << 32) | entry.group;
+            anchor = group_anchors.try_emplace(group_key, i).first->second;
+        }
+        keys.push_back({ mountPriority(entry.type), residency, anchor, i });
+    }
+
+    std::sort(keys.begin(), keys.end(), [](const Key& a, const Key& b) {
+        if (a.priority != b.priority) return a.priority < b.priority;
+        if (a.residency != b.residency) return a.residency < b.residency;
+        if (a.anchor != b.anchor) return a.anchor < b.anchor;
+        return a.index < b.index;
+    });
+
+    std::vector<size_t> order;
+    order.reserve(keys.size());
+    for (const auto& key : keys) {
+        order.push_back(key.index);
+    }
+    return order;
+}
+
+ResidencySpan residency_span(std::span<const ChunkDirectoryEntry> directory, ResidencyClass residency) {
+    ResidencySpan span;
+    uint64_t end = 0;
+    for (size_t i = 0; i < directory.size(); ++i) {
+        const auto& entry = directory[i];
+        if (chunk_residency(entry) != residency) {
+            continue;
+        }
+        if (span.chunks.empty() || entry.offset < span.offset) {
+            span.offset = entry.offset;
+        }
+        end = std::max(end, entry.offset + entry.size);
+        span.payload_bytes += entry.size;
+        span.chunks.push_back(static_cast<uint32_t>(i));
+    }
+    span.size = span.chunks.empty() ? 0 : end - span.offset;
+    return span;
+}
+
+} // namespace Taffy
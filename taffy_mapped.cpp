@@ -0,0 +1,334 @@
+#include "include/taffy_mapped.h"
+#include "include/taffy_codec.h"
+#include "include/asset.h"
+#include <iostream>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Taffy {
+
+MappedAsset::~MappedAsset() {
+    close();
+}
+
+MappedAsset::MappedAsset(MappedAsset&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedAsset& MappedAsset::operator=(MappedAsset&& other) noexcept {
+    if (this != &other) {
+        close();
+        base_ = std::exchange(other.base_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        header_ = other.header_;
+        directory_ = std::exchange(other.directory_, nullptr);
+        chunk_count_ = std::exchange(other.chunk_count_, 0);
+        chunk_index_ = std::move(other.chunk_index_);
+#ifdef _WIN32
+        file_handle_ = std::exchange(other.file_handle_, nullptr);
+        mapping_handle_ = std::exchange(other.mapping_handle_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool MappedAsset::open(const std::filesystem::path& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "❌ Failed to open file for mapping: " << path << std::endl;
+        return false;
+    }
+    file_handle_ = file;
+
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        std::cerr << "❌ Cannot map empty or unreadable file: " << path << std::endl;
+        release_mapping();
+        return false;
+    }
+    size_ = static_cast<uint64_t>(file_size.QuadPart);
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        std::cerr << "❌ CreateFileMapping failed for: " << path << std::endl;
+        release_mapping();
+        return false;
+    }
+    mapping_handle_ = mapping;
+
+    base_ = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!base_) {
+        std::cerr << "❌ MapViewOfFile failed for: " << path << std::endl;
+        release_mapping();
+        return false;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "❌ Failed to open file for mapping: " << path << std::endl;
+        return false;
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        std::cerr << "❌ Cannot map empty or unreadable file: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<uint64_t>(st.st_size);
+
+    void* mapped = ::mmap(nullptr, static_cast<size_t>(size_), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference to the file
+    if (mapped == MAP_FAILED) {
+        std::cerr << "❌ mmap failed for: " << path << std::endl;
+        size_ = 0;
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(mapped);
+#endif
+
+    // Validate header
+    if (size_ < sizeof(AssetHeader)) {
+        std::cerr << "❌ File too small for asset header: " << path << std::endl;
+        close();
+        return false;
+    }
+    std::memcpy(&header_, base_, sizeof(AssetHeader));
+
+    if (std::strncmp(header_.magic, "TAF!", 4) != 0 &&
+        std::strncmp(header_.magic, "TAFO", 4) != 0) {
+        std::cerr << "❌ Invalid asset magic: " << std::string(header_.magic, 4) << std::endl;
+        close();
+        return false;
+    }
+
+    // Validate that the directory fits inside the file
+    const uint64_t directory_capacity = (size_ - sizeof(AssetHeader)) / sizeof(ChunkDirectoryEntry);
+    if (header_.chunk_count > directory_capacity) {
+        std::cerr << "❌ Chunk directory (" << header_.chunk_count
+                  << " entries) extends beyond file: " << path << std::endl;
+        close();
+        return false;
+    }
+    directory_ = reinterpret_cast<const ChunkDirectoryEntry*>(base_ + sizeof(AssetHeader));
+    chunk_count_ = header_.chunk_count;
+
+    // Validate every payload range without touching payload pages
+    for (size_t i = 0; i < chunk_count_; ++i) {
+        const auto& entry = directory_[i];
+        if (entry.offset > size_ || entry.size > size_ - entry.offset) {
+            std::cerr << "❌ Chunk " << i << " extends beyond file! Offset: " << entry.offset
+                      << ", Size: " << entry.size
+                      << ", File size: " << size_ << std::endl;
+            close();
+            return false;
+        }
+        if (entry.alignment_log2 > MAX_CHUNK_ALIGNMENT_LOG2 || entry.offset % Taffy::chunk_alignment(entry) != 0) {
+            std::cerr << "❌ Chunk " << i << " offset " << entry.offset
+                      << " does not honour its recorded alignment (log2 "
+                      << static_cast<int>(entry.alignment_log2) << ")" << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    chunk_index_.build(get_chunk_directory());
+    return true;
+}
+
+void MappedAsset::close() {
+    release_mapping();
+    size_ = 0;
+    directory_ = nullptr;
+    chunk_count_ = 0;
+    chunk_index_.clear();
+    header_ = AssetHeader{};
+}
+
+void MappedAsset::release_mapping() {
+#ifdef _WIN32
+    if (base_) {
+        UnmapViewOfFile(base_);
+    }
+    if (mapping_handle_) {
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+        mapping_handle_ = nullptr;
+    }
+    if (file_handle_) {
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+        file_handle_ = nullptr;
+    }
+#else
+    if (base_) {
+        ::munmap(const_cast<uint8_t*>(base_), static_cast<size_t>(size_));
+    }
+#endif
+    base_ = nullptr;
+}
+
+std::optional<size_t> MappedAsset::find_chunk(ChunkType type) const {
+    const int index = chunk_index_.find(get_chunk_directory(), type);
+    if (index < 0) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(index);
+}
+
+std::optional<size_t> MappedAsset::find_chunk(const std::string& name) const {
+    const int index = chunk_index_.find(get_chunk_directory(), name);
+    if (index < 0) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(index);
+}
+
+bool MappedAsset::has_chunk(ChunkType type) const {
+    return find_chunk(type).has_value();
+}
+
+bool MappedAsset::has_chunk_named(const std::string& name) const {
+    return find_chunk(name).has_value();
+}
+
+std::optional<ChunkDirectoryEntry> MappedAsset::get_chunk_entry(ChunkType type) const {
+    if (auto index = find_chunk(type)) {
+        return directory_[*index];
+    }
+    return std::nullopt;
+}
+
+std::optional<ChunkDirectoryEntry> MappedAsset::get_chunk_entry(const std::string& name) const {
+    if (auto index = find_chunk(name)) {
+        return directory_[*index];
+    }
+    return std::nullopt;
+}
+
+std::span<const uint8_t> MappedAsset::stored_chunk(size_t index) const {
+    if (index >= chunk_count_) {
+        return {};
+    }
+    const auto& entry = directory_[index];
+    return { base_ + entry.offset, static_cast<size_t>(entry.size) };
+}
+
+bool MappedAsset::is_compressed(size_t index) const {
+    return index < chunk_count_ && directory_[index].codec != ChunkCodec::None;
+}
+
+std::span<const uint8_t> MappedAsset::view_chunk(size_t index) const {
+    if (is_compressed(index)) {
+        return {};
+    }
+    return stored_chunk(index);
+}
+
+std::optional<std::span<const uint8_t>> MappedAsset::view_chunk(ChunkType type) const {
+    if (auto index = find_chunk(type); index && !is_compressed(*index)) {
+        return view_chunk(*index);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::span<const uint8_t>> MappedAsset::view_chunk(const std::string& name) const {
+    if (auto index = find_chunk(name); index && !is_compressed(*index)) {
+        return view_chunk(*index);
+    }
+    return std::nullopt;
+}
+
+size_t MappedAsset::chunk_alignment(size_t index) const {
+    if (index >= chunk_count_) {
+        return 0;
+    }
+    // The recorded alignment is relative to the file; the mapping base is
+    // page aligned, so cap it by the alignment of the actual pointer
+    const uintptr_t address = reinterpret_cast<uintptr_t>(base_ + directory_[index].offset);
+    const size_t pointer_alignment = address == 0 ? 0 : static_cast<size_t>(address & (~address + 1));
+    return std::min<size_t>(static_cast<size_t>(Taffy::chunk_alignment(directory_[index])), pointer_alignment);
+}
+
+std::optional<std::span<const uint8_t>> MappedAsset::view_chunk_aligned(ChunkType type, size_t alignment) const {
+    auto index = find_chunk(type);
+    if (!index || is_compressed(*index)) {
+        return std::nullopt;
+    }
+    if (chunk_alignment(*index) < alignment) {
+        std::cerr << "❌ Chunk " << directory_[*index].name << " is " << chunk_alignment(*index)
+                  << "-byte aligned, " << alignment << " required" << std::endl;
+        return std::nullopt;
+    }
+    return view_chunk(*index);
+}
+
+bool MappedAsset::read_chunk(size_t index, std::vector<uint8_t>& out) const {
+    if (index >= chunk_count_) {
+        return false;
+    }
+    if (!decode_chunk_payload(directory_[index], stored_chunk(index), out)) {
+        std::cerr << "❌ Failed to decompress chunk: " << directory_[index].name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MappedAsset::verify_chunk(size_t index) const {
+    if (index >= chunk_count_) {
+        return false;
+    }
+    auto data = stored_chunk(index);
+    return Asset::calculate_crc32(data.data(), data.size()) == directory_[index].checksum;
+}
+
+bool MappedAsset::verify_checksums() const {
+    bool all_valid = true;
+    for (size_t i = 0; i < chunk_count_; ++i) {
+        if (!verify_chunk(i)) {
+            std::cerr << "❌ Checksum mismatch for chunk: " << directory_[i].name << std::endl;
+            all_valid = false;
+        }
+    }
+    return all_valid;
+}
+
+bool MappedAsset::copy_to_asset(Asset& asset) const {
+    if (!is_open()) {
+        std::cerr << "❌ No mapped asset to copy from" << std::endl;
+        return false;
+    }
+    if (!verify_checksums()) {
+        return false;
+    }
+
+    asset.header_ = header_;
+    asset.chunk_directory_.assign(directory_, directory_ + chunk_count_);
+    asset.chunk_data_.clear();
+    asset.chunk_data_.reserve(chunk_count_);
+    for (size_t i = 0; i < chunk_count_; ++i) {
+        auto& data = asset.chunk_data_.emplace_back();
+        if (!read_chunk(i, data)) {
+            return false;
+        }
+        if (is_compressed(i)) {
+            asset.refresh_chunk_entry(i);
+            asset.chunk_directory_[i].uncompressed_size = 0;
+        }
+    }
+    asset.chunk_index_ = chunk_index_;
+    return true;
+}
+
+} // namespace Taffy
@@ -0,0 +1,344 @@
+#include "include/taffy_mesh_optimize.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace Taffy {
+
+namespace {
+
+// FIFO cache modelled with timestamps: a vertex is resident while fewer than
+// cache_size misses happened since it was loaded
+class FifoCache {
+public:
+    FifoCache(size_t vertex_count, uint32_t cache_size)
+        : loaded_(vertex_count, 0), size_(cache_size), clock_(cache_size + 1) {}
+
+    // Misses for one triangle
+    uint32_t access(const uint32_t* triangle) {
+        uint32_t misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            if (clock_ - loaded_[triangle[k]] > size_) {
+                loaded_[triangle[k]] = clock_++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+    void clear() { clock_ += size_ + 1; }
+
+private:
+    std::vector<uint64_t> loaded_;
+    uint64_t size_;
+    uint64_t clock_;
+};
+
+// Vertex -> triangles, in one array
+struct Adjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    Adjacency(std::span<const uint32_t> indices, size_t vertex_count) : offsets(vertex_count + 1, 0) {
+        for (const uint32_t index : indices) {
+            offsets[index + 1]++;
+        }
+        for (size_t v = 0; v < vertex_count; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        triangles.resize(indices.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::span<const uint32_t> of(uint32_t vertex) const {
+        return { triangles.data() + offsets[vertex], offsets[vertex + 1] - offsets[vertex] };
+    }
+};
+
+} // namespace
+
+VertexCacheStats analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size) {
+    VertexCacheStats stats;
+    stats.triangles = indices.size() / 3;
+    FifoCache cache(vertex_count, cache_size);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        stats.transformed += cache.access(&indices[i]);
+    }
+
+    std::vector<uint8_t> seen(vertex_count, 0);
+    for (const uint32_t index : indices) {
+        stats.unique_vertices += seen[index] ? 0 : 1;
+        seen[index] = 1;
+    }
+    if (stats.triangles > 0) {
+        stats.acmr = double(stats.transformed) / double(stats.triangles);
+    }
+    if (stats.unique_vertices > 0) {
+        stats.atvr = double(stats.transformed) / double(stats.unique_vertices);
+    }
+    return stats;
+}
+
+void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count, uint32_t cache_size) {
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+    const Adjacency adjacency(indices, vertex_count);
+
+    std::vector<uint32_t> live(vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        live[v] = static_cast<uint32_t>(adjacency.of(static_cast<uint32_t>(v)).size());
+    }
+    std::vector<uint64_t> cache_time(vertex_count, 0);
+    std::vector<uint8_t> emitted(triangle_count, 0);
+    std::vector<uint32_t> dead_end;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    uint64_t time = cache_size + 1;
+    size_t cursor = 0;
+
+    // Dead end: the most recent vertex that still has triangles, else the
+    // next one in index order
+    auto skip_dead_end = [&]() -> int64_t {
+        while (!dead_end.empty()) {
+            const uint32_t vertex = dead_end.back();
+            dead_end.pop_back();
+            if (live[vertex] > 0) {
+                return vertex;
+            }
+        }
+        for (; cursor < vertex_count; ++cursor) {
+            if (live[cursor] > 0) {
+                return static_cast<int64_t>(cursor);
+            }
+        }
+        return -1;
+    };
+
+    int64_t fan = skip_dead_end();
+    while (fan >= 0) {
+        candidates.clear();
+        for (const uint32_t t : adjacency.of(static_cast<uint32_t>(fan))) {
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = 1;
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t vertex = indices[size_t(t) * 3 + k];
+                output.push_back(vertex);
+                dead_end.push_back(vertex);
+                candidates.push_back(vertex);
+                live[vertex]--;
+                if (time - cache_time[vertex] > cache_size) {
+                    cache_time[vertex] = time++;
+                }
+            }
+        }
+
+        // Next fan: the candidate that will still be cached after its
+        // remaining triangles are emitted, the oldest such one first
+        int64_t best = -1;
+        int64_t best_priority = -1;
+        for (const uint32_t vertex : candidates) {
+            if (live[vertex] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - cache_time[vertex] + 2 * uint64_t(live[vertex]) <= cache_size) {
+                priority = static_cast<int64_t>(time - cache_time[vertex]);
+            }
+            if (priority > best_priority) {
+                best = vertex;
+                best_priority = priority;
+            }
+        }
+        fan = best >= 0 ? best : skip_dead_end();
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimize_overdraw(std::span<uint32_t> indices, std::span<const float> positions, size_t stride,
+                       float threshold, uint32_t cache_size) {
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count < 2 || stride < 3 || positions.size() < 3) {
+        return;
+    }
+    const size_t vertex_count = (positions.size() - 3) / stride + 1;
+    FifoCache cache(vertex_count, cache_size);
+
+    // Hard boundaries: triangles that miss on every vertex start a new cluster
+    std::vector<size_t> hard;
+    for (size_t t = 0; t < triangle_count; ++t) {
+        if (cache.access(&indices[t * 3]) == 3) {
+            hard.push_back(t);
+        }
+    }
+    if (hard.empty() || hard.front() != 0) {
+        hard.insert(hard.begin(), 0);
+    }
+    hard.push_back(triangle_count);
+
+    // Soft boundaries: cut a cluster as soon as its running ACMR is within
+    // `threshold` of the whole cluster's, so sorting costs little locality
+    std::vector<size_t> clusters;
+    for (size_t h = 0; h + 1 < hard.size(); ++h) {
+        const size_t begin = hard[h];
+        const size_t end = hard[h + 1];
+        cache.clear();
+        size_t cluster_misses = 0;
+        for (size_t t = begin; t < end; ++t) {
+            cluster_misses += cache.access(&indices[t * 3]);
+        }
+        const double target = threshold * double(cluster_misses) / double(end - begin);
+
+        cache.clear();
+        clusters.push_back(begin);
+        size_t misses = 0;
+        size_t faces = 0;
+        for (size_t t = begin; t < end; ++t) {
+            misses += cache.access(&indices[t * 3]);
+            faces++;
+            if (double(misses) / double(faces) <= target && t + 1 < end) {
+                clusters.push_back(t + 1);
+                cache.clear();
+                misses = faces = 0;
+            }
+        }
+    }
+    clusters.push_back(triangle_count);
+
+    auto position = [&](uint32_t vertex) {
+        const float* p = positions.data() + size_t(vertex) * stride;
+        return std::array<double, 3>{ p[0], p[1], p[2] };
+    };
+
+    // Mesh center from the referenced vertices
+    std::array<double, 3> mesh_center{};
+    for (const uint32_t index : indices) {
+        const auto p = position(index);
+        for (int k = 0; k < 3; ++k) {
+            mesh_center[k] += p[k];
+        }
+    }
+    for (double& c : mesh_center) {
+        c /= double(indices.size());
+    }
+
+    // Clusters that face away from the center are in front of the rest from
+    // most directions, so they draw first
+    struct Cluster {
+        size_t begin;
+        size_t end;
+        double key;
+    };
+    std::vector<Cluster> order;
+    order.reserve(clusters.size() - 1);
+    for (size_t c = 0; c + 1 < clusters.size(); ++c) {
+        std::array<double, 3> centroid{};
+        std::array<double, 3> normal{};
+        double area = 0.0;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const auto p0 = position(indices[t * 3]);
+            const auto p1 = position(indices[t * 3 + 1]);
+            const auto p2 = position(indices[t * 3 + 2]);
+            const std::array<double, 3> e1{ p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            const std::array<double, 3> e2{ p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            const std::array<double, 3> n{ e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                                           e1[0] * e2[1] - e1[1] * e2[0] };
+            const double a = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int k = 0; k < 3; ++k) {
+                centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0 * a;
+                normal[k] += n[k];
+            }
+            area += a;
+        }
+        double key = 0.0;
+        const double normal_length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (area > 0.0 && normal_length > 0.0) {
+            for (int k = 0; k < 3; ++k) {
+                key += (centroid[k] / area - mesh_center[k]) * normal[k] / normal_length;
+            }
+        }
+        order.push_back({ clusters[c], clusters[c + 1], key });
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (const Cluster& cluster : order) {
+        output.insert(output.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+std::vector<uint32_t> vertex_fetch_remap(std::span<const uint32_t> indices, size_t vertex_count) {
+    constexpr uint32_t UNASSIGNED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertex_count, UNASSIGNED);
+    uint32_t next = 0;
+    for (const uint32_t index : indices) {
+        if (remap[index] == UNASSIGNED) {
+            remap[index] = next++;
+        }
+    }
+    for (auto& slot : remap) {
+        if (slot == UNASSIGNED) {
+            slot = next++;
+        }
+    }
+    return remap;
+}
+
+void remap_indices(std::span<uint32_t> indices, std::span<const uint32_t> remap) {
+    for (auto& index : indices) {
+        index = remap[index];
+    }
+}
+
+void remap_vertices(std::span<uint8_t> vertices, size_t stride, std::span<const uint32_t> remap) {
+    const std::vector<uint8_t> source(vertices.begin(), vertices.end());
+    for (size_t v = 0; v < remap.size(); ++v) {
+        std::memcpy(vertices.data() + size_t(remap[v]) * stride, source.data() + v * stride, stride);
+    }
+}
+
+bool optimize_mesh(std::span<uint32_t> indices, std::span<uint8_t> vertices, size_t vertex_stride,
+                   std::span<const float> positions, size_t position_stride, MeshOptimizeReport& report) {
+    report = {};
+    if (vertex_stride == 0 || position_stride < 3) {
+        return false;
+    }
+    const size_t vertex_count = vertices.size() / vertex_stride;
+    if (positions.size() < (vertex_count ? (vertex_count - 1) * position_stride + 3 : 0)) {
+        std::cerr << "❌ Mesh optimization needs a position for every vertex" << std::endl;
+        return false;
+    }
+    for (const uint32_t index : indices) {
+        if (index >= vertex_count) {
+            std::cerr << "❌ Index " << index << " is out of range (" << vertex_count << " vertices)" << std::endl;
+            return false;
+        }
+    }
+
+    const std::span<uint32_t> triangles = indices.first(indices.size() - indices.size() % 3);
+    report.before = analyze_vertex_cache(triangles, vertex_count);
+    optimize_vertex_cache(triangles, vertex_count);
+    optimize_overdraw(triangles, positions, position_stride);
+
+    const std::vector<uint32_t> remap = vertex_fetch_remap(triangles, vertex_count);
+    remap_indices(indices, remap);
+    remap_vertices(vertices, vertex_stride, remap);
+    report.after = analyze_vertex_cache(triangles, vertex_count);
+    return true;
+}
+
+} // namespace Taffy
@@ -0,0 +1,573 @@
+#include "include/taffy_meshlet.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace Taffy {
+
+namespace {
+
+struct Float3 {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+
+    Float3 operator+(const Float3& o) const { return { x + o.x, y + o.y, z + o.z }; }
+    Float3 operator-(const Float3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+    Float3 operator*(float s) const { return { x * s, y * s, z * s }; }
+};
+
+float dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+float length(const Float3& v) { return std::sqrt(dot(v, v)); }
+
+Float3 cross(const Float3& a, const Float3& b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+Float3 normalize(const Float3& v) {
+    const float len = length(v);
+    return len > 0.0f ? v * (1.0f / len) : Float3{};
+}
+
+Float3 position(std::span<const float> positions, size_t stride, uint32_t vertex) {
+    const float* p = positions.data() + size_t(vertex) * stride;
+    return { p[0], p[1], p[2] };
+}
+
+// Unit normal, or zero for a degenerate triangle
+Float3 triangle_normal(const Float3& a, const Float3& b, const Float3& c) {
+    return normalize(cross(b - a, c - a));
+}
+
+// Interleave the low 10 bits of v with two zero bits each
+uint32_t spread_bits(uint32_t v) {
+    v &= 0x3FFu;
+    v = (v | (v << 16)) & 0x030000FFu;
+    v = (v | (v << 8)) & 0x0300F00Fu;
+    v = (v | (v << 4)) & 0x030C30C3u;
+    v = (v | (v << 2)) & 0x09249249u;
+    return v;
+}
+
+constexpr uint16_t NOT_IN_MESHLET = 0xFFFF;
+
+// Appends meshlets to a MeshletSet, tracking which mesh vertices the open
+// meshlet already holds
+class MeshletWriter {
+public:
+    MeshletWriter(MeshletSet& set, size_t vertex_count) : set_(set), local_(vertex_count, NOT_IN_MESHLET) {
+        open();
+    }
+
+    uint32_t vertex_count() const { return static_cast<uint32_t>(set_.vertex_indices.size()) - current_.vertex_offset; }
+    uint32_t primitive_count() const { return current_.primitive_count; }
+    bool empty() const { return current_.primitive_count == 0; }
+
+    std::span<const uint32_t> vertices() const {
+        return { set_.vertex_indices.data() + current_.vertex_offset, vertex_count() };
+    }
+
+    // Vertices the triangle would add
+    uint32_t new_vertices(uint32_t a, uint32_t b, uint32_t c) const {
+        return (local_[a] == NOT_IN_MESHLET) + (local_[b] == NOT_IN_MESHLET && b != a) +
+               (local_[c] == NOT_IN_MESHLET && c != a && c != b);
+    }
+
+    void add(uint32_t a, uint32_t b, uint32_t c) {
+        for (const uint32_t vertex : { a, b, c }) {
+            if (local_[vertex] == NOT_IN_MESHLET) {
+                local_[vertex] = static_cast<uint16_t>(vertex_count());
+                set_.vertex_indices.push_back(vertex);
+            }
+            set_.primitive_indices.push_back(local_[vertex]);
+        }
+        current_.primitive_count++;
+    }
+
+    void flush() {
+        if (empty()) {
+            return;
+        }
+        for (const uint32_t vertex : vertices()) {
+            local_[vertex] = NOT_IN_MESHLET;
+        }
+        current_.vertex_count = vertex_count();
+        set_.meshlets.push_back(current_);
+        open();
+    }
+
+private:
+    void open() {
+        current_ = {};
+        current_.vertex_offset = static_cast<uint32_t>(set_.vertex_indices.size());
+        current_.primitive_offset = static_cast<uint32_t>(set_.primitive_indices.size());
+    }
+
+    MeshletSet& set_;
+    std::vector<uint16_t> local_;
+    MeshletDesc current_{};
+};
+
+} // namespace
+
+uint32_t MeshletSet::geometry_flags() const {
+    if (meshlets.empty()) {
+        return 0;
+    }
+    uint32_t flags = GeometryChunk::MeshletData;
+    if (bounds.size() == meshlets.size()) {
+        flags |= GeometryChunk::MeshletBoundsData;
+    }
+    if (packed_primitives) {
+        flags |= GeometryChunk::MeshletPackedPrimitives;
+    }
+    return flags;
+}
+
+std::vector<uint8_t> MeshletSet::serialize() const {
+    const uint32_t flags = geometry_flags();
+    const bool with_bounds = (flags & GeometryChunk::MeshletBoundsData) != 0;
+    const size_t desc_bytes = meshlets.size() * sizeof(MeshletDesc);
+    const size_t vertex_bytes = vertex_indices.size() * sizeof(uint32_t);
+    const size_t primitive_bytes = meshlet_primitive_bytes(primitive_indices.size(), flags);
+    const size_t bounds_bytes = with_bounds ? bounds.size() * sizeof(MeshletBounds) : 0;
+
+    // Zero-filled, so the padding after packed indices is deterministic
+    std::vector<uint8_t> block(desc_bytes + vertex_bytes + primitive_bytes + bounds_bytes);
+    size_t offset = 0;
+    auto append = [&](const void* data, size_t size) {
+        if (size > 0) {
+            std::memcpy(block.data() + offset, data, size);
+            offset += size;
+        }
+    };
+    append(meshlets.data(), desc_bytes);
+    append(vertex_indices.data(), vertex_bytes);
+    if (flags & GeometryChunk::MeshletPackedPrimitives) {
+        for (size_t i = 0; i < primitive_indices.size(); ++i) {
+            block[offset + i] = static_cast<uint8_t>(primitive_indices[i]);
+        }
+        offset += primitive_bytes;
+    } else {
+        append(primitive_indices.data(), primitive_bytes);
+    }
+    append(bounds.data(), bounds_bytes);
+    return block;
+}
+
+size_t meshlet_primitive_bytes(size_t primitive_index_count, uint32_t flags) {
+    if (flags & GeometryChunk::MeshletPackedPrimitives) {
+        return (primitive_index_count + 3) & ~size_t(3);
+    }
+    return primitive_index_count * sizeof(uint32_t);
+}
+
+bool read_meshlet_block(const GeometryChunk& geometry, std::span<const uint8_t> block, MeshletBlockView& view) {
+    view = {};
+    if (!(geometry.ms_flags & GeometryChunk::MeshletData)) {
+        return false;
+    }
+    const size_t meshlet_count = geometry.reserved[0];
+    const size_t vertex_index_count = geometry.reserved[1];
+    const size_t desc_bytes = meshlet_count * sizeof(MeshletDesc);
+    const size_t vertex_bytes = vertex_index_count * sizeof(uint32_t);
+    if (desc_bytes + vertex_bytes > block.size()) {
+        return false;
+    }
+
+    // The primitive index count is implied by the descriptors
+    view.meshlets = { reinterpret_cast<const MeshletDesc*>(block.data()), meshlet_count };
+    size_t primitive_index_count = 0;
+    for (const MeshletDesc& desc : view.meshlets) {
+        if (uint64_t(desc.vertex_offset) + desc.vertex_count > vertex_index_count) {
+            return false;
+        }
+        primitive_index_count = std::max<size_t>(primitive_index_count,
+                                                 size_t(desc.primitive_offset) + size_t(desc.primitive_count) * 3);
+    }
+    const size_t primitive_bytes = meshlet_primitive_bytes(primitive_index_count, geometry.ms_flags);
+    const bool with_bounds = (geometry.ms_flags & GeometryChunk::MeshletBoundsData) != 0;
+    const size_t bounds_bytes = with_bounds ? meshlet_count * sizeof(MeshletBounds) : 0;
+    if (desc_bytes + vertex_bytes + primitive_bytes + bounds_bytes > block.size()) {
+        return false;
+    }
+
+    view.vertex_indices = { reinterpret_cast<const uint32_t*>(block.data() + desc_bytes), vertex_index_count };
+    view.primitive_data = block.data() + desc_bytes + vertex_bytes;
+    view.primitive_index_count = primitive_index_count;
+    view.packed_primitives = (geometry.ms_flags & GeometryChunk::MeshletPackedPrimitives) != 0;
+    if (with_bounds) {
+        view.bounds = { reinterpret_cast<const MeshletBounds*>(view.primitive_data + primitive_bytes), meshlet_count };
+    }
+    return true;
+}
+
+MeshletSet MeshletBuilder::build(std::span<const uint32_t> indices, std::span<const float> positions,
+                                 size_t stride) const {
+    if (options_.max_vertices < 3 || options_.max_vertices > 256 ||
+        options_.max_primitives < 1 || options_.max_primitives > 256) {
+        std::cerr << "❌ Meshlet limits must be 3-256 vertices and 1-256 primitives" << std::endl;
+        return {};
+    }
+    if (indices.size() % 3 != 0 || stride < 3) {
+        std::cerr << "❌ Meshlets need a triangle list and xyz positions" << std::endl;
+        return {};
+    }
+    const size_t vertex_count = positions.size() < 3 ? 0 : (positions.size() - 3) / stride + 1;
+    for (const uint32_t index : indices) {
+        if (index >= vertex_count) {
+            std::cerr << "❌ Meshlet index " << index << " is out of range (" << vertex_count
+                      << " vertices)" << std::endl;
+            return {};
+        }
+    }
+
+    MeshletSet set;
+    set.packed_primitives = options_.packed_primitives;
+    set.vertex_indices.reserve(indices.size() / 2);
+    set.primitive_indices.reserve(indices.size());
+    if (options_.strategy == Strategy::Sequential) {
+        build_sequential(indices, vertex_count, set);
+    } else {
+        build_locality(indices, positions, stride, vertex_count, set);
+    }
+
+    if (options_.compute_bounds) {
+        set.bounds.reserve(set.meshlets.size());
+        for (size_t i = 0; i < set.meshlets.size(); ++i) {
+            set.bounds.push_back(compute_bounds(set, i, positions, stride));
+        }
+    }
+    return set;
+}
+
+void MeshletBuilder::build_sequential(std::span<const uint32_t> indices, size_t vertex_count,
+                                      MeshletSet& set) const {
+    MeshletWriter writer(set, vertex_count);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (!writer.empty() && (writer.vertex_count() + writer.new_vertices(a, b, c) > options_.max_vertices ||
+                                writer.primitive_count() + 1 > options_.max_primitives)) {
+            writer.flush();
+        }
+        writer.add(a, b, c);
+    }
+    writer.flush();
+}
+
+void MeshletBuilder::build_locality(std::span<const uint32_t> indices, std::span<const float> positions,
+                                    size_t stride, size_t vertex_count, MeshletSet& set) const {
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    // Vertex -> triangles that still need a meshlet. live[v] is the length of
+    // v's list; emitted triangles are swapped past the end.
+    std::vector<uint32_t> live(vertex_count, 0);
+    for (const uint32_t index : indices) {
+        live[index]++;
+    }
+    std::vector<uint32_t> adjacency_offset(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        adjacency_offset[v + 1] = adjacency_offset[v] + live[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacency_offset.begin(), adjacency_offset.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<Float3> centroids(triangle_count);
+    std::vector<Float3> normals(triangle_count);
+    Float3 lower{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                  std::numeric_limits<float>::max() };
+    Float3 upper = lower * -1.0f;
+    double total_area = 0.0;
+    for (size_t t = 0; t < triangle_count; ++t) {
+        const Float3 p0 = position(positions, stride, indices[t * 3]);
+        const Float3 p1 = position(positions, stride, indices[t * 3 + 1]);
+        const Float3 p2 = position(positions, stride, indices[t * 3 + 2]);
+        const Float3 n = cross(p1 - p0, p2 - p0);
+        total_area += 0.5 * length(n);
+        normals[t] = normalize(n);
+        centroids[t] = (p0 + p1 + p2) * (1.0f / 3.0f);
+        lower = { std::min(lower.x, centroids[t].x), std::min(lower.y, centroids[t].y), std::min(lower.z, centroids[t].z) };
+        upper = { std::max(upper.x, centroids[t].x), std::max(upper.y, centroids[t].y), std::max(upper.z, centroids[t].z) };
+    }
+
+    // Radius of a disc covering one full meshlet of average triangles
+    float expected_radius = static_cast<float>(
+        std::sqrt(total_area / triangle_count * options_.max_primitives / 3.14159265358979323846));
+    if (!(expected_radius > 0.0f)) {
+        expected_radius = 1.0f;
+    }
+
+    // Triangles in Morton order of their centroids: the fallback when a
+    // meshlet runs out of neighbours
+    std::vector<uint32_t> morton(triangle_count);
+    {
+        const Float3 extent = upper - lower;
+        const float scale = 1023.0f / std::max({ extent.x, extent.y, extent.z, 1e-20f });
+        std::vector<std::pair<uint32_t, uint32_t>> keyed(triangle_count);
+        for (size_t t = 0; t < triangle_count; ++t) {
+            const Float3 p = (centroids[t] - lower) * scale;
+            const uint32_t code = spread_bits(static_cast<uint32_t>(p.x)) |
+                                  (spread_bits(static_cast<uint32_t>(p.y)) << 1) |
+                                  (spread_bits(static_cast<uint32_t>(p.z)) << 2);
+            keyed[t] = { code, static_cast<uint32_t>(t) };
+        }
+        std::sort(keyed.begin(), keyed.end());
+        for (size_t i = 0; i < triangle_count; ++i) {
+            morton[i] = keyed[i].second;
+        }
+    }
+    size_t morton_cursor = 0;
+
+    std::vector<uint8_t> emitted(triangle_count, 0);
+    MeshletWriter writer(set, vertex_count);
+    Float3 center_sum{};
+    Float3 normal_sum{};
+    std::vector<uint32_t> previous_vertices;
+
+    auto emit = [&](uint32_t t) {
+        const uint32_t* tri = &indices[size_t(t) * 3];
+        writer.add(tri[0], tri[1], tri[2]);
+        emitted[t] = 1;
+        center_sum = center_sum + centroids[t];
+        normal_sum = normal_sum + normals[t];
+        for (int k = 0; k < 3; ++k) {
+            uint32_t* list = &adjacency[adjacency_offset[tri[k]]];
+            uint32_t& count = live[tri[k]];
+            for (uint32_t i = 0; i < count; ++i) {
+                if (list[i] == t) {
+                    list[i] = list[--count];
+                    break;
+                }
+            }
+        }
+    };
+
+    auto next_in_morton_order = [&]() -> int64_t {
+        while (morton_cursor < triangle_count && emitted[morton[morton_cursor]]) {
+            ++morton_cursor;
+        }
+        return morton_cursor < triangle_count ? int64_t(morton[morton_cursor]) : -1;
+    };
+
+    // Start next to the previous meshlet, on the triangle with the fewest
+    // remaining neighbours, so the unassigned region stays compact
+    auto pick_seed = [&]() -> int64_t {
+        int64_t best = -1;
+        uint32_t best_live = std::numeric_limits<uint32_t>::max();
+        for (const uint32_t vertex : previous_vertices) {
+            const uint32_t* list = &adjacency[adjacency_offset[vertex]];
+            for (uint32_t i = 0; i < live[vertex]; ++i) {
+                const uint32_t* tri = &indices[size_t(list[i]) * 3];
+                const uint32_t neighbours = live[tri[0]] + live[tri[1]] + live[tri[2]];
+                if (neighbours < best_live) {
+                    best_live = neighbours;
+                    best = list[i];
+                }
+            }
+        }
+        return best >= 0 ? best : next_in_morton_order();
+    };
+
+    const float cone_weight = std::clamp(options_.cone_weight, 0.0f, 1.0f);
+    auto score = [&](uint32_t t) {
+        const float primitives = static_cast<float>(writer.primitive_count());
+        const float distance = length(centroids[t] - center_sum * (1.0f / primitives));
+        const float spread = dot(normalize(normal_sum), normals[t]);
+        const float cone = std::max(1.0f - spread * cone_weight, 1e-3f);
+        return (1.0f + distance / expected_radius * (1.0f - cone_weight)) * cone;
+    };
+
+    size_t remaining = triangle_count;
+    while (remaining > 0) {
+        const int64_t seed = pick_seed();
+        emit(static_cast<uint32_t>(seed));
+        --remaining;
+
+        while (remaining > 0 && writer.primitive_count() < options_.max_primitives) {
+            // Fewest new vertices first (a triangle that finishes off a vertex
+            // counts as free), then the best score
+            int64_t best = -1;
+            uint32_t best_extra = std::numeric_limits<uint32_t>::max();
+            float best_score = std::numeric_limits<float>::max();
+            for (const uint32_t vertex : writer.vertices()) {
+                const uint32_t* list = &adjacency[adjacency_offset[vertex]];
+                for (uint32_t i = 0; i < live[vertex]; ++i) {
+                    const uint32_t t = list[i];
+                    const uint32_t* tri = &indices[size_t(t) * 3];
+                    uint32_t extra = writer.new_vertices(tri[0], tri[1], tri[2]);
+                    if (writer.vertex_count() + extra > options_.max_vertices) {
+                        continue;
+                    }
+                    if (extra != 0 && (live[tri[0]] == 1 || live[tri[1]] == 1 || live[tri[2]] == 1)) {
+                        extra = 0;
+                    }
+                    extra++;
+                    if (extra > best_extra) {
+                        continue;
+                    }
+                    const float s = score(t);
+                    if (extra < best_extra || s < best_score) {
+                        best = t;
+                        best_extra = extra;
+                        best_score = s;
+                    }
+                }
+            }
+
+            // Frontier used up: take the next triangle in space if it is close
+            if (best < 0 && writer.vertex_count() + 3 <= options_.max_vertices) {
+                const int64_t next = next_in_morton_order();
+                const Float3 center = center_sum * (1.0f / static_cast<float>(writer.primitive_count()));
+                if (next >= 0 && length(centroids[next] - center) <= 2.0f * expected_radius) {
+                    best = next;
+                }
+            }
+            if (best < 0) {
+                break;
+            }
+            emit(static_cast<uint32_t>(best));
+            --remaining;
+        }
+
+        previous_vertices.assign(writer.vertices().begin(), writer.vertices().end());
+        writer.flush();
+        center_sum = {};
+        normal_sum = {};
+    }
+}
+
+MeshletBounds MeshletBuilder::compute_bounds(const MeshletSet& set, size_t meshlet,
+                                             std::span<const float> positions, size_t stride) {
+    MeshletBounds bounds{};
+    bounds.cone_cutoff = 1.0f;
+    if (meshlet >= set.meshlets.size() || set.meshlets[meshlet].vertex_count == 0) {
+        return bounds;
+    }
+    const MeshletDesc& desc = set.meshlets[meshlet];
+    auto vertex = [&](uint32_t local) {
+        return position(positions, stride, set.vertex_indices[desc.vertex_offset + local]);
+    };
+
+    // Ritter: span between two far-apart points, then grow to cover the rest
+    const Float3 first = vertex(0);
+    Float3 far_a = first;
+    for (uint32_t i = 1; i < desc.vertex_count; ++i) {
+        if (dot(vertex(i) - first, vertex(i) - first) > dot(far_a - first, far_a - first)) {
+            far_a = vertex(i);
+        }
+    }
+    Float3 far_b = far_a;
+    for (uint32_t i = 0; i < desc.vertex_count; ++i) {
+        if (dot(vertex(i) - far_a, vertex(i) - far_a) > dot(far_b - far_a, far_b - far_a)) {
+            far_b = vertex(i);
+        }
+    }
+    Float3 center = (far_a + far_b) * 0.5f;
+    float radius = length(far_b - far_a) * 0.5f;
+    for (uint32_t i = 0; i < desc.vertex_count; ++i) {
+        const float distance = length(vertex(i) - center);
+        if (distance > radius) {
+            const float grown = (radius + distance) * 0.5f;
+            center = center + (vertex(i) - center) * ((grown - radius) / distance);
+            radius = grown;
+        }
+    }
+    bounds.center[0] = center.x;
+    bounds.center[1] = center.y;
+    bounds.center[2] = center.z;
+    bounds.radius = radius;
+    bounds.cone_apex[0] = center.x;
+    bounds.cone_apex[1] = center.y;
+    bounds.cone_apex[2] = center.z;
+
+    // Normal cone: average facing and the widest deviation from it
+    std::vector<Float3> normals;
+    std::vector<Float3> corners;
+    normals.reserve(desc.primitive_count);
+    corners.reserve(desc.primitive_count);
+    Float3 normal_sum{};
+    for (uint32_t p = 0; p < desc.primitive_count; ++p) {
+        const uint32_t* local = &set.primitive_indices[desc.primitive_offset + p * 3];
+        const Float3 p0 = vertex(local[0]);
+        const Float3 n = triangle_normal(p0, vertex(local[1]), vertex(local[2]));
+        if (dot(n, n) > 0.0f) {
+            normals.push_back(n);
+            corners.push_back(p0);
+            normal_sum = normal_sum + n;
+        }
+    }
+    const Float3 axis = normalize(normal_sum);
+    if (normals.empty() || dot(axis, axis) == 0.0f) {
+        return bounds;
+    }
+    float min_dot = 1.0f;
+    for (const Float3& n : normals) {
+        min_dot = std::min(min_dot, dot(n, axis));
+    }
+    bounds.cone_axis[0] = axis.x;
+    bounds.cone_axis[1] = axis.y;
+    bounds.cone_axis[2] = axis.z;
+
+    // Cones wider than ~84 degrees would almost never cull
+    if (min_dot <= 0.1f) {
+        return bounds;
+    }
+    bounds.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+
+    // Apex on the axis behind every triangle plane
+    float max_t = 0.0f;
+    for (size_t i = 0; i < normals.size(); ++i) {
+        max_t = std::max(max_t, dot(center - corners[i], normals[i]) / dot(axis, normals[i]));
+    }
+    const Float3 apex = center - axis * max_t;
+    bounds.cone_apex[0] = apex.x;
+    bounds.cone_apex[1] = apex.y;
+    bounds.cone_apex[2] = apex.z;
+    return bounds;
+}
+
+MeshletStats MeshletBuilder::measure(const MeshletSet& set) const {
+    MeshletStats stats;
+    stats.meshlets = set.meshlets.size();
+    stats.meshlet_vertices = set.vertex_indices.size();
+    if (set.meshlets.empty()) {
+        return stats;
+    }
+
+    uint32_t highest = 0;
+    for (const uint32_t vertex : set.vertex_indices) {
+        highest = std::max(highest, vertex);
+    }
+    std::vector<uint8_t> seen(size_t(highest) + 1, 0);
+    for (const uint32_t vertex : set.vertex_indices) {
+        stats.unique_vertices += seen[vertex] ? 0 : 1;
+        seen[vertex] = 1;
+    }
+
+    for (const MeshletDesc& desc : set.meshlets) {
+        stats.triangles += desc.primitive_count;
+        stats.vertex_fill += double(desc.vertex_count) / options_.max_vertices;
+        stats.primitive_fill += double(desc.primitive_count) / options_.max_primitives;
+    }
+    stats.vertex_fill /= double(stats.meshlets);
+    stats.primitive_fill /= double(stats.meshlets);
+
+    if (!set.bounds.empty()) {
+        size_t cullable = 0;
+        for (const MeshletBounds& bounds : set.bounds) {
+            cullable += bounds.cone_cutoff < 1.0f ? 1 : 0;
+        }
+        stats.cullable = double(cullable) / double(set.bounds.size());
+    }
+    return stats;
+}
+
+} // namespace Taffy
@@ -0,0 +1,196 @@
+#include "include/taffy_mount.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+namespace Taffy {
+
+// =============================================================================
+// StreamingTaffyHandle
+// =============================================================================
+
+StreamingTaffyHandle::~StreamingTaffyHandle() {
+    reset();
+}
+
+StreamingTaffyHandle::StreamingTaffyHandle(StreamingTaffyHandle&& other) noexcept
+    : loader_(std::move(other.loader_)), path_(std::move(other.path_)), mount_id_(other.mount_id_) {
+    other.mount_id_ = 0;
+}
+
+StreamingTaffyHandle& StreamingTaffyHandle::operator=(StreamingTaffyHandle&& other) noexcept {
+    if (this != &other) {
+        reset();
+        loader_ = std::move(other.loader_);
+        path_ = std::move(other.path_);
+        mount_id_ = other.mount_id_;
+        other.mount_id_ = 0;
+    }
+    return *this;
+}
+
+void StreamingTaffyHandle::reset() {
+    if (loader_ && mount_id_ != 0) {
+        loader_.reset();
+        PackageMountManager::instance().release(path_, mount_id_);
+    }
+    loader_.reset();
+    path_.clear();
+    mount_id_ = 0;
+}
+
+// =============================================================================
+// PackageMountManager
+// =============================================================================
+
+PackageMountManager& PackageMountManager::instance() {
+    static PackageMountManager manager;
+    return manager;
+}
+
+std::string PackageMountManager::mountKey(const std::string& filepath) {
+    std::error_code ec;
+    auto canonical = std::filesystem::weakly_canonical(filepath, ec);
+    return ec ? filepath : canonical.string();
+}
+
+StreamingTaffyHandle PackageMountManager::mount(const std::string& filepath) {
+    const std::string key = mountKey(filepath);
+
+    std::promise<std::shared_ptr<StreamingTaffyLoader>> opening;
+    std::shared_future<std::shared_ptr<StreamingTaffyLoader>> pending;
+    uint64_t mount_id = 0;
+    bool first = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mounts_.find(key);
+        if (it == mounts_.end()) {
+            Mount mount;
+            mount.id = next_mount_id_++;
+            mount.loader = opening.get_future().share();
+            it = mounts_.emplace(key, std::move(mount)).first;
+            first = true;
+        }
+        it->second.refs++;
+        mount_id = it->second.id;
+        pending = it->second.loader;
+    }
+
+    if (first) {
+        // Open outside the lock; other mounts of this path wait on the future
+        auto loader = std::make_shared<StreamingTaffyLoader>();
+        if (!loader->open(key)) {
+            loader.reset();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (loader) {
+                // Queued before any handle can be released, so before its Unmounted
+                events_.push_back({ MountEvent::Mounted, key, loader });
+            } else {
+                auto it = mounts_.find(key);
+                if (it != mounts_.end() && it->second.id == mount_id) {
+                    mounts_.erase(it);
+                }
+            }
+        }
+        opening.set_value(loader);
+        if (loader) {
+            deliverEvents();
+        }
+    }
+
+    StreamingTaffyHandle handle;
+    handle.loader_ = pending.get();
+    if (!handle.loader_) {
+        std::cerr << "Failed to mount TAF package: " << filepath << std::endl;
+        return StreamingTaffyHandle();
+    }
+    handle.path_ = key;
+    handle.mount_id_ = mount_id;
+    return handle;
+}
+
+void PackageMountManager::release(const std::string& key, uint64_t mount_id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mounts_.find(key);
+        if (it == mounts_.end() || it->second.id != mount_id) {
+            return;
+        }
+        if (--it->second.refs > 0) {
+            return;
+        }
+        events_.push_back({ MountEvent::Unmounted, key, it->second.loader.get() });
+        mounts_.erase(it);
+    }
+
+    deliverEvents();
+    // The loader closes when the last shared reference (the queued event's,
+    // unless a listener or caller kept one) goes away
+}
+
+bool PackageMountManager::isMounted(const std::string& filepath) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mounts_.count(mountKey(filepath)) > 0;
+}
+
+size_t PackageMountManager::getRefCount(const std::string& filepath) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = mounts_.find(mountKey(filepath));
+    return it == mounts_.end() ? 0 : it->second.refs;
+}
+
+std::vector<std::string> PackageMountManager::getMountedPaths() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> paths;
+    paths.reserve(mounts_.size());
+    for (const auto& [key, mount] : mounts_) {
+        paths.push_back(key);
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+size_t PackageMountManager::addListener(MountListener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t id = next_listener_id_++;
+    listeners_.emplace_back(id, std::move(listener));
+    return id;
+}
+
+void PackageMountManager::removeListener(size_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                    [id](const auto& entry) { return entry.first == id; }),
+                     listeners_.end());
+}
+
+void PackageMountManager::deliverEvents() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (delivering_) {
+        // That thread delivers ours too, after the events queued before it
+        return;
+    }
+    delivering_ = true;
+    while (!events_.empty()) {
+        PendingEvent pending = std::move(events_.front());
+        events_.pop_front();
+        std::vector<MountListener> listeners;
+        listeners.reserve(listeners_.size());
+        for (const auto& [id, listener] : listeners_) {
+            listeners.push_back(listener);
+        }
+
+        // Listeners may mount or release; their events queue behind this one
+        lock.unlock();
+        for (const auto& listener : listeners) {
+            listener(pending.event, pending.key, pending.loader);
+        }
+        pending.loader.reset();
+        lock.lock();
+    }
+    delivering_ = false;
+}
+
+} // namespace Taffy
@@ -0,0 +1,193 @@
+#include "include/taffy_prefetch.h"
+#include <algorithm>
+
+namespace Taffy {
+
+namespace {
+
+ChunkFuture resolvedFuture(const ChunkBufferPtr& chunk) {
+    std::promise<ChunkBufferPtr> promise;
+    promise.set_value(chunk);
+    return promise.get_future().share();
+}
+
+} // namespace
+
+ChunkPrefetcher::ChunkPrefetcher(LoadFunction load, unsigned thread_count)
+    : ChunkPrefetcher(
+          [load = std::move(load)](std::span<const uint32_t> indices, std::span<ChunkBufferPtr> chunks) {
+              for (size_t i = 0; i < indices.size(); ++i) {
+                  chunks[i] = load(indices[i]);
+              }
+          },
+          thread_count, 1) {
+}
+
+ChunkPrefetcher::ChunkPrefetcher(BatchLoadFunction load, unsigned thread_count, size_t max_batch)
+    : load_(std::move(load)), max_batch_(std::max<size_t>(max_batch, 1)) {
+    if (thread_count == 0) {
+        thread_count = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+    }
+    workers_.reserve(thread_count);
+    for (unsigned i = 0; i < thread_count; ++i) {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+ChunkPrefetcher::~ChunkPrefetcher() {
+    stop();
+}
+
+void ChunkPrefetcher::complete(Request& request, const ChunkBufferPtr& chunk) {
+    // Callbacks first, so a caller waiting on the future sees them finished
+    for (auto& callback : request.callbacks) {
+        callback(request.index, chunk);
+    }
+    request.promise.set_value(chunk);
+}
+
+ChunkFuture ChunkPrefetcher::request(uint32_t index, PrefetchPriority priority, PrefetchCallback callback) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+        lock.unlock();
+        if (callback) {
+            callback(index, nullptr);
+        }
+        return resolvedFuture(nullptr);
+    }
+
+    auto it = pending_.find(index);
+    if (it != pending_.end()) {
+        auto& existing = it->second;
+        if (callback) {
+            existing->callbacks.push_back(std::move(callback));
+        }
+        // Promote a queued request; the stale heap entry is skipped later
+        if (!existing->in_flight && priority < existing->priority) {
+            existing->priority = priority;
+            queue_.push({ priority, next_sequence_++, existing });
+            work_available_.notify_one();
+        }
+        return existing->future;
+    }
+
+    auto request = std::make_shared<Request>();
+    request->index = index;
+    request->priority = priority;
+    request->future = request->promise.get_future().share();
+    if (callback) {
+        request->callbacks.push_back(std::move(callback));
+    }
+    pending_.emplace(index, request);
+    queue_.push({ priority, next_sequence_++, request });
+    work_available_.notify_one();
+    return request->future;
+}
+
+bool ChunkPrefetcher::cancel(uint32_t index) {
+    std::shared_ptr<Request> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(index);
+        if (it == pending_.end() || it->second->in_flight) {
+            return false;
+        }
+        cancelled = std::move(it->second);
+        pending_.erase(it);
+    }
+    complete(*cancelled, nullptr);
+    return true;
+}
+
+void ChunkPrefetcher::stop() {
+    std::vector<std::shared_ptr<Request>> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            if (!it->second->in_flight) {
+                cancelled.push_back(std::move(it->second));
+                it = pending_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        queue_ = {};
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    for (auto& request : cancelled) {
+        complete(*request, nullptr);
+    }
+}
+
+size_t ChunkPrefetcher::pending_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+void ChunkPrefetcher::worker_loop() {
+    std::vector<std::shared_ptr<Request>> batch;
+    std::vector<uint32_t> indices;
+    std::vector<ChunkBufferPtr> chunks;
+
+    for (;;) {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+
+            // Take the most urgent entries, never mixing priorities so urgent
+            // work does not wait behind a speculative batch
+            while (!queue_.empty() && batch.size() < max_batch_) {
+                const QueueEntry& top = queue_.top();
+                if (!batch.empty() && top.priority != batch.front()->priority) {
+                    break;
+                }
+                QueueEntry entry = top;
+                queue_.pop();
+
+                // Skip entries that were cancelled, promoted or already taken
+                auto it = pending_.find(entry.request->index);
+                if (it == pending_.end() || it->second != entry.request ||
+                    entry.request->in_flight || entry.priority != entry.request->priority) {
+                    continue;
+                }
+                entry.request->in_flight = true;
+                batch.push_back(std::move(entry.request));
+            }
+        }
+        if (batch.empty()) {
+            continue;
+        }
+
+        indices.clear();
+        for (const auto& request : batch) {
+            indices.push_back(request->index);
+        }
+        chunks.assign(batch.size(), nullptr);
+        load_(indices, chunks);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& request : batch) {
+                pending_.erase(request->index);
+            }
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            complete(*batch[i], chunks[i]);
+        }
+    }
+}
+
+} // namespace Taffy
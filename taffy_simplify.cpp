@@ -0,0 +1,598 @@
+#include "include/taffy_simplify.h"
+#include "include/taffy_mesh_optimize.h"
+#include "include/taffy_meshlet.h"
+#include "include/taffy_vertex_format.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+
+namespace Taffy {
+
+namespace {
+
+// Collapses may rotate a triangle by up to ~75 degrees
+constexpr double MAX_NORMAL_TURN_COS = 0.25;
+
+// ... and may not shrink its UV area below this fraction
+constexpr double MIN_UV_AREA_RATIO = 0.01;
+
+struct Vec3QHash {
+    size_t operator()(const Vec3Q& p) const {
+        return std::hash<uint64_t>()(p.x * 73856093ULL ^ p.y * 19349663ULL ^ p.z * 83492791ULL);
+    }
+};
+
+struct Vec3QEqual {
+    bool operator()(const Vec3Q& a, const Vec3Q& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+};
+
+void cross(const double a[3], const double b[3], double out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+void triangle_normal(const double* p0, const double* p1, const double* p2, double out[3]) {
+    const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    cross(e1, e2, out);
+}
+
+double dot(const double a[3], const double b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+float projection_scale(float viewport_height, float fov_y) {
+    return viewport_height / (2.0f * std::tan(fov_y * 0.5f));
+}
+
+} // namespace
+
+float lod_screen_error(float geometric_error, float distance, float viewport_height, float fov_y) {
+    if (distance <= 0.0f) {
+        return geometric_error > 0.0f ? std::numeric_limits<float>::infinity() : 0.0f;
+    }
+    return geometric_error * projection_scale(viewport_height, fov_y) / distance;
+}
+
+float lod_switch_distance(float geometric_error, float pixel_error, float viewport_height, float fov_y) {
+    if (pixel_error <= 0.0f) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return geometric_error * projection_scale(viewport_height, fov_y) / pixel_error;
+}
+
+uint32_t select_lod(std::span<const float> geometric_errors, float distance, float pixel_error,
+                    float viewport_height, float fov_y) {
+    uint32_t selected = 0;
+    for (uint32_t level = 0; level < geometric_errors.size(); ++level) {
+        if (lod_screen_error(geometric_errors[level], distance, viewport_height, fov_y) > pixel_error) {
+            break;
+        }
+        selected = level;
+    }
+    return selected;
+}
+
+bool read_geometry_lod(const GeometryChunk& geometry, std::span<const uint8_t> chunk, GeometryLodInfo& info) {
+    if (!(geometry.ms_flags & GeometryChunk::LodErrorData) ||
+        chunk.size() < sizeof(GeometryChunk) + sizeof(GeometryLodInfo)) {
+        return false;
+    }
+    std::memcpy(&info, chunk.data() + chunk.size() - sizeof(GeometryLodInfo), sizeof(info));
+    return true;
+}
+
+MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& other) {
+    a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+    b2 += other.b2; bc += other.bc; bd += other.bd;
+    c2 += other.c2; cd += other.cd;
+    d2 += other.d2;
+    return *this;
+}
+
+double MeshSimplifier::Quadric::evaluate(const double p[3]) const {
+    const double x = p[0], y = p[1], z = p[2];
+    const double error = a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x +
+                         b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y +
+                         c2 * z * z + 2.0 * cd * z +
+                         d2;
+    return std::max(error, 0.0);
+}
+
+MeshSimplifier::MeshSimplifier(std::span<const uint32_t> indices, std::span<const Vec3Q> positions,
+                               std::span<const float> uvs)
+    : triangles_(indices.begin(), indices.begin() + indices.size() / 3 * 3),
+      triangle_live_(indices.size() / 3, 1),
+      vertex_triangles_(positions.size()),
+      group_(positions.size()),
+      locked_(positions.size(), 0),
+      removed_(positions.size(), 0),
+      live_triangles_(indices.size() / 3) {
+    if (positions.empty()) {
+        return;
+    }
+    if (uvs.size() == positions.size() * 2) {
+        uvs_.assign(uvs.begin(), uvs.end());
+    }
+
+    // Weld by exact Vec3Q position; offsets from the first vertex keep full precision
+    std::unordered_map<Vec3Q, uint32_t, Vec3QHash, Vec3QEqual> welded;
+    const Vec3Q& origin = positions[0];
+    for (size_t v = 0; v < positions.size(); ++v) {
+        auto [it, inserted] = welded.try_emplace(positions[v], static_cast<uint32_t>(group_vertices_.size()));
+        if (inserted) {
+            const Vec3Q& p = positions[v];
+            group_vertices_.emplace_back();
+            group_position_.push_back({ double(int64_t(p.x - origin.x)) / 128000.0,
+                                        double(int64_t(p.y - origin.y)) / 128000.0,
+                                        double(int64_t(p.z - origin.z)) / 128000.0 });
+        }
+        group_[v] = it->second;
+        group_vertices_[it->second].push_back(static_cast<uint32_t>(v));
+    }
+    group_quadric_.assign(group_vertices_.size(), Quadric{});
+    group_version_.assign(group_vertices_.size(), 0);
+
+    // Plane quadrics, unweighted so errors stay in squared meters
+    for (size_t t = 0; t < triangle_live_.size(); ++t) {
+        const uint32_t* tri = &triangles_[t * 3];
+        if (same_group(tri[0], tri[1]) || same_group(tri[1], tri[2]) || same_group(tri[0], tri[2])) {
+            triangle_live_[t] = 0;      // Already degenerate
+            live_triangles_--;
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            vertex_triangles_[tri[k]].push_back(static_cast<uint32_t>(t));
+        }
+        const double* p0 = group_position_[group_[tri[0]]].data();
+        double n[3];
+        triangle_normal(p0, group_position_[group_[tri[1]]].data(), group_position_[group_[tri[2]]].data(), n);
+        const double length = std::sqrt(dot(n, n));
+        if (length == 0.0) {
+            continue;
+        }
+        n[0] /= length; n[1] /= length; n[2] /= length;
+        const double d = -dot(n, p0);
+        const Quadric plane{ n[0] * n[0], n[0] * n[1], n[0] * n[2], n[0] * d,
+                             n[1] * n[1], n[1] * n[2], n[1] * d,
+                             n[2] * n[2], n[2] * d,
+                             d * d };
+        for (int k = 0; k < 3; ++k) {
+            group_quadric_[group_[tri[k]]] += plane;
+        }
+    }
+
+    // Seams: more than one vertex at a position
+    for (size_t v = 0; v < positions.size(); ++v) {
+        locked_[v] = group_vertices_[group_[v]].size() > 1 ? 1 : 0;
+    }
+
+    // Borders and non-manifold edges, counted between welded positions
+    std::unordered_map<uint64_t, uint32_t> edge_use;
+    auto edge_key = [&](uint32_t a, uint32_t b) {
+        const uint64_t ga = group_[a], gb = group_[b];
+        return ga < gb ? (ga << 32) | gb : (gb << 32) | ga;
+    };
+    for (size_t i = 0; i < triangles_.size(); i += 3) {
+        if (!triangle_live_[i / 3]) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            edge_use[edge_key(triangles_[i + k], triangles_[i + (k + 1) % 3])]++;
+        }
+    }
+    for (size_t i = 0; i < triangles_.size(); i += 3) {
+        if (!triangle_live_[i / 3]) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t a = triangles_[i + k], b = triangles_[i + (k + 1) % 3];
+            if (edge_use[edge_key(a, b)] != 2) {
+                locked_[a] = locked_[b] = 1;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < triangles_.size(); i += 3) {
+        if (!triangle_live_[i / 3]) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            push_collapse(triangles_[i + k], triangles_[i + (k + 1) % 3]);
+            push_collapse(triangles_[i + (k + 1) % 3], triangles_[i + k]);
+        }
+    }
+}
+
+double MeshSimplifier::uv_area(uint32_t a, uint32_t b, uint32_t c) const {
+    const float* ua = &uvs_[a * 2];
+    const float* ub = &uvs_[b * 2];
+    const float* uc = &uvs_[c * 2];
+    return double(ub[0] - ua[0]) * double(uc[1] - ua[1]) - double(ub[1] - ua[1]) * double(uc[0] - ua[0]);
+}
+
+double MeshSimplifier::collapse_cost(uint32_t from, uint32_t to) const {
+    Quadric combined = group_quadric_[group_[from]];
+    combined += group_quadric_[group_[to]];
+    return combined.evaluate(group_position_[group_[to]].data());
+}
+
+void MeshSimplifier::push_collapse(uint32_t from, uint32_t to) {
+    if (locked_[from] || same_group(from, to)) {
+        return;
+    }
+    heap_.push_back({ collapse_cost(from, to), from, to, group_version_[group_[from]], group_version_[group_[to]] });
+    std::push_heap(heap_.begin(), heap_.end(), std::greater<>());
+}
+
+void MeshSimplifier::push_neighbourhood(uint32_t vertex) {
+    for (const uint32_t member : group_vertices_[group_[vertex]]) {
+        for (const uint32_t t : vertex_triangles_[member]) {
+            if (!triangle_live_[t]) {
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t other = triangles_[t * 3 + k];
+                if (other != member) {
+                    push_collapse(other, member);
+                    push_collapse(member, other);
+                }
+            }
+        }
+    }
+}
+
+bool MeshSimplifier::can_collapse(uint32_t from, uint32_t to) const {
+    // Link condition: the only positions next to both ends are the apexes of
+    // the triangles on the edge, otherwise the collapse pinches the surface
+    std::vector<uint32_t> from_ring;
+    size_t shared_triangles = 0;
+    for (const uint32_t t : vertex_triangles_[from]) {
+        if (!triangle_live_[t]) {
+            continue;
+        }
+        const uint32_t* tri = &triangles_[t * 3];
+        bool on_edge = false;
+        for (int k = 0; k < 3; ++k) {
+            on_edge = on_edge || same_group(tri[k], to);
+            if (tri[k] != from) {
+                from_ring.push_back(group_[tri[k]]);
+            }
+        }
+        shared_triangles += on_edge ? 1 : 0;
+    }
+    if (shared_triangles == 0) {
+        return false;
+    }
+    std::sort(from_ring.begin(), from_ring.end());
+    from_ring.erase(std::unique(from_ring.begin(), from_ring.end()), from_ring.end());
+
+    std::vector<uint32_t> to_ring;
+    for (const uint32_t member : group_vertices_[group_[to]]) {
+        for (const uint32_t t : vertex_triangles_[member]) {
+            if (!triangle_live_[t]) {
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                to_ring.push_back(group_[triangles_[t * 3 + k]]);
+            }
+        }
+    }
+    std::sort(to_ring.begin(), to_ring.end());
+    to_ring.erase(std::unique(to_ring.begin(), to_ring.end()), to_ring.end());
+
+    size_t common = 0;
+    for (const uint32_t g : from_ring) {
+        if (g != group_[to] && g != group_[from] && std::binary_search(to_ring.begin(), to_ring.end(), g)) {
+            common++;
+        }
+    }
+    if (common != shared_triangles) {
+        return false;
+    }
+
+    // No triangle that survives may flip or fold over
+    const double* target = group_position_[group_[to]].data();
+    for (const uint32_t t : vertex_triangles_[from]) {
+        if (!triangle_live_[t]) {
+            continue;
+        }
+        const uint32_t* tri = &triangles_[t * 3];
+        if (same_group(tri[0], to) || same_group(tri[1], to) || same_group(tri[2], to)) {
+            continue;
+        }
+        const double* before[3];
+        const double* after[3];
+        for (int k = 0; k < 3; ++k) {
+            before[k] = group_position_[group_[tri[k]]].data();
+            after[k] = tri[k] == from ? target : before[k];
+        }
+        double n0[3], n1[3];
+        triangle_normal(before[0], before[1], before[2], n0);
+        triangle_normal(after[0], after[1], after[2], n1);
+        const double turn = dot(n0, n1);
+        if (turn <= 0.0 || turn * turn < MAX_NORMAL_TURN_COS * MAX_NORMAL_TURN_COS * dot(n0, n0) * dot(n1, n1)) {
+            return false;
+        }
+
+        // Same test in texture space: `from` takes the UV of `to`
+        if (!uvs_.empty()) {
+            const uint32_t moved[3] = { tri[0] == from ? to : tri[0], tri[1] == from ? to : tri[1],
+                                        tri[2] == from ? to : tri[2] };
+            const double uv_before = uv_area(tri[0], tri[1], tri[2]);
+            const double uv_after = uv_area(moved[0], moved[1], moved[2]);
+            if (uv_before != 0.0 &&
+                (uv_before * uv_after <= 0.0 || std::fabs(uv_after) < MIN_UV_AREA_RATIO * std::fabs(uv_before))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void MeshSimplifier::apply_collapse(uint32_t from, uint32_t to) {
+    for (const uint32_t t : vertex_triangles_[from]) {
+        if (!triangle_live_[t]) {
+            continue;
+        }
+        uint32_t* tri = &triangles_[t * 3];
+        for (int k = 0; k < 3; ++k) {
+            tri[k] = tri[k] == from ? to : tri[k];
+        }
+        if (same_group(tri[0], tri[1]) || same_group(tri[1], tri[2]) || same_group(tri[0], tri[2])) {
+            triangle_live_[t] = 0;
+            live_triangles_--;
+        } else {
+            vertex_triangles_[to].push_back(t);
+        }
+    }
+    vertex_triangles_[from].clear();
+    removed_[from] = 1;
+
+    std::vector<uint32_t>& list = vertex_triangles_[to];
+    list.erase(std::remove_if(list.begin(), list.end(), [&](uint32_t t) { return !triangle_live_[t]; }), list.end());
+
+    group_quadric_[group_[to]] += group_quadric_[group_[from]];
+    group_version_[group_[to]]++;
+    push_neighbourhood(to);
+}
+
+size_t MeshSimplifier::simplify(size_t target_triangles, double max_error) {
+    const double max_cost = max_error * max_error;
+    while (live_triangles_ > target_triangles && !heap_.empty()) {
+        const Collapse collapse = heap_.front();
+        if (collapse.cost > max_cost) {
+            break;      // Costs only grow, so nothing cheaper is left
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<>());
+        heap_.pop_back();
+
+        if (removed_[collapse.from] || removed_[collapse.to] ||
+            collapse.from_version != group_version_[group_[collapse.from]] ||
+            collapse.to_version != group_version_[group_[collapse.to]] ||
+            !can_collapse(collapse.from, collapse.to)) {
+            continue;
+        }
+        apply_collapse(collapse.from, collapse.to);
+        error_ = std::max(error_, std::sqrt(collapse.cost));
+    }
+    return live_triangles_;
+}
+
+std::vector<uint32_t> MeshSimplifier::indices() const {
+    std::vector<uint32_t> result;
+    result.reserve(live_triangles_ * 3);
+    for (size_t t = 0; t < triangle_live_.size(); ++t) {
+        if (triangle_live_[t]) {
+            result.insert(result.end(), triangles_.begin() + t * 3, triangles_.begin() + t * 3 + 3);
+        }
+    }
+    return result;
+}
+
+std::vector<LodLevel> build_lod_chain(std::span<const uint32_t> indices, std::span<const Vec3Q> positions,
+                                      const LodChainOptions& options, std::span<const float> uvs) {
+    std::vector<LodLevel> chain(1);
+    chain[0].indices.assign(indices.begin(), indices.end());
+    if (options.max_levels <= 1) {
+        return chain;
+    }
+
+    MeshSimplifier simplifier(indices, positions, uvs);
+    size_t previous = indices.size() / 3;
+    while (chain.size() < options.max_levels) {
+        const size_t target = std::max(options.min_triangles, size_t(double(previous) * options.reduction));
+        if (target >= previous) {
+            break;
+        }
+        const size_t triangles = simplifier.simplify(target, options.max_error);
+        if (double(triangles) > double(previous) * options.min_reduction) {
+            break;
+        }
+
+        LodLevel level;
+        level.lod_level = static_cast<uint32_t>(chain.size());
+        level.indices = simplifier.indices();
+        level.geometric_error = static_cast<float>(simplifier.error());
+        level.lod_distance = lod_switch_distance(level.geometric_error, options.pixel_error);
+        chain.push_back(std::move(level));
+        previous = triangles;
+    }
+    return chain;
+}
+
+LodVertexLayout default_lod_vertex_layout(const GeometryChunk& geometry) {
+    LodVertexLayout layout;
+    if ((geometry.vertex_format & VertexFormat::Packed) != VertexFormat(0)) {
+        // Position16, OctNormal, Unorm8x4, Half2, OctTangent
+        layout.position_type = VertexAttribute::Position16;
+        layout.uv_type = VertexAttribute::Half2;
+        layout.uv_offset = 16;
+    } else if (geometry.vertex_stride == 76) {
+        layout.uv_offset = 52;
+    }
+    return layout;
+}
+
+bool build_geometry_lods(std::span<const uint8_t> chunk, const LodVertexLayout& layout,
+                         const LodChainOptions& options, std::vector<std::vector<uint8_t>>& lods) {
+    lods.clear();
+    GeometryChunk header;
+    if (chunk.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, chunk.data(), sizeof(header));
+    const size_t stride = header.vertex_stride;
+    const size_t vertex_bytes = size_t(header.vertex_count) * stride;
+    const size_t position_size = vertex_attribute_size(layout.position_type);
+    const size_t uv_size = layout.uv_offset < 0 ? 0 : vertex_attribute_size(layout.uv_type);
+    if (header.lod_level != 0 || (header.ms_flags & GeometryChunk::LodErrorData) ||
+        header.ms_primitive_type != GeometryChunk::Triangles || header.index_count % 3 != 0 || stride == 0 ||
+        (layout.position_type != VertexAttribute::Vec3Q && layout.position_type != VertexAttribute::Position16 &&
+         layout.position_type != VertexAttribute::Position32) ||
+        (uv_size != 0 && layout.uv_type != VertexAttribute::Float2 && layout.uv_type != VertexAttribute::Half2) ||
+        layout.position_offset + position_size > stride || size_t(std::max(layout.uv_offset, 0)) + uv_size > stride ||
+        vertex_bytes + size_t(header.index_count) * sizeof(uint32_t) > chunk.size() - sizeof(header)) {
+        return false;
+    }
+    const uint8_t* vertex_data = chunk.data() + sizeof(header);
+    std::vector<uint32_t> indices(header.index_count);
+    std::memcpy(indices.data(), vertex_data + vertex_bytes, indices.size() * sizeof(uint32_t));
+    if (std::any_of(indices.begin(), indices.end(), [&](uint32_t i) { return i >= header.vertex_count; })) {
+        return false;
+    }
+
+    // Vec3Q positions for the simplifier, float meters for meshlets and ordering
+    const PositionQuantizer quantizer(header.bounds_min, header.bounds_max);
+    if (layout.position_type == VertexAttribute::Position32 && !quantizer.fits32()) {
+        return false;
+    }
+    const uint64_t origin[3] = { header.bounds_min.x, header.bounds_min.y, header.bounds_min.z };
+    std::vector<Vec3Q> positions(header.vertex_count);
+    std::vector<float> uvs(uv_size ? header.vertex_count * 2 : 0);
+    for (size_t v = 0; v < header.vertex_count; ++v) {
+        const uint8_t* record = vertex_data + v * stride;
+        const uint8_t* position = record + layout.position_offset;
+        if (layout.position_type == VertexAttribute::Vec3Q) {
+            std::memcpy(&positions[v], position, sizeof(Vec3Q));
+        } else {
+            uint64_t units[3];
+            if (layout.position_type == VertexAttribute::Position16) {
+                uint16_t packed[3];
+                std::memcpy(packed, position, sizeof(packed));
+                for (int axis = 0; axis < 3; ++axis) {
+                    const double step = quantizer.step16_meters(axis) * PositionQuantizer::VEC3Q_UNITS_PER_METER;
+                    units[axis] = origin[axis] + uint64_t(std::llround(packed[axis] * step));
+                }
+            } else {
+                uint32_t packed[3];
+                std::memcpy(packed, position, sizeof(packed));
+                for (int axis = 0; axis < 3; ++axis) {
+                    units[axis] = origin[axis] + packed[axis];
+                }
+            }
+            positions[v].x = units[0];
+            positions[v].y = units[1];
+            positions[v].z = units[2];
+        }
+        if (uv_size) {
+            const uint8_t* uv = record + layout.uv_offset;
+            if (layout.uv_type == VertexAttribute::Float2) {
+                std::memcpy(&uvs[v * 2], uv, 2 * sizeof(float));
+            } else {
+                uint16_t halves[2];
+                std::memcpy(halves, uv, sizeof(halves));
+                uvs[v * 2] = half_to_float(halves[0]);
+                uvs[v * 2 + 1] = half_to_float(halves[1]);
+            }
+        }
+    }
+    std::vector<float> meters(header.vertex_count * 3);
+    for (size_t v = 0; v < positions.size(); ++v) {
+        const glm::vec3 p = positions[v].toFloat();
+        meters[v * 3] = p.x;
+        meters[v * 3 + 1] = p.y;
+        meters[v * 3 + 2] = p.z;
+    }
+
+    const std::vector<LodLevel> chain = build_lod_chain(indices, positions, options, uvs);
+    const uint32_t source_triangles = header.index_count / 3;
+
+    // LOD 0 keeps its payload; only the flag and the trailing info change
+    lods.emplace_back(chunk.begin(), chunk.end());
+    if (chain.size() == 1) {
+        return true;
+    }
+    GeometryChunk lod0_header = header;
+    lod0_header.ms_flags |= GeometryChunk::LodErrorData;
+    lod0_header.lod_distance = 0.0f;
+    std::memcpy(lods[0].data(), &lod0_header, sizeof(lod0_header));
+    const GeometryLodInfo lod0_info{ 0.0f, source_triangles, { 0u, 0u } };
+    const uint8_t* lod0_info_bytes = reinterpret_cast<const uint8_t*>(&lod0_info);
+    lods[0].insert(lods[0].end(), lod0_info_bytes, lod0_info_bytes + sizeof(lod0_info));
+
+    const bool meshlets = (header.ms_flags & GeometryChunk::MeshletData) != 0;
+    MeshletBuilder::Options meshlet_options;
+    if (header.ms_max_vertices > 0 && header.ms_max_vertices <= 256) {
+        meshlet_options.max_vertices = header.ms_max_vertices;
+    }
+    if (header.ms_max_primitives > 0 && header.ms_max_primitives <= 256) {
+        meshlet_options.max_primitives = header.ms_max_primitives;
+    }
+    meshlet_options.packed_primitives = (header.ms_flags & GeometryChunk::MeshletPackedPrimitives) != 0;
+    meshlet_options.compute_bounds = (header.ms_flags & GeometryChunk::MeshletBoundsData) != 0;
+
+    for (size_t level = 1; level < chain.size(); ++level) {
+        const LodLevel& lod = chain[level];
+        std::vector<uint32_t> lod_indices = lod.indices;
+        std::vector<uint8_t> lod_vertices(vertex_data, vertex_data + vertex_bytes);
+        std::vector<float> lod_meters = meters;
+
+        // Same ordering as LOD 0 meshes get, then drop the unreferenced tail
+        optimize_vertex_cache(lod_indices, header.vertex_count);
+        optimize_overdraw(lod_indices, lod_meters);
+        const std::vector<uint32_t> remap = vertex_fetch_remap(lod_indices, header.vertex_count);
+        remap_indices(lod_indices, remap);
+        remap_vertices(lod_vertices, stride, remap);
+        remap_vertices({ reinterpret_cast<uint8_t*>(lod_meters.data()), lod_meters.size() * sizeof(float) },
+                       3 * sizeof(float), remap);
+        const uint32_t vertex_count = *std::max_element(lod_indices.begin(), lod_indices.end()) + 1;
+        lod_vertices.resize(size_t(vertex_count) * stride);
+        lod_meters.resize(size_t(vertex_count) * 3);
+
+        GeometryChunk lod_header = header;
+        lod_header.vertex_count = vertex_count;
+        lod_header.index_count = static_cast<uint32_t>(lod_indices.size());
+        lod_header.lod_level = lod.lod_level;
+        lod_header.lod_distance = lod.lod_distance;
+        lod_header.ms_flags = GeometryChunk::LodErrorData;
+        lod_header.reserved[0] = lod_header.reserved[1] = 0;
+        std::vector<uint8_t> meshlet_data;
+        if (meshlets) {
+            const MeshletSet set = MeshletBuilder(meshlet_options).build(lod_indices, lod_meters);
+            meshlet_data = set.serialize();
+            lod_header.ms_flags |= set.geometry_flags();
+            lod_header.reserved[0] = static_cast<uint32_t>(set.meshlets.size());
+            lod_header.reserved[1] = static_cast<uint32_t>(set.vertex_indices.size());
+        }
+        const GeometryLodInfo lod_info{ lod.geometric_error, source_triangles, { 0u, 0u } };
+
+        std::vector<uint8_t>& out = lods.emplace_back();
+        out.reserve(sizeof(lod_header) + lod_vertices.size() + lod_indices.size() * sizeof(uint32_t) +
+                    meshlet_data.size() + sizeof(lod_info));
+        const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&lod_header);
+        const uint8_t* index_bytes = reinterpret_cast<const uint8_t*>(lod_indices.data());
+        const uint8_t* info_bytes = reinterpret_cast<const uint8_t*>(&lod_info);
+        out.insert(out.end(), header_bytes, header_bytes + sizeof(lod_header));
+        out.insert(out.end(), lod_vertices.begin(), lod_vertices.end());
+        out.insert(out.end(), index_bytes, index_bytes + lod_indices.size() * sizeof(uint32_t));
+        out.insert(out.end(), meshlet_data.begin(), meshlet_data.end());
+        out.insert(out.end(), info_bytes, info_bytes + sizeof(lod_info));
+    }
+    return true;
+}
+
+} // namespace Taffy
@@ -0,0 +1,220 @@
+#include "include/taffy_stream_writer.h"
+#include "include/taffy_crc32.h"
+#include "include/taffy_directory.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+namespace Taffy {
+
+AssetStreamWriter::AssetStreamWriter() {
+    // Same defaults as a freshly constructed Asset
+    std::strncpy(header_.magic, "TAF!", 4);
+    header_.version_major = 1;
+    header_.feature_flags = FeatureFlags::None;
+    std::strncpy(header_.creator, "Unknown", sizeof(header_.creator) - 1);
+    std::strncpy(header_.description, "Taffy Asset", sizeof(header_.description) - 1);
+}
+
+AssetStreamWriter::~AssetStreamWriter() {
+    if (file_.is_open()) {
+        std::cerr << "⚠️ AssetStreamWriter destroyed before finalize(): " << path_ << std::endl;
+    }
+}
+
+void AssetStreamWriter::set_creator(const std::string& creator) {
+    std::strncpy(header_.creator, creator.c_str(), sizeof(header_.creator) - 1);
+    header_.creator[sizeof(header_.creator) - 1] = '\0';
+}
+
+void AssetStreamWriter::set_description(const std::string& description) {
+    std::strncpy(header_.description, description.c_str(), sizeof(header_.description) - 1);
+    header_.description[sizeof(header_.description) - 1] = '\0';
+}
+
+void AssetStreamWriter::set_feature_flags(FeatureFlags flags) {
+    header_.feature_flags = flags;
+}
+
+bool AssetStreamWriter::set_payload_alignment(uint32_t bytes) {
+    if (!chunk_alignment_log2(bytes, alignment_log2_)) {
+        std::cerr << "❌ Invalid payload alignment: " << bytes << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool AssetStreamWriter::fail(const char* message) {
+    std::cerr << "❌ " << message << ": " << path_ << std::endl;
+    failed_ = true;
+    return false;
+}
+
+bool AssetStreamWriter::open(const std::filesystem::path& path, uint32_t max_chunks) {
+    if (file_.is_open()) {
+        std::cerr << "❌ AssetStreamWriter is already writing: " << path_ << std::endl;
+        return false;
+    }
+
+    path_ = path;
+    directory_.clear();
+    directory_.reserve(max_chunks);
+    max_chunks_ = max_chunks;
+    in_chunk_ = false;
+    failed_ = false;
+
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        return fail("Failed to open file for writing");
+    }
+    unfinished_ = true;
+
+    // Reserve header and directory; the zeroed magic keeps an unfinished
+    // file from being mistaken for a valid asset
+    const uint64_t reserved = sizeof(AssetHeader) + uint64_t(max_chunks) * sizeof(ChunkDirectoryEntry);
+    const std::vector<char> zeros(4096, 0);
+    for (uint64_t remaining = reserved; remaining > 0;) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(remaining, zeros.size()));
+        file_.write(zeros.data(), count);
+        remaining -= count;
+    }
+    if (!file_) {
+        return fail("Failed to reserve header and directory");
+    }
+
+    current_offset_ = reserved;
+    return true;
+}
+
+bool AssetStreamWriter::begin_chunk(ChunkType type, const std::string& name, uint32_t flags) {
+    if (!file_.is_open() || failed_) {
+        std::cerr << "❌ AssetStreamWriter is not open" << std::endl;
+        return false;
+    }
+    if (in_chunk_) {
+        std::cerr << "❌ begin_chunk() called before end_chunk() for: " << directory_.back().name << std::endl;
+        return false;
+    }
+    if (directory_.size() >= max_chunks_) {
+        std::cerr << "❌ Chunk directory full (" << max_chunks_ << " entries reserved)" << std::endl;
+        return false;
+    }
+
+    // Pad up to the payload alignment
+    const uint64_t alignment = uint64_t(1) << alignment_log2_;
+    const uint64_t aligned_offset = (current_offset_ + alignment - 1) & ~(alignment - 1);
+    static const char padding[4096] = {};
+    for (uint64_t remaining = aligned_offset - current_offset_; remaining > 0;) {
+        const uint64_t count = std::min<uint64_t>(remaining, sizeof(padding));
+        file_.write(padding, static_cast<std::streamsize>(count));
+        remaining -= count;
+    }
+    if (!file_) {
+        return fail("Failed to pad chunk payload");
+    }
+    current_offset_ = aligned_offset;
+
+    ChunkDirectoryEntry entry{};
+    entry.type = type;
+    entry.flags = flags;
+    entry.offset = current_offset_;
+    entry.alignment_log2 = alignment_log2_;
+    std::strncpy(entry.name, name.c_str(), sizeof(entry.name) - 1);
+    directory_.push_back(entry);
+    in_chunk_ = true;
+    return true;
+}
+
+bool AssetStreamWriter::write(const void* data, size_t size) {
+    if (!in_chunk_ || failed_) {
+        std::cerr << "❌ write() outside of begin_chunk()/end_chunk()" << std::endl;
+        return false;
+    }
+    if (size == 0) {
+        return true;
+    }
+
+    file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    if (!file_) {
+        return fail("Failed to write chunk data");
+    }
+
+    auto& entry = directory_.back();
+    entry.checksum = crc32(data, size, entry.checksum);
+    entry.size += size;
+    current_offset_ += size;
+    return true;
+}
+
+bool AssetStreamWriter::end_chunk() {
+    if (!in_chunk_) {
+        std::cerr << "❌ end_chunk() without begin_chunk()" << std::endl;
+        return false;
+    }
+    in_chunk_ = false;
+    return !failed_;
+}
+
+bool AssetStreamWriter::add_chunk(ChunkType type, std::span<const uint8_t> data,
+                                  const std::string& name, uint32_t flags) {
+    return begin_chunk(type, name, flags) && write(data) && end_chunk();
+}
+
+bool AssetStreamWriter::finalize() {
+    if (!file_.is_open()) {
+        std::cerr << "❌ AssetStreamWriter is not open" << std::endl;
+        return false;
+    }
+    if (in_chunk_) {
+        std::cerr << "❌ finalize() called with an unfinished chunk: " << directory_.back().name << std::endl;
+        file_.close();
+        return false;
+    }
+    if (failed_) {
+        file_.close();
+        return false;
+    }
+
+    if (write_chunk_index_) {
+        const std::vector<uint8_t> table = build_chunk_index_table(directory_);
+        if (!add_chunk(ChunkType::INDX, table, CHUNK_INDEX_NAME)) {
+            file_.close();
+            return false;
+        }
+    }
+
+    header_.chunk_count = static_cast<uint32_t>(directory_.size());
+    header_.index_chunk = write_chunk_index_ ? header_.chunk_count : 0;
+    header_.total_size = current_offset_;
+
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    file_.write(reinterpret_cast<const char*>(directory_.data()),
+                static_cast<std::streamsize>(directory_.size() * sizeof(ChunkDirectoryEntry)));
+    file_.close();
+    if (!file_) {
+        return fail("Failed to patch header and directory");
+    }
+    unfinished_ = false;
+
+    std::cout << "✅ Streamed asset written: " << path_ << std::endl;
+    std::cout << "   📊 Size: " << current_offset_ << " bytes" << std::endl;
+    std::cout << "   📦 Chunks: " << directory_.size() << std::endl;
+    return true;
+}
+
+void AssetStreamWriter::abort() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+    if (unfinished_) {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+        unfinished_ = false;
+    }
+    directory_.clear();
+    in_chunk_ = false;
+    failed_ = false;
+}
+
+} // namespace Taffy
@@ -1,38 +1,26 @@
 #include "include/taffy_streaming.h"
+#include "include/taffy_codec.h"
+#include "include/taffy_crc32.h"
+#include "include/taffy_file.h"
+#include "include/taffy_layout.h"
+#include "include/taffy_mount.h"
 #include <iostream>
 #include <cstring>
 #include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
 
 namespace Taffy {
 
-// Static members
-std::mutex StreamingTaffyLoader::handle_mutex_;
-size_t StreamingTaffyLoader::next_handle_id_ = 1;
-std::unordered_map<size_t, std::weak_ptr<StreamingTaffyLoader>> StreamingTaffyLoader::active_handles_;
-
-StreamingTaffyHandle::~StreamingTaffyHandle() {
-    if (loader_ && handle_id_ != 0) {
-        std::lock_guard<std::mutex> lock(StreamingTaffyLoader::handle_mutex_);
-        StreamingTaffyLoader::active_handles_.erase(handle_id_);
-    }
-}
-
-StreamingTaffyHandle::StreamingTaffyHandle(StreamingTaffyHandle&& other) noexcept
-    : loader_(std::move(other.loader_)), handle_id_(other.handle_id_) {
-    other.handle_id_ = 0;
-}
-
-StreamingTaffyHandle& StreamingTaffyHandle::operator=(StreamingTaffyHandle&& other) noexcept {
-    if (this != &other) {
-        if (loader_ && handle_id_ != 0) {
-            std::lock_guard<std::mutex> lock(StreamingTaffyLoader::handle_mutex_);
-            StreamingTaffyLoader::active_handles_.erase(handle_id_);
-        }
-        loader_ = std::move(other.loader_);
-        handle_id_ = other.handle_id_;
-        other.handle_id_ = 0;
-    }
-    return *this;
+StreamingTaffyLoader::StreamingTaffyLoader() {
+    cache_.set_memory_pool(cache_config_.memory_pool);
+    
+    // Entries of a lazy directory arrive after open(); record their cache
+    // type and pin state as they are read
+    directory_.set_entry_observer([this](uint32_t index, const ChunkDirectoryEntry& entry) {
+        applyChunkPinning(index, entry);
+    });
 }
 
 StreamingTaffyLoader::~StreamingTaffyLoader() {
@@ -40,22 +28,25 @@ StreamingTaffyLoader::~StreamingTaffyLoader() {
 }
 
 bool StreamingTaffyLoader::open(const std::string& filepath) {
+    stopPrefetcher();
     std::lock_guard<std::mutex> lock(file_mutex_);
     
-    if (file_.is_open()) {
-        file_.close();
-    }
+    // Forget the previous package first, so a failed open cannot leave its
+    // directory and cached chunks serving loadChunk()
+    file_.close();
+    directory_.clear();
+    cache_.reset(0);
+    telemetry_.reset(0);
+    header_ = AssetHeader{};
     
     filepath_ = filepath;
-    file_.open(filepath_, std::ios::binary);
-    if (!file_) {
+    if (!file_.open(filepath_)) {
         std::cerr << "Failed to open TAF file: " << filepath_ << std::endl;
         return false;
     }
     
     // Read header
-    file_.read(reinterpret_cast<char*>(&header_), sizeof(header_));
-    if (!file_ || file_.gcount() != sizeof(header_)) {
+    if (!file_.read_at(0, &header_, sizeof(header_))) {
         std::cerr << "Failed to read TAF header" << std::endl;
         file_.close();
         return false;
@@ -69,401 +60,929 @@ bool StreamingTaffyLoader::open(const std::string& filepath) {
         return false;
     }
     
-    // Read chunk directory
-    directory_.resize(header_.chunk_count);
-    file_.read(reinterpret_cast<char*>(directory_.data()), 
-               header_.chunk_count * sizeof(ChunkDirectoryEntry));
-    
-    if (!file_ || file_.gcount() != header_.chunk_count * sizeof(ChunkDirectoryEntry)) {
-        std::cerr << "Failed to read chunk directory" << std::endl;
+    // Read the chunk directory, or with an INDX chunk only the index head.
+    // It checks chunk_count against the file size, so nothing is sized from
+    // the header before that.
+    if (!directory_.open(file_, header_, lazy_directory_)) {
         file_.close();
+        directory_.clear();
         return false;
     }
+    cache_.reset(header_.chunk_count);
+    telemetry_.reset(header_.chunk_count);
+    applyChunkPinning();    // Entries read while opening reached the empty cache
+    
+    // Mount-time chunks sit at the front of the file; fetch them in one read
+    readResidencySpan(ResidencyClass::Boot);
     
     std::cout << "📖 Opened streaming TAF: " << filepath_ << std::endl;
     std::cout << "   Version: " << header_.version_major << "." 
               << header_.version_minor << "." << header_.version_patch << std::endl;
-    std::cout << "   Chunks: " << header_.chunk_count << std::endl;
+    std::cout << "   Chunks: " << header_.chunk_count;
+    if (directory_.is_lazy()) {
+        std::cout << " (lazy directory, " << directory_.resident_entries() << " entries read)";
+    }
+    std::cout << std::endl;
     std::cout << "   Feature flags: 0x" << std::hex << static_cast<uint64_t>(header_.feature_flags) << std::dec << std::endl;
     
     return true;
 }
 
 void StreamingTaffyLoader::close() {
+    // Workers read through file_ and cache_; drain them before tearing down
+    stopPrefetcher();
     std::lock_guard<std::mutex> lock(file_mutex_);
-    if (file_.is_open()) {
-        file_.close();
-    }
+    file_.close();
     directory_.clear();
-    clearCache();
+    cache_.reset(0);
 }
 
-std::vector<uint8_t> StreamingTaffyLoader::loadChunk(uint32_t index) {
+ChunkBufferPtr StreamingTaffyLoader::loadChunk(uint32_t index) {
     if (index >= directory_.size()) {
         std::cerr << "Invalid chunk index: " << index << std::endl;
-        return {};
+        return nullptr;
     }
     
-    // Check cache first
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex_);
-        auto it = chunk_cache_.find(index);
-        if (it != chunk_cache_.end()) {
-            ++cache_hits_;
-            ++it->second.access_count;
-            return it->second.data;
-        }
-        ++cache_misses_;
+    // Check cache first (lock-free, no copy)
+    if (ChunkBufferPtr cached = cache_.find(index)) {
+        return cached;
     }
     
     // Load from file
     auto data = loadChunkInternal(index);
-    
-    // Add to cache if successful
-    if (!data.empty()) {
-        std::lock_guard<std::mutex> lock(cache_mutex_);
-        // Simple cache eviction: remove least accessed chunk if cache is too large
-        size_t total_cache_size = 0;
-        for (const auto& [idx, chunk] : chunk_cache_) {
-            total_cache_size += chunk.data.size();
-        }
-        
-        // If cache is over 50MB, evict least accessed chunk
-        while (total_cache_size > 50 * 1024 * 1024 && !chunk_cache_.empty()) {
-            auto min_it = chunk_cache_.begin();
-            for (auto it = chunk_cache_.begin(); it != chunk_cache_.end(); ++it) {
-                if (it->second.access_count < min_it->second.access_count) {
-                    min_it = it;
-                }
-            }
-            total_cache_size -= min_it->second.data.size();
-            chunk_cache_.erase(min_it);
-        }
-        
-        chunk_cache_[index] = {data, 1};
+    if (!data) {
+        return nullptr;
     }
     
-    return data;
+    // The cache evicts to stay within its budget; the returned reference
+    // keeps the buffer alive regardless
+    return cache_.insert(index, std::move(*data));
 }
 
-std::vector<uint8_t> StreamingTaffyLoader::loadChunkInternal(uint32_t index) const {
-    std::lock_guard<std::mutex> lock(file_mutex_);
-    
+std::optional<std::vector<uint8_t>> StreamingTaffyLoader::loadChunkInternal(uint32_t index) const {
     if (!file_.is_open()) {
         std::cerr << "TAF file not open" << std::endl;
-        return {};
+        return std::nullopt;
     }
     
-    const auto& entry = directory_[index];
-    
-    // Seek to chunk data
-    file_.seekg(entry.offset);
-    if (!file_) {
-        std::cerr << "Failed to seek to chunk offset: " << entry.offset << std::endl;
-        return {};
+    const ChunkDirectoryEntry* info = directory_.entry(index);
+    if (!info) {
+        std::cerr << "Failed to read directory entry " << index << std::endl;
+        return std::nullopt;
+    }
+    const auto& entry = *info;
+    if (entry.offset > file_.size() || entry.size > file_.size() - entry.offset) {
+        std::cerr << "Chunk extends beyond file: " << entry.name << std::endl;
+        return std::nullopt;
     }
     
-    // Read chunk data
-    std::vector<uint8_t> data(entry.size);
-    file_.read(reinterpret_cast<char*>(data.data()), entry.size);
+    // Positional read: concurrent loads of different chunks overlap on disk
+    std::vector<uint8_t> data(static_cast<size_t>(entry.size));
+    const uint64_t started = telemetry_.begin();
+    if (!file_.read_at(entry.offset, data.data(), data.size())) {
+        std::cerr << "Failed to read chunk data at offset " << entry.offset
+                  << " (" << entry.size << " bytes)" << std::endl;
+        return std::nullopt;
+    }
+    telemetry_.record_read(index, entry.type, data.size(), started);
+
+    return decodeChunkInternal(index, std::move(data));
+}
+
+std::optional<std::vector<uint8_t>> StreamingTaffyLoader::decodeChunkInternal(uint32_t index, std::vector<uint8_t> stored) const {
+    const auto& entry = *directory_.entry(index);
+
+    // Decompress on the calling thread
+    if (entry.codec != ChunkCodec::None) {
+        std::vector<uint8_t> decoded;
+        const uint64_t started = telemetry_.begin();
+        if (!decode_chunk_payload(entry, stored, decoded)) {
+            std::cerr << "Failed to decompress chunk: " << entry.name
+                      << " (" << chunk_codec_name(entry.codec) << ")" << std::endl;
+            return std::nullopt;
+        }
+        telemetry_.record_decode(decoded.size(), started);
+        return decoded;
+    }
+
+    return stored;
+}
+
+void StreamingTaffyLoader::loadChunkBatch(std::span<const uint32_t> indices, std::span<ChunkBufferPtr> chunks) {
+    // Gather the misses into one batch of reads
+    std::vector<std::vector<uint8_t>> stored;
+    std::vector<ReadRequest> requests;
+    std::vector<size_t> slots;
+    stored.reserve(indices.size());
+    requests.reserve(indices.size());
+    slots.reserve(indices.size());
+    
+    for (size_t i = 0; i < indices.size(); ++i) {
+        const uint32_t index = indices[i];
+        if (index >= directory_.size()) {
+            continue;
+        }
+        if (ChunkBufferPtr cached = cache_.find(index)) {
+            chunks[i] = cached;
+            continue;
+        }
+        const ChunkDirectoryEntry* entry = directory_.entry(index);
+        if (!entry) {
+            continue;
+        }
+        stored.emplace_back(static_cast<size_t>(entry->size));
+        requests.push_back({ entry->offset, stored.back().data(), stored.back().size() });
+        slots.push_back(i);
+    }
+    if (requests.empty()) {
+        return;
+    }
     
-    if (!file_ || file_.gcount() != entry.size) {
-        std::cerr << "Failed to read chunk data. Expected: " << entry.size 
-                  << ", Got: " << file_.gcount() << std::endl;
-        return {};
+    // Borrow a backend; rings are single-threaded, so each worker needs its own
+    std::unique_ptr<ReadBackend> backend;
+    {
+        std::lock_guard<std::mutex> lock(backend_mutex_);
+        if (!idle_backends_.empty()) {
+            backend = std::move(idle_backends_.back());
+            idle_backends_.pop_back();
+        }
+    }
+    if (!backend) {
+        backend = create_read_backend(active_backend_, static_cast<unsigned>(PREFETCH_BATCH));
+    }
+    const uint64_t started = telemetry_.begin();
+    backend->read_batch(file_, requests);
+    {
+        std::lock_guard<std::mutex> lock(backend_mutex_);
+        idle_backends_.push_back(std::move(backend));
     }
     
-    return data;
+    for (size_t r = 0; r < requests.size(); ++r) {
+        const uint32_t index = indices[slots[r]];
+        if (!requests[r].ok) {
+            std::cerr << "Failed to read chunk data at offset " << requests[r].offset
+                      << " (" << requests[r].length << " bytes)" << std::endl;
+            continue;
+        }
+        // Completions are not timed individually; each read waited for the batch
+        telemetry_.record_read(index, directory_.entry(index)->type, requests[r].length, started);
+        if (auto data = decodeChunkInternal(index, std::move(stored[r]))) {
+            chunks[slots[r]] = cache_.insert(index, std::move(*data));
+        }
+    }
 }
 
-std::vector<uint8_t> StreamingTaffyLoader::loadChunk(const std::string& name) {
+ChunkBufferPtr StreamingTaffyLoader::loadChunk(const std::string& name) {
     int index = findChunkIndex(name);
     if (index < 0) {
-        return {};
+        return nullptr;
     }
     return loadChunk(static_cast<uint32_t>(index));
 }
 
-std::vector<uint8_t> StreamingTaffyLoader::loadChunk(ChunkType type) {
+ChunkBufferPtr StreamingTaffyLoader::loadChunk(ChunkType type) {
     int index = findChunkIndex(type);
     if (index < 0) {
-        return {};
+        return nullptr;
     }
     return loadChunk(static_cast<uint32_t>(index));
 }
 
 int StreamingTaffyLoader::findChunkIndex(const std::string& name) const {
-    for (uint32_t i = 0; i < directory_.size(); ++i) {
-        if (std::string(directory_[i].name) == name) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;
+    return directory_.find(name);
 }
 
 int StreamingTaffyLoader::findChunkIndex(ChunkType type) const {
-    for (uint32_t i = 0; i < directory_.size(); ++i) {
-        if (directory_[i].type == type) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;
+    return directory_.find(type);
 }
 
 const ChunkDirectoryEntry* StreamingTaffyLoader::getChunkInfo(const std::string& name) const {
-    for (const auto& entry : directory_) {
-        if (std::string(entry.name) == name) {
-            return &entry;
-        }
+    int index = directory_.find(name);
+    if (index < 0) {
+        return nullptr;
     }
-    return nullptr;
+    return directory_.entry(static_cast<uint32_t>(index));
 }
 
 const ChunkDirectoryEntry* StreamingTaffyLoader::getChunkInfo(uint32_t index) const {
-    if (index >= directory_.size()) {
+    return directory_.entry(index);
+}
+
+ChunkBufferPtr StreamingTaffyLoader::loadMetadata() {
+    // First AUDI chunk (should be metadata)
+    return loadChunk(ChunkType::AUDI);
+}
+
+ChunkBufferPtr StreamingTaffyLoader::loadAudioChunk(uint32_t chunkIndex) {
+    // Format the name on the stack so per-block lookups stay allocation free
+    char chunkName[sizeof(ChunkDirectoryEntry::name)];
+    int length = std::snprintf(chunkName, sizeof(chunkName), "audio_chunk_%u", chunkIndex);
+    int index = directory_.find(chunkName, static_cast<size_t>(length));
+    if (index < 0) {
         return nullptr;
     }
-    return &directory_[index];
+    return loadChunk(static_cast<uint32_t>(index));
+}
+
+uint64_t StreamingTaffyLoader::getChunkDataSize(uint32_t index) const {
+    const ChunkDirectoryEntry* entry = directory_.entry(index);
+    if (!entry) {
+        return 0;
+    }
+    return entry->codec == ChunkCodec::None ? entry->size : entry->uncompressed_size;
 }
 
-std::vector<uint8_t> StreamingTaffyLoader::loadMetadata() {
-    // Find first AUDI chunk (should be metadata)
-    for (uint32_t i = 0; i < directory_.size(); ++i) {
-        if (directory_[i].type == ChunkType::AUDI) {
-            return loadChunk(i);
+bool StreamingTaffyLoader::readRange(uint32_t index, uint64_t offset, void* buffer, size_t length) {
+    const ChunkDirectoryEntry* entry = directory_.entry(index);
+    if (!entry || !file_.is_open()) {
+        return false;
+    }
+    const uint64_t size = getChunkDataSize(index);
+    if (offset > size || length > size - offset) {
+        std::cerr << "Range read beyond chunk: " << entry->name
+                  << " [" << offset << ", +" << length << ")" << std::endl;
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+    
+    ChunkBufferPtr chunk = cache_.peek(index);
+    if (!chunk && entry->codec != ChunkCodec::None) {
+        chunk = loadChunk(index);
+    }
+    if (chunk) {
+        if (chunk->size() < offset + length) {
+            return false;
         }
+        std::memcpy(buffer, chunk->data() + offset, length);
+        return true;
+    }
+    
+    const uint64_t started = telemetry_.begin();
+    if (!file_.read_at(entry->offset + offset, buffer, length)) {
+        return false;
     }
-    return {};
+    telemetry_.record_read(index, entry->type, length, started);
+    return true;
 }
 
-std::vector<uint8_t> StreamingTaffyLoader::loadAudioChunk(uint32_t chunkIndex) {
-    std::string chunkName = "audio_chunk_" + std::to_string(chunkIndex);
-    return loadChunk(chunkName);
+std::optional<AudioChunk::StreamingAudio> StreamingTaffyLoader::loadStreamingAudioInfo(uint32_t index, uint32_t streamIndex) {
+    AudioChunk header{};
+    if (!readRange(index, 0, &header, sizeof(header)) || streamIndex >= header.streaming_count) {
+        return std::nullopt;
+    }
+    
+    // Streaming entries follow the fixed-size tables
+    const uint64_t tableOffset = sizeof(AudioChunk) +
+        uint64_t(header.node_count) * sizeof(AudioChunk::Node) +
+        uint64_t(header.connection_count) * sizeof(AudioChunk::Connection) +
+        uint64_t(header.pattern_count) * sizeof(AudioChunk::Pattern) +
+        uint64_t(header.sample_count) * sizeof(AudioChunk::WaveTable) +
+        uint64_t(header.parameter_count) * sizeof(AudioChunk::Parameter);
+    
+    AudioChunk::StreamingAudio info{};
+    if (!readRange(index, tableOffset + uint64_t(streamIndex) * sizeof(info), &info, sizeof(info))) {
+        return std::nullopt;
+    }
+    if (info.data_offset > getChunkDataSize(index)) {
+        std::cerr << "Streaming audio data offset beyond chunk: " << directory_.entry(index)->name << std::endl;
+        return std::nullopt;
+    }
+    return info;
 }
 
 std::optional<ManifestChunk> StreamingTaffyLoader::loadManifest() {
     auto data = loadChunk(ChunkType::MANF);
-    if (data.size() < sizeof(ManifestChunk)) {
+    if (!data || data->size() < sizeof(ManifestChunk)) {
         return std::nullopt;
     }
 
     ManifestChunk manifest{};
-    std::memcpy(&manifest, data.data(), sizeof(ManifestChunk));
+    std::memcpy(&manifest, data->data(), sizeof(ManifestChunk));
     return manifest;
 }
 
 std::optional<BootstrapChunk> StreamingTaffyLoader::loadBootstrap() {
     auto data = loadChunk(ChunkType::BOOT);
-    if (data.size() < sizeof(BootstrapChunk)) {
+    if (!data || data->size() < sizeof(BootstrapChunk)) {
         return std::nullopt;
     }
 
     BootstrapChunk bootstrap{};
-    std::memcpy(&bootstrap, data.data(), sizeof(BootstrapChunk));
+    std::memcpy(&bootstrap, data->data(), sizeof(BootstrapChunk));
     return bootstrap;
 }
 
 std::vector<DependencyChunk::Entry> StreamingTaffyLoader::loadDependencies() {
     auto data = loadChunk(ChunkType::DEPS);
-    if (data.size() < sizeof(DependencyChunk)) {
+    if (!data || data->size() < sizeof(DependencyChunk)) {
         return {};
     }
 
     DependencyChunk deps{};
-    std::memcpy(&deps, data.data(), sizeof(DependencyChunk));
+    std::memcpy(&deps, data->data(), sizeof(DependencyChunk));
 
     const size_t expectedSize = sizeof(DependencyChunk) +
         static_cast<size_t>(deps.dependency_count) * sizeof(DependencyChunk::Entry);
-    if (data.size() < expectedSize) {
+    if (data->size() < expectedSize) {
         return {};
     }
 
     std::vector<DependencyChunk::Entry> entries(deps.dependency_count);
     if (deps.dependency_count > 0) {
         std::memcpy(entries.data(),
-            data.data() + sizeof(DependencyChunk),
+            data->data() + sizeof(DependencyChunk),
             static_cast<size_t>(deps.dependency_count) * sizeof(DependencyChunk::Entry));
     }
     return entries;
 }
 
 StreamingTaffyHandle StreamingTaffyLoader::createHandle(const std::string& filepath) {
-    auto loader = std::make_shared<StreamingTaffyLoader>();
-    if (!loader->open(filepath)) {
-        return StreamingTaffyHandle();
+    return PackageMountManager::instance().mount(filepath);
+}
+
+void StreamingTaffyLoader::configureCache(const CacheConfig& config) {
+    // Quotas dropped from the configuration are lifted
+    for (const auto& [type, bytes] : cache_config_.type_quotas) {
+        cache_.set_type_quota(type, ChunkCache::UNLIMITED);
+    }
+    cache_config_ = config;
+    
+    cache_.set_memory_pool(cache_config_.memory_pool);
+    cache_.set_policy(cache_config_.policy);
+    for (const auto& [type, bytes] : cache_config_.type_quotas) {
+        cache_.set_type_quota(type, bytes);
+    }
+    applyChunkPinning();
+    cache_.set_budget(cache_config_.budget_bytes);
+}
+
+void StreamingTaffyLoader::setCacheBudget(uint64_t bytes) {
+    cache_config_.budget_bytes = bytes;
+    cache_.set_budget(bytes);
+}
+
+void StreamingTaffyLoader::applyChunkPinning() {
+    directory_.for_each_resident([this](uint32_t index, const ChunkDirectoryEntry& entry) {
+        applyChunkPinning(index, entry);
+    });
+}
+
+void StreamingTaffyLoader::applyChunkPinning(uint32_t index, const ChunkDirectoryEntry& entry) {
+    const ResidencyClass residency = chunk_residency(entry);
+    const bool pinned = (cache_config_.pin_boot && residency == ResidencyClass::Boot) ||
+                        (cache_config_.pin_resident && residency == ResidencyClass::Resident);
+    cache_.set_chunk_info(index, entry.type, pinned);
+}
+
+std::shared_ptr<ChunkPrefetcher> StreamingTaffyLoader::getPrefetcher() {
+    std::lock_guard<std::mutex> lock(prefetcher_mutex_);
+    if (prefetcher_) {
+        return prefetcher_;
     }
     
-    StreamingTaffyHandle handle;
-    handle.loader_ = loader;
+    auto backend = create_read_backend(read_backend_, static_cast<unsigned>(PREFETCH_BATCH));
+    active_backend_ = backend->kind();
+    if (active_backend_ == ReadBackendKind::IoUring) {
+        // Few workers suffice: each keeps a whole batch in flight
+        {
+            std::lock_guard<std::mutex> backend_lock(backend_mutex_);
+            idle_backends_.push_back(std::move(backend));
+        }
+        prefetcher_ = std::make_shared<ChunkPrefetcher>(
+            [this](std::span<const uint32_t> indices, std::span<ChunkBufferPtr> chunks) {
+                loadChunkBatch(indices, chunks);
+            },
+            prefetch_threads_ ? prefetch_threads_ : 2, PREFETCH_BATCH);
+    } else {
+        // pread thread pool: one blocking read per worker
+        prefetcher_ = std::make_shared<ChunkPrefetcher>(
+            [this](uint32_t index) { return loadChunk(index); }, prefetch_threads_);
+    }
+    return prefetcher_;
+}
+
+void StreamingTaffyLoader::stopPrefetcher() {
+    std::shared_ptr<ChunkPrefetcher> prefetcher;
+    {
+        std::lock_guard<std::mutex> lock(prefetcher_mutex_);
+        prefetcher = std::move(prefetcher_);
+    }
+    if (prefetcher) {
+        prefetcher->stop();
+    }
     
-    std::lock_guard<std::mutex> lock(handle_mutex_);
-    handle.handle_id_ = next_handle_id_++;
-    active_handles_[handle.handle_id_] = loader;
+    std::lock_guard<std::mutex> lock(backend_mutex_);
+    idle_backends_.clear();
+}
+
+std::vector<ChunkFuture> StreamingTaffyLoader::prefetch(const std::vector<uint32_t>& indices,
+                                                        PrefetchPriority priority,
+                                                        PrefetchCallback callback) {
+    std::vector<ChunkFuture> futures;
+    futures.reserve(indices.size());
+    std::shared_ptr<ChunkPrefetcher> prefetcher;
+    
+    for (uint32_t index : indices) {
+        // Already cached or invalid: resolve on the caller's thread, no queueing
+        ChunkBufferPtr cached = cache_.peek(index);
+        if (cached || index >= directory_.size() || !file_.is_open()) {
+            std::promise<ChunkBufferPtr> ready;
+            ready.set_value(cached);
+            futures.push_back(ready.get_future().share());
+            if (callback) {
+                callback(index, cached);
+            }
+            continue;
+        }
+        if (!prefetcher) {
+            prefetcher = getPrefetcher();
+        }
+        futures.push_back(prefetcher->request(index, priority, callback));
+    }
+    if (prefetcher && telemetry_.enabled()) {
+        telemetry_.record_queue_depth(prefetcher->pending_count());
+    }
     
-    return handle;
+    return futures;
 }
 
-void StreamingTaffyLoader::preloadChunks(const std::vector<uint32_t>& indices) {
+ChunkFuture StreamingTaffyLoader::requestChunk(uint32_t index, PrefetchPriority priority) {
+    return prefetch({ index }, priority).front();
+}
+
+size_t StreamingTaffyLoader::cancelPrefetch(const std::vector<uint32_t>& indices) {
+    std::shared_ptr<ChunkPrefetcher> prefetcher;
+    {
+        std::lock_guard<std::mutex> lock(prefetcher_mutex_);
+        prefetcher = prefetcher_;
+    }
+    if (!prefetcher) {
+        return 0;
+    }
+    size_t cancelled = 0;
     for (uint32_t index : indices) {
-        loadChunk(index); // This will cache the chunk
+        if (prefetcher->cancel(index)) {
+            cancelled++;
+        }
     }
+    return cancelled;
 }
 
-bool StreamingTaffyLoader::ensureChunkCached(uint32_t index) {
-    if (index >= directory_.size()) {
+void StreamingTaffyLoader::evict(const std::vector<uint32_t>& indices) {
+    cancelPrefetch(indices);
+    for (uint32_t index : indices) {
+        cache_.erase(index);
+    }
+}
+
+void StreamingTaffyLoader::preloadChunks(const std::vector<uint32_t>& indices) {
+    prefetch(indices, PrefetchPriority::Speculative);
+}
+
+bool StreamingTaffyLoader::preloadResidency(ResidencyClass residency) {
+    if (!file_.is_open()) {
+        std::cerr << "TAF file not open" << std::endl;
         return false;
     }
+    return readResidencySpan(residency);
+}
 
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex_);
-        if (chunk_cache_.find(index) != chunk_cache_.end()) {
-            return true;
+bool StreamingTaffyLoader::readResidencySpan(ResidencyClass residency) {
+    // Largest single read issued for a residency class
+    constexpr uint64_t MAX_SPAN_READ = 64ull * 1024 * 1024;
+
+    const ResidencySpan span = directory_.residency_span(residency);
+    if (span.chunks.empty()) {
+        return true;
+    }
+
+    // Older files (or unplanned layouts) may interleave classes; only read the
+    // span when it is mostly made of the chunks we want
+    if (span.size > MAX_SPAN_READ || span.size > span.payload_bytes * 2 + 64 * 1024) {
+        return false;
+    }
+
+    std::vector<uint8_t> buffer(static_cast<size_t>(span.size));
+    const uint64_t started = telemetry_.begin();
+    if (!file_.read_at(span.offset, buffer.data(), buffer.size())) {
+        std::cerr << "Failed to read " << residency_class_name(residency) << " chunks ("
+                  << span.size << " bytes at offset " << span.offset << ")" << std::endl;
+        return false;
+    }
+
+    for (uint32_t index : span.chunks) {
+        const auto& entry = *directory_.entry(index);
+        telemetry_.record_read(index, entry.type, entry.size, started);
+        std::span<const uint8_t> stored(buffer.data() + (entry.offset - span.offset), static_cast<size_t>(entry.size));
+        std::vector<uint8_t> data;
+        if (!decode_chunk_payload(entry, stored, data)) {
+            std::cerr << "Failed to decompress chunk: " << entry.name << std::endl;
+            continue;
         }
+        cache_.insert(index, std::move(data));
     }
 
-    auto data = loadChunk(index);
-    return !data.empty();
+    std::cout << "   📦 Preloaded " << span.chunks.size() << " " << residency_class_name(residency)
+              << " chunk(s) with one " << span.size << "-byte read" << std::endl;
+    return true;
 }
 
-const std::vector<uint8_t>* StreamingTaffyLoader::getCachedChunkData(uint32_t index) const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    auto it = chunk_cache_.find(index);
-    if (it == chunk_cache_.end()) {
-        return nullptr;
+bool StreamingTaffyLoader::ensureChunkCached(uint32_t index) {
+    if (index >= directory_.size()) {
+        return false;
     }
-    return &it->second.data;
+
+    if (cache_.peek(index)) {
+        return true;
+    }
+
+    return loadChunk(index) != nullptr;
+}
+
+ChunkBufferPtr StreamingTaffyLoader::getCachedChunkData(uint32_t index) const {
+    return cache_.peek(index);
 }
 
 void StreamingTaffyLoader::clearCache() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    chunk_cache_.clear();
-    cache_hits_ = 0;
-    cache_misses_ = 0;
+    cache_.clear();
+    cache_.reset_stats();
+}
+
+TelemetrySnapshot StreamingTaffyLoader::getTelemetry() const {
+    TelemetrySnapshot snapshot = telemetry_.snapshot();
+    snapshot.cache_hits = cache_.hits();
+    snapshot.cache_misses = cache_.misses();
+    snapshot.cache_evictions = cache_.evictions();
+    snapshot.cache_evicted_bytes = cache_.evicted_bytes();
+    snapshot.cache_bytes = cache_.size_bytes();
+    snapshot.cache_entries = cache_.entry_count();
+    {
+        std::lock_guard<std::mutex> lock(prefetcher_mutex_);
+        snapshot.queue_depth = prefetcher_ ? prefetcher_->pending_count() : 0;
+    }
+    // Chunks that were read have their directory page in memory already
+    for (auto& chunk : snapshot.chunks) {
+        if (const ChunkDirectoryEntry* entry = directory_.entry(chunk.index)) {
+            chunk.name.assign(entry->name, ::strnlen(entry->name, sizeof(entry->name)));
+        }
+    }
+    return snapshot;
+}
+
+void StreamingTaffyLoader::resetTelemetry() {
+    telemetry_.reset(directory_.size());
+    cache_.reset_stats();
 }
 
 StreamingTaffyLoader::CacheStats StreamingTaffyLoader::getCacheStats() const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
     CacheStats stats;
-    stats.total_chunks_loaded = chunk_cache_.size();
-    stats.cache_size_bytes = 0;
-    for (const auto& [idx, chunk] : chunk_cache_) {
-        stats.cache_size_bytes += chunk.data.size();
-    }
-    stats.cache_hits = cache_hits_;
-    stats.cache_misses = cache_misses_;
+    stats.total_chunks_loaded = cache_.entry_count();
+    stats.cache_size_bytes = cache_.size_bytes();
+    stats.cache_hits = cache_.hits();
+    stats.cache_misses = cache_.misses();
     return stats;
 }
 
+// ChunkRangeReader implementation
+
+ChunkRangeReader::ChunkRangeReader(StreamingTaffyLoader& loader, uint32_t chunkIndex,
+                                   uint64_t begin, uint64_t length, size_t windowBytes)
+    : loader_(loader), chunk_index_(chunkIndex), window_bytes_(std::max<size_t>(windowBytes, 1)) {
+    if (!loader_.getChunkInfo(chunkIndex)) {
+        return;
+    }
+    const uint64_t chunkSize = loader_.getChunkDataSize(chunkIndex);
+    begin_ = std::min(begin, chunkSize);
+    length_ = std::min(length, chunkSize - begin_);
+    valid_ = true;
+}
+
+ChunkRangeReader::~ChunkRangeReader() {
+    waitReadAhead();
+}
+
+void ChunkRangeReader::waitReadAhead() {
+    if (ahead_ready_.valid()) {
+        ahead_ok_ = ahead_ready_.get();
+    }
+}
+
+bool ChunkRangeReader::fillWindow(Window& window, uint64_t start) {
+    window.start = start;
+    window.size = static_cast<size_t>(std::min<uint64_t>(window_bytes_, length_ - start));
+    window.data.resize(window_bytes_);
+    if (!loader_.readRange(chunk_index_, begin_ + start, window.data.data(), window.size)) {
+        window.size = 0;
+        return false;
+    }
+    return true;
+}
+
+bool ChunkRangeReader::enterWindow(uint64_t position) {
+    waitReadAhead();
+    if (ahead_ok_ && ahead_.contains(position)) {
+        std::swap(current_, ahead_);
+    } else if (!fillWindow(current_, position)) {
+        return false;
+    }
+    ahead_ok_ = false;
+    
+    // Read the next window while this one is consumed
+    const uint64_t next = current_.start + current_.size;
+    if (next < length_) {
+        ahead_ready_ = std::async(std::launch::async, [this, next]() { return fillWindow(ahead_, next); });
+    }
+    return true;
+}
+
+size_t ChunkRangeReader::read(void* buffer, size_t length) {
+    if (!valid_) {
+        return 0;
+    }
+    
+    auto* out = static_cast<uint8_t*>(buffer);
+    size_t total = 0;
+    while (total < length && position_ < length_) {
+        if (!current_.contains(position_) && !enterWindow(position_)) {
+            break;
+        }
+        const size_t offset = static_cast<size_t>(position_ - current_.start);
+        const size_t count = std::min(length - total, current_.size - offset);
+        std::memcpy(out + total, current_.data.data() + offset, count);
+        total += count;
+        position_ += count;
+    }
+    return total;
+}
+
+bool ChunkRangeReader::seek(uint64_t position) {
+    if (!valid_ || position > length_) {
+        return false;
+    }
+    position_ = position;
+    return true;
+}
+
 // ChunkedTaffyWriter implementation
 
-ChunkedTaffyWriter::ChunkedTaffyWriter() = default;
+ChunkedTaffyWriter::ChunkedTaffyWriter() {
+    std::strncpy(header_.magic, "TAF!", 4);
+    header_.version_major = 1;
+    header_.asset_type = 0;  // Master asset
+    header_.feature_flags = FeatureFlags::Audio;
+    std::strncpy(header_.creator, "ChunkedTaffyWriter", sizeof(header_.creator) - 1);
+    std::strncpy(header_.description, "Chunked streaming audio TAF", sizeof(header_.description) - 1);
+}
 
 ChunkedTaffyWriter::~ChunkedTaffyWriter() {
+    // Only an explicit finalize() publishes the file; a writer destroyed
+    // mid-stream (e.g. while unwinding) holds an incomplete package
     if (file_.is_open()) {
-        finalize();
+        std::cerr << "⚠️ ChunkedTaffyWriter destroyed before finalize(), discarding " << temp_path_ << std::endl;
+        abort();
     }
 }
 
-bool ChunkedTaffyWriter::begin(const std::string& filepath) {
+bool ChunkedTaffyWriter::fail(const std::string& message) {
+    std::cerr << message << ": " << temp_path_ << std::endl;
+    failed_ = true;
+    return false;
+}
+
+void ChunkedTaffyWriter::setCreator(const std::string& creator) {
+    std::strncpy(header_.creator, creator.c_str(), sizeof(header_.creator) - 1);
+    header_.creator[sizeof(header_.creator) - 1] = '\0';
+}
+
+void ChunkedTaffyWriter::setDescription(const std::string& description) {
+    std::strncpy(header_.description, description.c_str(), sizeof(header_.description) - 1);
+    header_.description[sizeof(header_.description) - 1] = '\0';
+}
+
+void ChunkedTaffyWriter::setFeatureFlags(FeatureFlags flags) {
+    header_.feature_flags = flags;
+}
+
+bool ChunkedTaffyWriter::begin(const std::string& filepath, uint32_t reserve_chunks) {
+    if (file_.is_open()) {
+        abort();
+    }
+
     filepath_ = filepath;
-    file_.open(filepath_, std::ios::binary);
+    temp_path_ = filepath + ".partial";
+    directory_.clear();
+    reserved_chunks_ = reserve_chunks;
+    in_chunk_ = false;
+    failed_ = false;
+
+    file_.open(temp_path_, std::ios::binary | std::ios::trunc);
     if (!file_) {
-        std::cerr << "Failed to create TAF file: " << filepath_ << std::endl;
+        std::cerr << "Failed to create TAF file: " << temp_path_ << std::endl;
         return false;
     }
-    
-    // Reserve space for header and directory (we'll write them at the end)
-    current_offset_ = sizeof(AssetHeader);
-    directory_.clear();
-    chunk_count_ = 0;
-    header_written_ = false;
-    
+
+    // Reserve space for header and directory; they are written by finalize()
+    current_offset_ = sizeof(AssetHeader) + uint64_t(reserved_chunks_) * sizeof(ChunkDirectoryEntry);
+    const std::vector<char> zeros(static_cast<size_t>(current_offset_), 0);
+    file_.write(zeros.data(), zeros.size());
+    if (!file_) {
+        return fail("Failed to reserve TAF header");
+    }
+
     return true;
 }
 
-bool ChunkedTaffyWriter::addMetadataChunk(const std::vector<uint8_t>& data, const std::string& name) {
-    if (!file_.is_open()) {
+bool ChunkedTaffyWriter::beginChunk(ChunkType type, const std::string& name, uint32_t flags) {
+    if (!file_.is_open() || failed_) {
         std::cerr << "TAF file not open" << std::endl;
         return false;
     }
-    
-    ChunkDirectoryEntry entry;
+    if (in_chunk_) {
+        std::cerr << "Chunk still open: " << directory_.back().name << std::endl;
+        return false;
+    }
+
+    ChunkDirectoryEntry entry{};
     std::strncpy(entry.name, name.c_str(), sizeof(entry.name) - 1);
     entry.name[sizeof(entry.name) - 1] = '\0';
-    entry.type = ChunkType::AUDI;
-    entry.offset = 0; // Will be set during finalize
-    entry.size = data.size();
-    entry.flags = 0;
-    std::memset(entry.reserved, 0, sizeof(entry.reserved));
-    
+    entry.type = type;
+    entry.offset = current_offset_;
+    entry.flags = flags;
+
     directory_.push_back(entry);
-    ++chunk_count_;
-    
+    in_chunk_ = true;
+    return true;
+}
+
+bool ChunkedTaffyWriter::writeChunkData(const void* data, size_t size) {
+    if (!in_chunk_ || failed_) {
+        std::cerr << "No chunk open for writing" << std::endl;
+        return false;
+    }
+
+    file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    if (!file_) {
+        return fail("Failed to write chunk data");
+    }
+
+    auto& entry = directory_.back();
+    entry.checksum = crc32(data, size, entry.checksum);
+    entry.size += size;
+    current_offset_ += size;
     return true;
 }
 
+bool ChunkedTaffyWriter::endChunk() {
+    if (!in_chunk_) {
+        std::cerr << "No chunk open for writing" << std::endl;
+        return false;
+    }
+    in_chunk_ = false;
+    return !failed_;
+}
+
+bool ChunkedTaffyWriter::addChunk(ChunkType type, std::span<const uint8_t> data,
+                                  const std::string& name, uint32_t flags) {
+    return beginChunk(type, name, flags) &&
+           writeChunkData(data.data(), data.size()) &&
+           endChunk();
+}
+
+bool ChunkedTaffyWriter::addMetadataChunk(const std::vector<uint8_t>& data, const std::string& name) {
+    return addChunk(ChunkType::AUDI, data, name);
+}
+
 bool ChunkedTaffyWriter::addAudioChunk(const std::vector<uint8_t>& data, uint32_t chunkIndex) {
     std::string name = "audio_chunk_" + std::to_string(chunkIndex);
-    return addMetadataChunk(data, name); // Reuse the same function
+    return addChunk(ChunkType::AUDI, data, name);
+}
+
+bool ChunkedTaffyWriter::relocatePayloads() {
+    const uint64_t old_base = sizeof(AssetHeader) + uint64_t(reserved_chunks_) * sizeof(ChunkDirectoryEntry);
+    const uint64_t new_base = sizeof(AssetHeader) + directory_.size() * sizeof(ChunkDirectoryEntry);
+    const std::string relocate_path = temp_path_ + ".relocate";
+
+    file_.close();
+    std::ifstream in(temp_path_, std::ios::binary);
+    std::ofstream out(relocate_path, std::ios::binary | std::ios::trunc);
+    if (!in || !out) {
+        return fail("Failed to relocate chunk payloads");
+    }
+
+    const std::vector<char> zeros(static_cast<size_t>(new_base), 0);
+    out.write(zeros.data(), zeros.size());
+
+    // Copy payloads in fixed-size blocks so memory stays bounded
+    std::vector<char> block(1024 * 1024);
+    in.seekg(static_cast<std::streamoff>(old_base));
+    for (uint64_t remaining = current_offset_ - old_base; remaining > 0;) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(remaining, block.size()));
+        in.read(block.data(), count);
+        out.write(block.data(), count);
+        if (!in || !out) {
+            std::remove(relocate_path.c_str());
+            return fail("Failed to relocate chunk payloads");
+        }
+        remaining -= count;
+    }
+    in.close();
+    out.close();
+
+    std::error_code ec;
+    std::filesystem::rename(relocate_path, temp_path_, ec);
+    if (ec) {
+        std::remove(relocate_path.c_str());
+        return fail("Failed to relocate chunk payloads");
+    }
+
+    for (auto& entry : directory_) {
+        entry.offset = entry.offset - old_base + new_base;
+    }
+    current_offset_ = current_offset_ - old_base + new_base;
+    reserved_chunks_ = static_cast<uint32_t>(directory_.size());
+
+    file_.open(temp_path_, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file_) {
+        return fail("Failed to reopen TAF file");
+    }
+    return true;
 }
 
 bool ChunkedTaffyWriter::finalize() {
-    if (!file_.is_open() || header_written_) {
+    if (!file_.is_open() || failed_) {
         return false;
     }
-    
-    // Calculate offsets
-    current_offset_ = sizeof(AssetHeader) + directory_.size() * sizeof(ChunkDirectoryEntry);
-    
-    // Update directory with actual offsets
-    std::vector<std::vector<uint8_t>> chunk_data;
-    
-    // First, we need to write header and directory
-    AssetHeader header;
-    std::strncpy(header.magic, "TAF!", 4);
-    header.version_major = 1;
-    header.version_minor = 0;
-    header.version_patch = 0;
-    header.chunk_count = chunk_count_;
-    header.asset_type = 0;  // Master asset
-    header.feature_flags = static_cast<FeatureFlags>(0x00000002); // FLAG_STREAMING
-    header.dependency_count = 0;
-    header.ai_model_count = 0;
-    header.total_size = 0; // Will calculate
-    // Initialize world bounds to zero
-    header.world_bounds_min = {0, 0, 0};
-    header.world_bounds_max = {0, 0, 0};
-    header.created_timestamp = std::chrono::system_clock::now().time_since_epoch().count();
-    std::memset(header.creator, 0, sizeof(header.creator));
-    std::strncpy(header.creator, "ChunkedTaffyWriter", sizeof(header.creator) - 1);
-    std::memset(header.description, 0, sizeof(header.description));
-    std::strncpy(header.description, "Chunked streaming audio TAF", sizeof(header.description) - 1);
-    std::memset(header.reserved, 0, sizeof(header.reserved));
-    
-    // Update directory offsets
-    for (auto& entry : directory_) {
-        entry.offset = current_offset_;
-        current_offset_ += entry.size;
+    if (in_chunk_) {
+        std::cerr << "Cannot finalize with an open chunk: " << directory_.back().name << std::endl;
+        return false;
     }
-    
-    header.total_size = current_offset_;
-    
-    // Write header
+
+    if (write_chunk_index_) {
+        const std::vector<uint8_t> table = build_chunk_index_table(directory_);
+        if (!addChunk(ChunkType::INDX, table, CHUNK_INDEX_NAME)) {
+            return false;
+        }
+    }
+
+    if (directory_.size() > reserved_chunks_ && !relocatePayloads()) {
+        return false;
+    }
+
+    header_.chunk_count = static_cast<uint32_t>(directory_.size());
+    header_.index_chunk = write_chunk_index_ ? header_.chunk_count : 0;
+    header_.total_size = current_offset_;
+    header_.created_timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+
+    // Write header and directory into the reserved space
     file_.seekp(0);
-    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
-    
-    // Write directory
-    file_.write(reinterpret_cast<const char*>(directory_.data()), 
+    file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    file_.write(reinterpret_cast<const char*>(directory_.data()),
                 directory_.size() * sizeof(ChunkDirectoryEntry));
-    
-    header_written_ = true;
+    file_.flush();
+    if (!file_) {
+        return fail("Failed to write TAF header");
+    }
     file_.close();
-    
+
+    // The data must be on disk before the rename can be, or a crash could
+    // leave an empty or torn file at the destination
+    if (!sync_file(temp_path_)) {
+        std::cerr << "Failed to sync " << temp_path_ << std::endl;
+        std::remove(temp_path_.c_str());
+        return false;
+    }
+
+    // Atomically replace the destination only once the file is complete
+    std::error_code ec;
+    std::filesystem::rename(temp_path_, filepath_, ec);
+    if (ec) {
+        std::cerr << "Failed to move " << temp_path_ << " to " << filepath_ << ": " << ec.message() << std::endl;
+        std::remove(temp_path_.c_str());
+        return false;
+    }
+    if (!sync_directory(std::filesystem::path(filepath_).parent_path())) {
+        std::cerr << "⚠️ Failed to sync the directory of " << filepath_ << std::endl;
+    }
+
     std::cout << "✅ Finalized chunked TAF: " << filepath_ << std::endl;
-    std::cout << "   Total chunks: " << chunk_count_ << std::endl;
-    std::cout << "   Total size: " << header.total_size << " bytes" << std::endl;
-    
+    std::cout << "   Total chunks: " << header_.chunk_count << std::endl;
+    std::cout << "   Total size: " << header_.total_size << " bytes" << std::endl;
+
     return true;
 }
 
+void ChunkedTaffyWriter::abort() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+    if (!temp_path_.empty()) {
+        std::remove(temp_path_.c_str());
+    }
+    directory_.clear();
+    in_chunk_ = false;
+    failed_ = false;
+}
+
 } // namespace Taffy
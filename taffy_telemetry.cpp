@@ -0,0 +1,396 @@
+#include "include/taffy_telemetry.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+
+namespace Taffy {
+
+// =============================================================================
+// LatencyHistogram
+// =============================================================================
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    const uint64_t micros = nanoseconds / 1000;
+    const size_t bucket = std::min<size_t>(std::bit_width(micros), BUCKETS - 1);
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (nanoseconds > max && !max_ns_.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& count : counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    sum_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.counts[i];
+    }
+    snapshot.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+    snapshot.max_ns = max_ns_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+double LatencyHistogram::bucket_bound_us(size_t bucket) {
+    if (bucket + 1 >= BUCKETS) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return static_cast<double>(uint64_t(1) << bucket);
+}
+
+double LatencyHistogram::Snapshot::quantile_us(double q) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    const uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * double(count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= std::max<uint64_t>(rank, 1)) {
+            // The open-ended bucket reports the slowest sample instead
+            return i + 1 < BUCKETS ? bucket_bound_us(i) : max_ns / 1000.0;
+        }
+    }
+    return max_ns / 1000.0;
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sum_ns += other.sum_ns;
+    max_ns = std::max(max_ns, other.max_ns);
+}
+
+const char* telemetry_level_name(TelemetryLevel level) {
+    switch (level) {
+        case TelemetryLevel::Off: return "off";
+        case TelemetryLevel::Summary: return "summary";
+        case TelemetryLevel::PerChunk: return "per-chunk";
+    }
+    return "unknown";
+}
+
+// =============================================================================
+// StreamingTelemetry
+// =============================================================================
+
+StreamingTelemetry::StreamingTelemetry() : started_ns_(now_ns()) {}
+
+uint64_t StreamingTelemetry::now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void StreamingTelemetry::set_level(TelemetryLevel level) {
+    level_.store(level, std::memory_order_relaxed);
+    if (level == TelemetryLevel::PerChunk && !chunks_ && chunk_count_ > 0) {
+        chunks_.reset(new ChunkSlot[chunk_count_]);
+    }
+}
+
+void StreamingTelemetry::reset(size_t chunk_count) {
+    started_ns_.store(now_ns(), std::memory_order_relaxed);
+    reads_.store(0, std::memory_order_relaxed);
+    bytes_read_.store(0, std::memory_order_relaxed);
+    bytes_decoded_.store(0, std::memory_order_relaxed);
+    max_queue_depth_.store(0, std::memory_order_relaxed);
+    read_latency_.reset();
+    decode_latency_.reset();
+    // Type slots keep their type so concurrent recorders never see one move
+    for (auto& slot : types_) {
+        slot.bytes.store(0, std::memory_order_relaxed);
+        slot.latency.reset();
+    }
+
+    if (chunks_ && chunk_count == chunk_count_) {
+        for (size_t i = 0; i < chunk_count_; ++i) {
+            chunks_[i].bytes.store(0, std::memory_order_relaxed);
+            chunks_[i].latency.reset();
+        }
+        return;
+    }
+    chunks_.reset();
+    chunk_count_ = chunk_count;
+    if (level() == TelemetryLevel::PerChunk && chunk_count_ > 0) {
+        chunks_.reset(new ChunkSlot[chunk_count_]);
+    }
+}
+
+uint64_t StreamingTelemetry::begin() const {
+    return enabled() ? now_ns() : 0;
+}
+
+StreamingTelemetry::TypeSlot* StreamingTelemetry::type_slot(ChunkType type) {
+    const uint32_t key = static_cast<uint32_t>(type);
+    size_t count = type_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        if (types_[i].type.load(std::memory_order_relaxed) == key) {
+            return &types_[i];
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(type_mutex_);
+    count = type_count_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        if (types_[i].type.load(std::memory_order_relaxed) == key) {
+            return &types_[i];
+        }
+    }
+    if (count == MAX_TRACKED_TYPES) {
+        return nullptr;
+    }
+    types_[count].type.store(key, std::memory_order_relaxed);
+    type_count_.store(count + 1, std::memory_order_release);
+    return &types_[count];
+}
+
+void StreamingTelemetry::record_read(uint32_t index, ChunkType type, uint64_t bytes, uint64_t begin_ns) {
+    if (begin_ns == 0) {
+        return;
+    }
+    const uint64_t elapsed = now_ns() - begin_ns;
+    reads_.fetch_add(1, std::memory_order_relaxed);
+    bytes_read_.fetch_add(bytes, std::memory_order_relaxed);
+    read_latency_.record(elapsed);
+    if (TypeSlot* slot = type_slot(type)) {
+        slot->bytes.fetch_add(bytes, std::memory_order_relaxed);
+        slot->latency.record(elapsed);
+    }
+    if (chunks_ && index < chunk_count_) {
+        chunks_[index].bytes.fetch_add(bytes, std::memory_order_relaxed);
+        chunks_[index].latency.record(elapsed);
+    }
+}
+
+void StreamingTelemetry::record_decode(uint64_t bytes, uint64_t begin_ns) {
+    if (begin_ns == 0) {
+        return;
+    }
+    bytes_decoded_.fetch_add(bytes, std::memory_order_relaxed);
+    decode_latency_.record(now_ns() - begin_ns);
+}
+
+void StreamingTelemetry::record_queue_depth(size_t depth) {
+    uint64_t max = max_queue_depth_.load(std::memory_order_relaxed);
+    while (depth > max && !max_queue_depth_.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
+    }
+}
+
+TelemetrySnapshot StreamingTelemetry::snapshot() const {
+    TelemetrySnapshot snapshot;
+    snapshot.level = level();
+    snapshot.elapsed_seconds = (now_ns() - started_ns_.load(std::memory_order_relaxed)) / 1e9;
+    snapshot.reads = reads_.load(std::memory_order_relaxed);
+    snapshot.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+    snapshot.bytes_decoded = bytes_decoded_.load(std::memory_order_relaxed);
+    if (snapshot.elapsed_seconds > 0.0) {
+        snapshot.read_bytes_per_second = snapshot.bytes_read / snapshot.elapsed_seconds;
+    }
+    snapshot.read_latency = read_latency_.snapshot();
+    snapshot.decode_latency = decode_latency_.snapshot();
+    snapshot.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+
+    const size_t type_count = type_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < type_count; ++i) {
+        TelemetrySnapshot::TypeStats stats;
+        stats.type = static_cast<ChunkType>(types_[i].type.load(std::memory_order_relaxed));
+        stats.bytes = types_[i].bytes.load(std::memory_order_relaxed);
+        stats.latency = types_[i].latency.snapshot();
+        snapshot.types.push_back(stats);
+    }
+    std::sort(snapshot.types.begin(), snapshot.types.end(), [](const auto& a, const auto& b) {
+        return static_cast<uint32_t>(a.type) < static_cast<uint32_t>(b.type);
+    });
+
+    if (chunks_) {
+        for (size_t i = 0; i < chunk_count_; ++i) {
+            const uint64_t bytes = chunks_[i].bytes.load(std::memory_order_relaxed);
+            if (bytes == 0) {
+                continue;
+            }
+            TelemetrySnapshot::ChunkStats stats;
+            stats.index = static_cast<uint32_t>(i);
+            stats.bytes = bytes;
+            stats.latency = chunks_[i].latency.snapshot();
+            snapshot.chunks.push_back(std::move(stats));
+        }
+    }
+    return snapshot;
+}
+
+// =============================================================================
+// Export
+// =============================================================================
+
+namespace {
+
+std::string fourcc(ChunkType type) {
+    const uint32_t value = static_cast<uint32_t>(type);
+    std::string name;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const char c = static_cast<char>((value >> shift) & 0xFF);
+        name.push_back(c >= 0x20 && c < 0x7F ? c : '?');
+    }
+    return name;
+}
+
+// Escapes for JSON strings and Prometheus label values alike
+std::string escape(const std::string& text) {
+    std::string escaped;
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+            escaped.push_back(c);
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
+void write_histogram_json(std::ostringstream& out, const LatencyHistogram::Snapshot& latency) {
+    out << "{\"count\":" << latency.count << ",\"mean_us\":" << latency.mean_us()
+        << ",\"p50_us\":" << latency.quantile_us(0.5) << ",\"p90_us\":" << latency.quantile_us(0.9)
+        << ",\"p99_us\":" << latency.quantile_us(0.99) << ",\"max_us\":" << latency.max_ns / 1000.0
+        << ",\"buckets\":[";
+    // Trailing empty buckets are left out; bucket i's upper bound is 2^i us
+    size_t last = LatencyHistogram::BUCKETS;
+    while (last > 0 && latency.counts[last - 1] == 0) {
+        --last;
+    }
+    for (size_t i = 0; i < last; ++i) {
+        out << (i ? "," : "") << latency.counts[i];
+    }
+    out << "]}";
+}
+
+void write_histogram_prometheus(std::ostringstream& out, const std::string& name, const std::string& labels,
+                                const LatencyHistogram::Snapshot& latency) {
+    const std::string separator = labels.empty() ? "" : ",";
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+        cumulative += latency.counts[i];
+        out << name << "_bucket{" << labels << separator << "le=\"";
+        if (i + 1 < LatencyHistogram::BUCKETS) {
+            out << LatencyHistogram::bucket_bound_us(i) / 1e6;
+        } else {
+            out << "+Inf";
+        }
+        out << "\"} " << cumulative << "\n";
+    }
+    const std::string braces = labels.empty() ? "" : "{" + labels + "}";
+    out << name << "_sum" << braces << " " << latency.sum_ns / 1e9 << "\n";
+    out << name << "_count" << braces << " " << latency.count << "\n";
+}
+
+} // namespace
+
+std::string telemetry_to_json(const TelemetrySnapshot& snapshot) {
+    std::ostringstream out;
+    out << "{\"level\":\"" << telemetry_level_name(snapshot.level) << "\""
+        << ",\"elapsed_seconds\":" << snapshot.elapsed_seconds
+        << ",\"reads\":" << snapshot.reads
+        << ",\"bytes_read\":" << snapshot.bytes_read
+        << ",\"bytes_decoded\":" << snapshot.bytes_decoded
+        << ",\"read_bytes_per_second\":" << snapshot.read_bytes_per_second
+        << ",\"read_latency\":";
+    write_histogram_json(out, snapshot.read_latency);
+    out << ",\"decode_latency\":";
+    write_histogram_json(out, snapshot.decode_latency);
+
+    out << ",\"cache\":{\"hits\":" << snapshot.cache_hits << ",\"misses\":" << snapshot.cache_misses
+        << ",\"hit_ratio\":" << snapshot.hit_ratio() << ",\"evictions\":" << snapshot.cache_evictions
+        << ",\"evicted_bytes\":" << snapshot.cache_evicted_bytes << ",\"bytes\":" << snapshot.cache_bytes
+        << ",\"entries\":" << snapshot.cache_entries << "}";
+    out << ",\"queue\":{\"depth\":" << snapshot.queue_depth << ",\"max_depth\":" << snapshot.max_queue_depth << "}";
+
+    out << ",\"types\":[";
+    for (size_t i = 0; i < snapshot.types.size(); ++i) {
+        const auto& type = snapshot.types[i];
+        out << (i ? "," : "") << "{\"type\":\"" << escape(fourcc(type.type)) << "\",\"bytes\":" << type.bytes
+            << ",\"latency\":";
+        write_histogram_json(out, type.latency);
+        out << "}";
+    }
+    out << "],\"chunks\":[";
+    for (size_t i = 0; i < snapshot.chunks.size(); ++i) {
+        const auto& chunk = snapshot.chunks[i];
+        out << (i ? "," : "") << "{\"index\":" << chunk.index << ",\"name\":\"" << escape(chunk.name)
+            << "\",\"bytes\":" << chunk.bytes << ",\"latency\":";
+        write_histogram_json(out, chunk.latency);
+        out << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+std::string telemetry_to_prometheus(const TelemetrySnapshot& snapshot, const std::string& prefix) {
+    std::ostringstream out;
+    auto metric = [&](const char* name, const char* type, const char* help, auto value) {
+        out << "# HELP " << prefix << "_" << name << " " << help << "\n"
+            << "# TYPE " << prefix << "_" << name << " " << type << "\n"
+            << prefix << "_" << name << " " << value << "\n";
+    };
+    metric("reads_total", "counter", "Chunk reads issued to disk.", snapshot.reads);
+    metric("read_bytes_total", "counter", "Stored bytes read from disk.", snapshot.bytes_read);
+    metric("decoded_bytes_total", "counter", "Bytes produced by chunk decompression.", snapshot.bytes_decoded);
+    metric("read_bytes_per_second", "gauge", "Average disk read rate since the last reset.", snapshot.read_bytes_per_second);
+    metric("cache_hits_total", "counter", "Chunk cache hits.", snapshot.cache_hits);
+    metric("cache_misses_total", "counter", "Chunk cache misses.", snapshot.cache_misses);
+    metric("cache_hit_ratio", "gauge", "Chunk cache hits over lookups.", snapshot.hit_ratio());
+    metric("cache_evictions_total", "counter", "Chunks evicted to meet a cache limit.", snapshot.cache_evictions);
+    metric("cache_evicted_bytes_total", "counter", "Bytes evicted to meet a cache limit.", snapshot.cache_evicted_bytes);
+    metric("cache_bytes", "gauge", "Bytes held by the chunk cache.", snapshot.cache_bytes);
+    metric("cache_entries", "gauge", "Chunks held by the chunk cache.", snapshot.cache_entries);
+    metric("prefetch_queue_depth", "gauge", "Prefetch requests waiting for an I/O worker.", snapshot.queue_depth);
+    metric("prefetch_queue_depth_max", "gauge", "Deepest prefetch queue seen since the last reset.", snapshot.max_queue_depth);
+
+    const std::string read_latency = prefix + "_read_latency_seconds";
+    out << "# HELP " << read_latency << " Chunk read latency.\n# TYPE " << read_latency << " histogram\n";
+    write_histogram_prometheus(out, read_latency, "", snapshot.read_latency);
+
+    const std::string decode_latency = prefix + "_decode_latency_seconds";
+    out << "# HELP " << decode_latency << " Chunk decompression latency.\n# TYPE " << decode_latency << " histogram\n";
+    write_histogram_prometheus(out, decode_latency, "", snapshot.decode_latency);
+
+    if (!snapshot.types.empty()) {
+        const std::string type_latency = prefix + "_type_read_latency_seconds";
+        const std::string type_bytes = prefix + "_type_read_bytes_total";
+        out << "# HELP " << type_latency << " Chunk read latency by chunk type.\n# TYPE " << type_latency << " histogram\n";
+        for (const auto& type : snapshot.types) {
+            write_histogram_prometheus(out, type_latency, "type=\"" + escape(fourcc(type.type)) + "\"", type.latency);
+        }
+        out << "# HELP " << type_bytes << " Stored bytes read by chunk type.\n# TYPE " << type_bytes << " counter\n";
+        for (const auto& type : snapshot.types) {
+            out << type_bytes << "{type=\"" << escape(fourcc(type.type)) << "\"} " << type.bytes << "\n";
+        }
+    }
+
+    if (!snapshot.chunks.empty()) {
+        const std::string chunk_latency = prefix + "_chunk_read_latency_seconds";
+        out << "# HELP " << chunk_latency << " Chunk read latency by chunk.\n# TYPE " << chunk_latency << " histogram\n";
+        for (const auto& chunk : snapshot.chunks) {
+            write_histogram_prometheus(out, chunk_latency,
+                                       "chunk=\"" + std::to_string(chunk.index) + "\",name=\"" + escape(chunk.name) + "\"",
+                                       chunk.latency);
+        }
+    }
+    return out.str();
+}
+
+} // namespace Taffy
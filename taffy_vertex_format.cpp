@@ -0,0 +1,230 @@
+#include "include/taffy_vertex_format.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace Taffy {
+
+namespace {
+
+int32_t to_snorm(float value, int32_t max) {
+    return static_cast<int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * float(max)));
+}
+
+float from_snorm(int32_t value, int32_t max) {
+    return std::max(float(value) / float(max), -1.0f);
+}
+
+// Project onto the octahedron |x| + |y| + |z| = 1 and fold the lower half up
+void octahedral_fold(float x, float y, float z, float& u, float& v) {
+    const float l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    if (l1 == 0.0f) {
+        u = v = 0.0f;
+        return;
+    }
+    u = x / l1;
+    v = y / l1;
+    if (z < 0.0f) {
+        const float fu = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        const float fv = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = fu;
+        v = fv;
+    }
+}
+
+void octahedral_unfold(float u, float v, float out[3]) {
+    float x = u;
+    float y = v;
+    const float z = 1.0f - std::fabs(u) - std::fabs(v);
+    const float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+    const float length = std::sqrt(x * x + y * y + z * z);
+    out[0] = x / length;
+    out[1] = y / length;
+    out[2] = z / length;
+}
+
+} // namespace
+
+uint32_t vertex_attribute_size(VertexAttribute::Type type) {
+    switch (type) {
+    case VertexAttribute::Float:
+    case VertexAttribute::Int:
+    case VertexAttribute::UInt:
+    case VertexAttribute::OctNormal:
+    case VertexAttribute::OctTangent:
+    case VertexAttribute::Unorm8x4:
+    case VertexAttribute::Half2:
+        return 4;
+    case VertexAttribute::Float2:
+    case VertexAttribute::Int2:
+    case VertexAttribute::UInt2:
+    case VertexAttribute::Position16:
+        return 8;
+    case VertexAttribute::Float3:
+    case VertexAttribute::Int3:
+    case VertexAttribute::UInt3:
+    case VertexAttribute::Position32:
+        return 12;
+    case VertexAttribute::Float4:
+    case VertexAttribute::Int4:
+    case VertexAttribute::UInt4:
+        return 16;
+    case VertexAttribute::Vec3Q:
+        return 24;
+    }
+    return 0;
+}
+
+uint32_t encode_octahedral(float x, float y, float z) {
+    float u, v;
+    octahedral_fold(x, y, z, u, v);
+    return (uint32_t(to_snorm(u, 32767)) & 0xFFFFu) | (uint32_t(to_snorm(v, 32767)) << 16);
+}
+
+void decode_octahedral(uint32_t packed, float out[3]) {
+    const float u = from_snorm(int16_t(packed & 0xFFFFu), 32767);
+    const float v = from_snorm(int16_t(packed >> 16), 32767);
+    octahedral_unfold(u, v, out);
+}
+
+uint32_t encode_octahedral_tangent(float x, float y, float z, float w) {
+    float u, v;
+    octahedral_fold(x, y, z, u, v);
+    return (uint32_t(to_snorm(u, 32767)) & 0xFFFFu) | ((uint32_t(to_snorm(v, 16383)) & 0x7FFFu) << 16) |
+           (w < 0.0f ? 0x80000000u : 0u);
+}
+
+void decode_octahedral_tangent(uint32_t packed, float out[4]) {
+    const float u = from_snorm(int16_t(packed & 0xFFFFu), 32767);
+    int32_t v = int32_t((packed >> 16) & 0x7FFFu);
+    if (v & 0x4000) {
+        v -= 0x8000;    // Sign-extend 15 bits
+    }
+    octahedral_unfold(u, from_snorm(v, 16383), out);
+    out[3] = (packed & 0x80000000u) ? -1.0f : 1.0f;
+}
+
+uint32_t pack_unorm8x4(float r, float g, float b, float a) {
+    auto unorm = [](float value) { return uint32_t(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f)); };
+    return unorm(r) | (unorm(g) << 8) | (unorm(b) << 16) | (unorm(a) << 24);
+}
+
+uint16_t float_to_half(float value) {
+    const uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint16_t sign = uint16_t((bits >> 16) & 0x8000u);
+    const uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent == 0xFF) {
+        return sign | 0x7C00u | (mantissa ? 0x200u : 0u);  // Inf or quiet NaN
+    }
+    const int32_t half_exponent = int32_t(exponent) - 127 + 15;
+    if (half_exponent >= 0x1F) {
+        return sign | 0x7C00u;  // Overflow to infinity
+    }
+    if (half_exponent <= 0) {
+        if (half_exponent < -10) {
+            return sign;        // Underflow to zero
+        }
+        // Subnormal: shift in the implicit bit, round to nearest even
+        mantissa |= 0x800000u;
+        const uint32_t shift = uint32_t(14 - half_exponent);
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+            half++;
+        }
+        return sign | uint16_t(half);
+    }
+
+    uint32_t half = (uint32_t(half_exponent) << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+        half++;                 // May carry into the exponent, up to infinity
+    }
+    return sign | uint16_t(half);
+}
+
+float half_to_float(uint16_t value) {
+    const uint32_t sign = uint32_t(value & 0x8000u) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1Fu;
+    const uint32_t mantissa = value & 0x3FFu;
+    if (exponent == 0) {
+        const float magnitude = std::ldexp(float(mantissa), -24);
+        return sign ? -magnitude : magnitude;
+    }
+    if (exponent == 0x1F) {
+        return std::bit_cast<float>(sign | 0x7F800000u | (mantissa << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+}
+
+uint32_t pack_half2(float u, float v) {
+    return uint32_t(float_to_half(u)) | (uint32_t(float_to_half(v)) << 16);
+}
+
+PositionQuantizer::PositionQuantizer(const Vec3Q& bounds_min, const Vec3Q& bounds_max)
+    : origin_(bounds_min), fits32_(true) {
+    const uint64_t min[3] = { bounds_min.x, bounds_min.y, bounds_min.z };
+    const uint64_t max[3] = { bounds_max.x, bounds_max.y, bounds_max.z };
+    for (int axis = 0; axis < 3; ++axis) {
+        const uint64_t extent = max[axis] > min[axis] ? max[axis] - min[axis] : 0;
+        extent_[axis] = int64_t(std::min<uint64_t>(extent, INT64_MAX));
+        step16_[axis] = extent_[axis] > 0 ? double(extent_[axis]) / 65535.0 : 1.0;
+        fits32_ = fits32_ && extent <= UINT32_MAX;
+    }
+}
+
+int64_t PositionQuantizer::offset(const Vec3Q& position, int axis) const {
+    const uint64_t value = axis == 0 ? position.x : axis == 1 ? position.y : position.z;
+    const uint64_t origin = axis == 0 ? origin_.x : axis == 1 ? origin_.y : origin_.z;
+    // Both carry the same 2^63 bias, so the difference is the signed offset
+    return std::clamp<int64_t>(int64_t(value - origin), 0, extent_[axis]);
+}
+
+void PositionQuantizer::encode16(const Vec3Q& position, uint8_t out[8]) const {
+    uint16_t packed[4] = {};
+    for (int axis = 0; axis < 3; ++axis) {
+        packed[axis] = uint16_t(std::min<long long>(std::llround(double(offset(position, axis)) / step16_[axis]), 65535));
+    }
+    std::memcpy(out, packed, sizeof(packed));
+}
+
+bool PositionQuantizer::encode32(const Vec3Q& position, uint8_t out[12]) const {
+    if (!fits32_) {
+        return false;
+    }
+    uint32_t packed[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        packed[axis] = uint32_t(offset(position, axis));
+    }
+    std::memcpy(out, packed, sizeof(packed));
+    return true;
+}
+
+double PositionQuantizer::origin_meters(int axis) const {
+    const uint64_t origin = axis == 0 ? origin_.x : axis == 1 ? origin_.y : origin_.z;
+    return double(int64_t(origin - 9223372036854775808ULL)) / VEC3Q_UNITS_PER_METER;
+}
+
+void PositionQuantizer::decode16(const uint8_t in[8], double out[3]) const {
+    uint16_t packed[4];
+    std::memcpy(packed, in, sizeof(packed));
+    for (int axis = 0; axis < 3; ++axis) {
+        out[axis] = origin_meters(axis) + packed[axis] * step16_meters(axis);
+    }
+}
+
+void PositionQuantizer::decode32(const uint8_t in[12], double out[3]) const {
+    uint32_t packed[3];
+    std::memcpy(packed, in, sizeof(packed));
+    for (int axis = 0; axis < 3; ++axis) {
+        out[axis] = origin_meters(axis) + packed[axis] / VEC3Q_UNITS_PER_METER;
+    }
+}
+
+} // namespace Taffy